@@ -23,15 +23,9 @@ function(add_cpp11_embed_target
     )
 endfunction()
 
-# OUTPUT_FILE_NAME is the name that you will include in your code
-# e.g. #INCLUDE "test.h" or #include "headertype1/header.h"
-# See the self tests CmakeLists.txt to understand how to use
-# this function and to learn about its optional arguments
-function(cpp11_embed_generate_header
+function(_cpp11_embed_get_auto_generated_headers_dir
     TARGET_NAME
-    INPUT_FILE_PATH
-    IDENTIFIER_NAME
-    OUTPUT_FILE_NAME
+    RESULT_VARIABLE
 )
     get_property(
         AUTO_GENERATED_HEADERS_DIR_DEFINED TARGET
@@ -48,6 +42,81 @@ function(cpp11_embed_generate_header
         ${TARGET_NAME}
         "AUTO_GENERATED_HEADERS_DIR"
     )
+    set(${RESULT_VARIABLE} "${AUTO_GENERATED_HEADERS_DIR}" PARENT_SCOPE)
+endfunction()
+
+# Data that is defined outside of the generated headers (e.g. in assembly
+# files) must be built exactly once and linked in, so it is kept in a static
+# library that the target links against.
+# The sources are generated by the same command as HEADER_FILE_PATH. Every
+# target that lists an output gets its own copy of that command, and copies in
+# targets that build in parallel would write the same files at once, so one
+# custom target runs the commands and the others wait for it.
+function(_cpp11_embed_add_definition_sources
+    TARGET_NAME
+    HEADER_FILE_PATH
+)
+    set(DEFINITIONS_TARGET_NAME "${TARGET_NAME}Definitions")
+    set(GENERATE_TARGET_NAME "${TARGET_NAME}GenerateDefinitions")
+    if(TARGET ${DEFINITIONS_TARGET_NAME})
+        target_sources(${GENERATE_TARGET_NAME} PRIVATE "${HEADER_FILE_PATH}" ${ARGN})
+        target_sources(${DEFINITIONS_TARGET_NAME} PRIVATE ${ARGN})
+    else()
+        add_custom_target(${GENERATE_TARGET_NAME} SOURCES "${HEADER_FILE_PATH}" ${ARGN})
+        add_library(${DEFINITIONS_TARGET_NAME} STATIC ${ARGN})
+        # Needed when the only sources are object files
+        set_target_properties(${DEFINITIONS_TARGET_NAME} PROPERTIES LINKER_LANGUAGE CXX)
+        add_dependencies(${DEFINITIONS_TARGET_NAME} ${GENERATE_TARGET_NAME})
+        add_dependencies(${TARGET_NAME} ${GENERATE_TARGET_NAME})
+        target_link_libraries(${TARGET_NAME} INTERFACE ${DEFINITIONS_TARGET_NAME})
+    endif()
+endfunction()
+
+# When CPP11_EMBED_STATS is on, every header added to a target writes what it
+# took to generate it (see Cpp11Embed --stats) to a file alongside it that
+# cpp11_embed_generate_stats_report collects. RESULT_VARIABLE is set to the
+# arguments that do that (or nothing) for the *_no_target functions.
+function(_cpp11_embed_get_stats_arguments
+    TARGET_NAME
+    OUTPUT_FILE_PATH
+    RESULT_VARIABLE
+)
+    if(CPP11_EMBED_STATS)
+        set(STATS_FILE_PATH "${OUTPUT_FILE_PATH}.cpp11embed-stats.json")
+        set_property(TARGET ${TARGET_NAME} APPEND PROPERTY "CPP11_EMBED_STATS_FILE_PATHS" "${STATS_FILE_PATH}")
+        set(${RESULT_VARIABLE} STATS_FILE_PATH "${STATS_FILE_PATH}" PARENT_SCOPE)
+    else()
+        set(${RESULT_VARIABLE} "" PARENT_SCOPE)
+    endif()
+endfunction()
+
+# Removes an option (and its value) that cpp11_embed_generate_header_no_target
+# does not understand from ARGS_VARIABLE and stores its value in
+# VALUE_VARIABLE
+macro(_cpp11_embed_take_option
+    ARGS_VARIABLE
+    OPTION_NAME
+    VALUE_VARIABLE
+)
+    list(FIND ${ARGS_VARIABLE} "${OPTION_NAME}" _CPP11_EMBED_OPTION_INDEX)
+    if(NOT _CPP11_EMBED_OPTION_INDEX EQUAL -1)
+        math(EXPR _CPP11_EMBED_VALUE_INDEX "${_CPP11_EMBED_OPTION_INDEX} + 1")
+        list(GET ${ARGS_VARIABLE} ${_CPP11_EMBED_VALUE_INDEX} ${VALUE_VARIABLE})
+        list(REMOVE_AT ${ARGS_VARIABLE} ${_CPP11_EMBED_OPTION_INDEX} ${_CPP11_EMBED_VALUE_INDEX})
+    endif()
+endmacro()
+
+# OUTPUT_FILE_NAME is the name that you will include in your code
+# e.g. #INCLUDE "test.h" or #include "headertype1/header.h"
+# See the self tests CmakeLists.txt to understand how to use
+# this function and to learn about its optional arguments
+function(cpp11_embed_generate_header
+    TARGET_NAME
+    INPUT_FILE_PATH
+    IDENTIFIER_NAME
+    OUTPUT_FILE_NAME
+)
+    _cpp11_embed_get_auto_generated_headers_dir(${TARGET_NAME} AUTO_GENERATED_HEADERS_DIR)
     set(OUTPUT_FILE_PATH "${AUTO_GENERATED_HEADERS_DIR}/${OUTPUT_FILE_NAME}")
 
     # Get rid of the target name argument
@@ -56,10 +125,206 @@ function(cpp11_embed_generate_header
     # headers directory
     list(INSERT ARGV 2 "${OUTPUT_FILE_PATH}")
     list(REMOVE_AT ARGV 3)
+
+    # Output files that sit alongside the header have the same name but a
+    # different extension
+    string(REGEX REPLACE "\\.[^./]*$" "" OUTPUT_FILE_PATH_WITHOUT_EXTENSION "${OUTPUT_FILE_PATH}")
+
+    # INCBIN TRUE embeds the data with an assembly file (GNU assembler, ELF
+    # targets only) instead of in the header. Much faster to build for large
+    # files. Requires the ASM language to be enabled.
+    _cpp11_embed_take_option(ARGV "INCBIN" INCBIN)
+    if(INCBIN)
+        if(NOT CMAKE_ASM_COMPILER_LOADED)
+            message(FATAL_ERROR "INCBIN requires the ASM language to be enabled e.g. with enable_language(ASM)")
+        endif()
+        set(ASSEMBLY_FILE_PATH "${OUTPUT_FILE_PATH_WITHOUT_EXTENSION}.S")
+        list(APPEND ARGV INCBIN_ASSEMBLY_FILE_PATH "${ASSEMBLY_FILE_PATH}")
+        _cpp11_embed_add_definition_sources(${TARGET_NAME} "${OUTPUT_FILE_PATH}" "${ASSEMBLY_FILE_PATH}")
+    endif()
+
+    # ELF_OBJECT TRUE writes the data straight to an ELF object file (x86-64
+    # or AArch64) that is linked in, so no compiler or assembler is involved.
+    _cpp11_embed_take_option(ARGV "ELF_OBJECT" ELF_OBJECT)
+    if(ELF_OBJECT)
+        set(OBJECT_FILE_PATH "${OUTPUT_FILE_PATH_WITHOUT_EXTENSION}${CMAKE_C_OUTPUT_EXTENSION}")
+        if(NOT CMAKE_C_OUTPUT_EXTENSION)
+            set(OBJECT_FILE_PATH "${OUTPUT_FILE_PATH_WITHOUT_EXTENSION}.o")
+        endif()
+        list(APPEND ARGV ELF_OBJECT_FILE_PATH "${OBJECT_FILE_PATH}")
+        if(NOT "ELF_MACHINE" IN_LIST ARGV)
+            if(CMAKE_SYSTEM_PROCESSOR MATCHES "^(aarch64|arm64|ARM64)$")
+                list(APPEND ARGV ELF_MACHINE "aarch64")
+            else()
+                list(APPEND ARGV ELF_MACHINE "x86-64")
+            endif()
+        endif()
+        set_source_files_properties(
+            "${OBJECT_FILE_PATH}"
+            PROPERTIES
+            EXTERNAL_OBJECT TRUE
+            GENERATED TRUE
+        )
+        _cpp11_embed_add_definition_sources(${TARGET_NAME} "${OUTPUT_FILE_PATH}" "${OBJECT_FILE_PATH}")
+    endif()
+
+    # DEFINITION TRUE defines the data in a C++ source file that is built once
+    # and linked in, leaving the header with just declarations, so including
+    # it is cheap however large the data is. SHARDS splits the data across
+    # that many source files so that they can be compiled in parallel.
+    _cpp11_embed_take_option(ARGV "DEFINITION" DEFINITION)
+    if(DEFINITION)
+        set(DEFINITION_FILE_PATH "${OUTPUT_FILE_PATH_WITHOUT_EXTENSION}.cpp")
+        list(APPEND ARGV DEFINITION_FILE_PATH "${DEFINITION_FILE_PATH}")
+        _cpp11_embed_take_option(ARGV "SHARDS" SHARDS)
+        if(SHARDS)
+            list(APPEND ARGV SHARDS "${SHARDS}")
+        endif()
+        cpp11_embed_get_definition_file_paths("${DEFINITION_FILE_PATH}" "${SHARDS}" DEFINITION_FILE_PATHS)
+        _cpp11_embed_add_definition_sources(${TARGET_NAME} "${OUTPUT_FILE_PATH}" ${DEFINITION_FILE_PATHS})
+    endif()
+
+    _cpp11_embed_get_stats_arguments(${TARGET_NAME} "${OUTPUT_FILE_PATH}" STATS_ARGUMENTS)
+    list(APPEND ARGV ${STATS_ARGUMENTS})
+
     # Forward all arguments
     cpp11_embed_generate_header_no_target(${ARGV})
 
     # Ensure that the target is aware of all the headers
     # so that they will definitely be generated for us
     target_sources(${TARGET_NAME} PRIVATE "${OUTPUT_FILE_PATH}")
-endfunction()
\ No newline at end of file
+endfunction()
+# Embeds every file in DIRECTORY_PATH in one header, with a perfect hash so
+# that NAMESPACE_NAME::find("path/relative/to/the/directory") finds a file in
+# constant time. Optional arguments: USE_HEADER_GUARD, ALIGNMENT (of each
+# file, defaults to 16) and INCREMENTAL.
+function(cpp11_embed_generate_directory_header
+    TARGET_NAME
+    DIRECTORY_PATH
+    NAMESPACE_NAME
+    OUTPUT_FILE_NAME
+)
+    _cpp11_embed_get_auto_generated_headers_dir(${TARGET_NAME} AUTO_GENERATED_HEADERS_DIR)
+    set(OUTPUT_FILE_PATH "${AUTO_GENERATED_HEADERS_DIR}/${OUTPUT_FILE_NAME}")
+    _cpp11_embed_get_stats_arguments(${TARGET_NAME} "${OUTPUT_FILE_PATH}" STATS_ARGUMENTS)
+    cpp11_embed_generate_directory_header_no_target(
+        "${DIRECTORY_PATH}"
+        "${NAMESPACE_NAME}"
+        "${OUTPUT_FILE_PATH}"
+        ${ARGN}
+        ${STATS_ARGUMENTS}
+    )
+    target_sources(${TARGET_NAME} PRIVATE "${OUTPUT_FILE_PATH}")
+endfunction()
+
+# Running Cpp11Embed once per header adds up when there are thousands of them,
+# so instead headers can be added to a batch that is generated by a single
+# command which spreads the work across all of the available cores.
+# Takes the same arguments as cpp11_embed_generate_header but only supports
+# the BINARY_MODE, BINARY_STRING_LITERAL, COMPRESS, USE_HEADER_GUARD and
+# INCREMENTAL options.
+# Call cpp11_embed_generate_batch once all the headers have been added.
+function(cpp11_embed_add_header_to_batch
+    TARGET_NAME
+    INPUT_FILE_PATH
+    IDENTIFIER_NAME
+    OUTPUT_FILE_NAME
+)
+    cmake_parse_arguments(
+        ""
+        ""
+        "BINARY_MODE;BINARY_STRING_LITERAL;COMPRESS;USE_HEADER_GUARD;INCREMENTAL"
+        ""
+        ${ARGN}
+    )
+    _cpp11_embed_get_auto_generated_headers_dir(${TARGET_NAME} AUTO_GENERATED_HEADERS_DIR)
+    set(OUTPUT_FILE_PATH "${AUTO_GENERATED_HEADERS_DIR}/${OUTPUT_FILE_NAME}")
+    get_filename_component(INPUT_FILE_PATH "${INPUT_FILE_PATH}" ABSOLUTE)
+
+    # See Cpp11Embed --help for the manifest format
+    set(MANIFEST_ENTRY "${INPUT_FILE_PATH}\t${IDENTIFIER_NAME}\t${OUTPUT_FILE_PATH}")
+    if(_BINARY_MODE)
+        string(APPEND MANIFEST_ENTRY "\t-b")
+    endif()
+    if(_BINARY_STRING_LITERAL)
+        string(APPEND MANIFEST_ENTRY "\t-s")
+    endif()
+    if(_COMPRESS)
+        string(APPEND MANIFEST_ENTRY "\t--compress")
+    endif()
+    if(_USE_HEADER_GUARD)
+        string(APPEND MANIFEST_ENTRY "\t-g")
+    endif()
+    if(_INCREMENTAL)
+        string(APPEND MANIFEST_ENTRY "\t--incremental")
+    endif()
+
+    set_property(TARGET ${TARGET_NAME} APPEND PROPERTY "CPP11_EMBED_BATCH_MANIFEST_ENTRIES" "${MANIFEST_ENTRY}")
+    set_property(TARGET ${TARGET_NAME} APPEND PROPERTY "CPP11_EMBED_BATCH_INPUT_FILE_PATHS" "${INPUT_FILE_PATH}")
+    set_property(TARGET ${TARGET_NAME} APPEND PROPERTY "CPP11_EMBED_BATCH_OUTPUT_FILE_PATHS" "${OUTPUT_FILE_PATH}")
+endfunction()
+
+# Adds the command that generates every header added to the target with
+# cpp11_embed_add_header_to_batch. With DEDUPLICATE TRUE, headers whose input
+# has the same contents as that of an earlier header in the batch refer to
+# its data instead of embedding another copy (the bytes saved are reported
+# when the headers are generated).
+function(cpp11_embed_generate_batch
+    TARGET_NAME
+)
+    cmake_parse_arguments(
+        ""
+        ""
+        "DEDUPLICATE"
+        ""
+        ${ARGN}
+    )
+    _cpp11_embed_get_auto_generated_headers_dir(${TARGET_NAME} AUTO_GENERATED_HEADERS_DIR)
+    get_target_property(MANIFEST_ENTRIES ${TARGET_NAME} "CPP11_EMBED_BATCH_MANIFEST_ENTRIES")
+    get_target_property(INPUT_FILE_PATHS ${TARGET_NAME} "CPP11_EMBED_BATCH_INPUT_FILE_PATHS")
+    get_target_property(OUTPUT_FILE_PATHS ${TARGET_NAME} "CPP11_EMBED_BATCH_OUTPUT_FILE_PATHS")
+    if(NOT MANIFEST_ENTRIES)
+        message(FATAL_ERROR "No headers have been added to the batch for ${TARGET_NAME}. Use cpp11_embed_add_header_to_batch first.")
+    endif()
+
+    # Only touch the manifest when it changes so that the headers aren't
+    # regenerated every time CMake runs
+    set(MANIFEST_FILE_PATH "${AUTO_GENERATED_HEADERS_DIR}/Cpp11EmbedManifest.txt")
+    string(REPLACE ";" "\n" MANIFEST_CONTENTS "${MANIFEST_ENTRIES}")
+    file(WRITE "${MANIFEST_FILE_PATH}.tmp" "${MANIFEST_CONTENTS}\n")
+    configure_file("${MANIFEST_FILE_PATH}.tmp" "${MANIFEST_FILE_PATH}" COPYONLY)
+
+    # Headers may be in subdirectories which Cpp11Embed won't create
+    foreach(OUTPUT_FILE_PATH IN LISTS OUTPUT_FILE_PATHS)
+        get_filename_component(OUTPUT_DIRECTORY "${OUTPUT_FILE_PATH}" DIRECTORY)
+        file(MAKE_DIRECTORY "${OUTPUT_DIRECTORY}")
+    endforeach()
+
+    _cpp11_embed_get_stats_arguments(${TARGET_NAME} "${MANIFEST_FILE_PATH}" STATS_ARGUMENTS)
+    cpp11_embed_generate_manifest_headers_no_target(
+        "${MANIFEST_FILE_PATH}"
+        DEDUPLICATE ${_DEDUPLICATE}
+        ${STATS_ARGUMENTS}
+        OUTPUT_FILE_PATHS ${OUTPUT_FILE_PATHS}
+        INPUT_FILE_PATHS ${INPUT_FILE_PATHS}
+    )
+    target_sources(${TARGET_NAME} PRIVATE ${OUTPUT_FILE_PATHS})
+endfunction()
+
+# Collects the stats of every header added to the target while
+# CPP11_EMBED_STATS was on into one JSON report,
+# <auto-generated headers directory>/Cpp11EmbedStats.json, which is updated
+# whenever any of them are regenerated. Call this once all the headers have
+# been added.
+function(cpp11_embed_generate_stats_report
+    TARGET_NAME
+)
+    _cpp11_embed_get_auto_generated_headers_dir(${TARGET_NAME} AUTO_GENERATED_HEADERS_DIR)
+    get_target_property(STATS_FILE_PATHS ${TARGET_NAME} "CPP11_EMBED_STATS_FILE_PATHS")
+    if(NOT STATS_FILE_PATHS)
+        message(FATAL_ERROR "No headers have been added to ${TARGET_NAME} with stats. Set CPP11_EMBED_STATS to ON before adding them.")
+    endif()
+    set(REPORT_FILE_PATH "${AUTO_GENERATED_HEADERS_DIR}/Cpp11EmbedStats.json")
+    cpp11_embed_generate_stats_report_no_target("${REPORT_FILE_PATH}" ${STATS_FILE_PATHS})
+    target_sources(${TARGET_NAME} PRIVATE "${REPORT_FILE_PATH}")
+endfunction()
@@ -1,3 +1,5 @@
+# Combines the stats of several headers into one report
+set(_CPP11_EMBED_STATS_REPORT_SCRIPT_PATH "${CMAKE_CURRENT_LIST_DIR}/Cpp11EmbedStatsReport.cmake")
 
 # You probably don't want to use this and instead
 # you should use cpp11_embed_generate_header.
@@ -18,7 +20,7 @@ function(cpp11_embed_generate_header_no_target
     cmake_parse_arguments(
         ""
         ""
-        "BINARY_MODE;USE_HEADER_GUARD"
+        "BINARY_MODE;BINARY_STRING_LITERAL;COMPRESS;RUNTIME_LOAD;USE_HEADER_GUARD;INCBIN_ASSEMBLY_FILE_PATH;ELF_OBJECT_FILE_PATH;ELF_MACHINE;DEFINITION_FILE_PATH;SHARDS;ALIGNMENT;WORD_SIZE;ENDIANNESS;MINIFY;METADATA;CONTENT_TYPE;INCREMENTAL;STATS_FILE_PATH"
         ""
         ${ARGN}
     )
@@ -27,14 +29,219 @@ function(cpp11_embed_generate_header_no_target
     if(_BINARY_MODE)
         list(APPEND CPP11_EMBED_ARGS "-b")
     endif()
+    if(_BINARY_STRING_LITERAL)
+        list(APPEND CPP11_EMBED_ARGS "-s")
+    endif()
+    # The data is embedded compressed and accessed through a function that
+    # decompresses it
+    if(_COMPRESS)
+        list(APPEND CPP11_EMBED_ARGS "--compress")
+    endif()
+    # Accessed through <identifier_name>() and <identifier_name>_size() but
+    # code compiled with CPP11_EMBED_RUNTIME_LOAD defined loads the input file
+    # at runtime rather than compiling the data in, so changes to it are
+    # picked up without rebuilding, e.g. for quicker debug builds with
+    # target_compile_definitions(<target> PRIVATE
+    # $<$<CONFIG:Debug>:CPP11_EMBED_RUNTIME_LOAD>)
+    if(_RUNTIME_LOAD)
+        list(APPEND CPP11_EMBED_ARGS "--runtime-load")
+    endif()
     if(_USE_HEADER_GUARD)
         list(APPEND CPP11_EMBED_ARGS "-g")
     endif()
+    set(OUTPUT_FILE_PATHS "${OUTPUT_FILE_PATH}")
+    # The header only declares the data, which is defined by an assembly file
+    # that must be built and linked in
+    if(_INCBIN_ASSEMBLY_FILE_PATH)
+        list(APPEND CPP11_EMBED_ARGS --incbin "${_INCBIN_ASSEMBLY_FILE_PATH}")
+        list(APPEND OUTPUT_FILE_PATHS "${_INCBIN_ASSEMBLY_FILE_PATH}")
+    endif()
+    # Likewise but the data is in an object file
+    if(_ELF_OBJECT_FILE_PATH)
+        list(APPEND CPP11_EMBED_ARGS --elf-object "${_ELF_OBJECT_FILE_PATH}")
+        list(APPEND OUTPUT_FILE_PATHS "${_ELF_OBJECT_FILE_PATH}")
+    endif()
+    if(_ELF_MACHINE)
+        list(APPEND CPP11_EMBED_ARGS --elf-machine "${_ELF_MACHINE}")
+    endif()
+    # Likewise but the data is in C++ source file(s), optionally split into
+    # SHARDS pieces that can be compiled in parallel
+    if(_DEFINITION_FILE_PATH)
+        list(APPEND CPP11_EMBED_ARGS --definition "${_DEFINITION_FILE_PATH}")
+        if(_SHARDS)
+            list(APPEND CPP11_EMBED_ARGS --shards "${_SHARDS}")
+        endif()
+        cpp11_embed_get_definition_file_paths("${_DEFINITION_FILE_PATH}" "${_SHARDS}" DEFINITION_FILE_PATHS)
+        list(APPEND OUTPUT_FILE_PATHS ${DEFINITION_FILE_PATHS})
+    endif()
+    if(_ALIGNMENT)
+        list(APPEND CPP11_EMBED_ARGS --alignment "${_ALIGNMENT}")
+    endif()
+    # With BINARY_MODE the data can be packed into WORD_SIZE byte integers
+    # (ENDIANNESS little or big) that can be read straight out of the array
+    if(_WORD_SIZE)
+        list(APPEND CPP11_EMBED_ARGS --word-size "${_WORD_SIZE}")
+    endif()
+    if(_ENDIANNESS)
+        list(APPEND CPP11_EMBED_ARGS --endianness "${_ENDIANNESS}")
+    endif()
+    # Text is embedded with its comments and insignificant whitespace
+    # stripped (MINIFY json, glsl, css, html or sql)
+    if(_MINIFY)
+        list(APPEND CPP11_EMBED_ARGS --minify "${_MINIFY}")
+    endif()
+    # The size, CRC-32C, XXH64 and content type (CONTENT_TYPE, guessed from
+    # the input's extension by default) are written after the data
+    if(_METADATA)
+        list(APPEND CPP11_EMBED_ARGS --metadata)
+    endif()
+    if(_CONTENT_TYPE)
+        list(APPEND CPP11_EMBED_ARGS --content-type "${_CONTENT_TYPE}")
+    endif()
+    # Outputs are left untouched when their contents wouldn't change so that
+    # whatever includes them isn't rebuilt (Ninja notices this, Make will just
+    # rerun the check on every build)
+    if(_INCREMENTAL)
+        list(APPEND CPP11_EMBED_ARGS --incremental)
+        set(BYPRODUCT_FILE_PATHS "${OUTPUT_FILE_PATH}.cpp11embed-hash")
+    endif()
+    # What it took to generate the header (see Cpp11Embed --stats) is written
+    # to STATS_FILE_PATH as JSON
+    if(_STATS_FILE_PATH)
+        list(APPEND CPP11_EMBED_ARGS --stats-json "${_STATS_FILE_PATH}")
+        list(APPEND OUTPUT_FILE_PATHS "${_STATS_FILE_PATH}")
+    endif()
+    # Outputs may be in subdirectories which Cpp11Embed won't create
+    foreach(OUTPUT_PATH IN LISTS OUTPUT_FILE_PATHS)
+        get_filename_component(OUTPUT_DIRECTORY "${OUTPUT_PATH}" DIRECTORY)
+        file(MAKE_DIRECTORY "${OUTPUT_DIRECTORY}")
+    endforeach()
     add_custom_command(
         PRE_BUILD
-        OUTPUT "${OUTPUT_FILE_PATH}"
+        OUTPUT ${OUTPUT_FILE_PATHS}
+        BYPRODUCTS ${BYPRODUCT_FILE_PATHS}
         COMMAND "${CPP11_EMBED_EXECUTABLE_PATH}" ${CPP11_EMBED_ARGS}
         COMMENT "Generating header ${OUTPUT_FILE_PATH}"
         DEPENDS "${INPUT_FILE_PATH}"
     )
-endfunction()
\ No newline at end of file
+endfunction()
+
+
+# Sets RESULT_VARIABLE to the source files that Cpp11Embed writes when given
+# --definition DEFINITION_FILE_PATH --shards SHARDS (SHARDS may be empty)
+function(cpp11_embed_get_definition_file_paths
+    DEFINITION_FILE_PATH
+    SHARDS
+    RESULT_VARIABLE
+)
+    if(NOT SHARDS OR SHARDS EQUAL 1)
+        set(${RESULT_VARIABLE} "${DEFINITION_FILE_PATH}" PARENT_SCOPE)
+        return()
+    endif()
+    get_filename_component(DIRECTORY "${DEFINITION_FILE_PATH}" DIRECTORY)
+    get_filename_component(NAME "${DEFINITION_FILE_PATH}" NAME)
+    # Everything after the last . (if there is one)
+    string(REGEX MATCH "\\.[^.]*$" EXTENSION "${NAME}")
+    string(REGEX REPLACE "\\.[^.]*$" "" NAME_WITHOUT_EXTENSION "${NAME}")
+    math(EXPR LAST_SHARD "${SHARDS} - 1")
+    set(DEFINITION_FILE_PATHS)
+    foreach(SHARD RANGE ${LAST_SHARD})
+        list(APPEND DEFINITION_FILE_PATHS "${DIRECTORY}/${NAME_WITHOUT_EXTENSION}_${SHARD}${EXTENSION}")
+    endforeach()
+    set(${RESULT_VARIABLE} "${DEFINITION_FILE_PATHS}" PARENT_SCOPE)
+endfunction()
+
+# Embeds every file in a directory (and its subdirectories) in a single
+# header, in namespace NAMESPACE_NAME, with find(path) to look them up. See
+# cpp11_embed_generate_directory_header for the optional arguments.
+function(cpp11_embed_generate_directory_header_no_target
+    DIRECTORY_PATH
+    NAMESPACE_NAME
+    OUTPUT_FILE_PATH
+)
+    cmake_parse_arguments(
+        ""
+        ""
+        "USE_HEADER_GUARD;ALIGNMENT;INCREMENTAL;STATS_FILE_PATH"
+        ""
+        ${ARGN}
+    )
+
+    get_filename_component(DIRECTORY_PATH "${DIRECTORY_PATH}" ABSOLUTE)
+    list(APPEND CPP11_EMBED_ARGS "${DIRECTORY_PATH}" "${NAMESPACE_NAME}" -o "${OUTPUT_FILE_PATH}" --directory)
+    if(_USE_HEADER_GUARD)
+        list(APPEND CPP11_EMBED_ARGS "-g")
+    endif()
+    if(_ALIGNMENT)
+        list(APPEND CPP11_EMBED_ARGS --alignment "${_ALIGNMENT}")
+    endif()
+    if(_INCREMENTAL)
+        list(APPEND CPP11_EMBED_ARGS --incremental)
+        set(BYPRODUCT_FILE_PATHS "${OUTPUT_FILE_PATH}.cpp11embed-hash")
+    endif()
+    set(OUTPUT_FILE_PATHS "${OUTPUT_FILE_PATH}")
+    if(_STATS_FILE_PATH)
+        list(APPEND CPP11_EMBED_ARGS --stats-json "${_STATS_FILE_PATH}")
+        list(APPEND OUTPUT_FILE_PATHS "${_STATS_FILE_PATH}")
+    endif()
+    # CMake is rerun when files are added to or removed from the directory so
+    # that the header depends on all of them
+    file(GLOB_RECURSE INPUT_FILE_PATHS CONFIGURE_DEPENDS "${DIRECTORY_PATH}/*")
+    add_custom_command(
+        PRE_BUILD
+        OUTPUT ${OUTPUT_FILE_PATHS}
+        BYPRODUCTS ${BYPRODUCT_FILE_PATHS}
+        COMMAND "${CPP11_EMBED_EXECUTABLE_PATH}" ${CPP11_EMBED_ARGS}
+        COMMENT "Generating header ${OUTPUT_FILE_PATH} from ${DIRECTORY_PATH}"
+        DEPENDS ${INPUT_FILE_PATHS}
+    )
+endfunction()
+
+# Generates every header listed in a manifest with a single command (see
+# Cpp11Embed --help for the format). You probably want to use
+# cpp11_embed_add_header_to_batch and cpp11_embed_generate_batch instead.
+# OUTPUT_FILE_PATHS and INPUT_FILE_PATHS must list everything in the
+# manifest so that the headers are regenerated when an input changes.
+# With DEDUPLICATE TRUE, headers whose input is the same as that of an
+# earlier header refer to its data rather than embedding another copy.
+# STATS_FILE_PATH is where the stats of every header are written as JSON.
+function(cpp11_embed_generate_manifest_headers_no_target
+    MANIFEST_FILE_PATH
+)
+    cmake_parse_arguments(
+        ""
+        ""
+        "DEDUPLICATE;STATS_FILE_PATH"
+        "OUTPUT_FILE_PATHS;INPUT_FILE_PATHS"
+        ${ARGN}
+    )
+    set(CPP11_EMBED_ARGS --manifest "${MANIFEST_FILE_PATH}")
+    if(_DEDUPLICATE)
+        list(APPEND CPP11_EMBED_ARGS --deduplicate)
+    endif()
+    if(_STATS_FILE_PATH)
+        list(APPEND CPP11_EMBED_ARGS --stats-json "${_STATS_FILE_PATH}")
+        list(APPEND _OUTPUT_FILE_PATHS "${_STATS_FILE_PATH}")
+    endif()
+    add_custom_command(
+        PRE_BUILD
+        OUTPUT ${_OUTPUT_FILE_PATHS}
+        COMMAND "${CPP11_EMBED_EXECUTABLE_PATH}" ${CPP11_EMBED_ARGS}
+        COMMENT "Generating headers from ${MANIFEST_FILE_PATH}"
+        DEPENDS "${MANIFEST_FILE_PATH}" ${_INPUT_FILE_PATHS}
+    )
+endfunction()
+
+# Combines the stats written by Cpp11Embed --stats-json to each of the files
+# that follow REPORT_FILE_PATH into a single JSON array at REPORT_FILE_PATH,
+# with an object per header. Files that haven't been written are skipped.
+function(cpp11_embed_generate_stats_report_no_target
+    REPORT_FILE_PATH
+)
+    add_custom_command(
+        OUTPUT "${REPORT_FILE_PATH}"
+        COMMAND "${CMAKE_COMMAND}" -P "${_CPP11_EMBED_STATS_REPORT_SCRIPT_PATH}" "${REPORT_FILE_PATH}" ${ARGN}
+        COMMENT "Generating stats report ${REPORT_FILE_PATH}"
+        DEPENDS "${_CPP11_EMBED_STATS_REPORT_SCRIPT_PATH}" ${ARGN}
+    )
+endfunction()
@@ -0,0 +1,33 @@
+# Run by the command that cpp11_embed_generate_stats_report_no_target adds:
+# cmake -P Cpp11EmbedStatsReport.cmake REPORT_FILE_PATH STATS_FILE_PATH...
+# Each stats file holds a JSON array (see Cpp11Embed --stats-json) and the
+# report is an array of everything in them, in the same order.
+
+# Arguments 0 to 2 are cmake -P <this script>
+set(REPORT_FILE_PATH "${CMAKE_ARGV3}")
+set(REPORT_OBJECTS "")
+math(EXPR LAST_ARGUMENT_INDEX "${CMAKE_ARGC} - 1")
+if(LAST_ARGUMENT_INDEX GREATER 3)
+    foreach(ARGUMENT_INDEX RANGE 4 ${LAST_ARGUMENT_INDEX})
+        set(STATS_FILE_PATH "${CMAKE_ARGV${ARGUMENT_INDEX}}")
+        # e.g. a header whose outputs --incremental found up to date before
+        # stats were turned on
+        if(NOT EXISTS "${STATS_FILE_PATH}")
+            continue()
+        endif()
+        file(READ "${STATS_FILE_PATH}" STATS)
+        # Just keep the objects in the array
+        string(REGEX REPLACE "^[ \t\r\n]*\\[" "" STATS "${STATS}")
+        string(REGEX REPLACE "\\][ \t\r\n]*$" "" STATS "${STATS}")
+        string(STRIP "${STATS}" STATS)
+        if(STATS STREQUAL "")
+            continue()
+        endif()
+        if(REPORT_OBJECTS STREQUAL "")
+            set(REPORT_OBJECTS "\n  ${STATS}")
+        else()
+            string(APPEND REPORT_OBJECTS ",\n  ${STATS}")
+        endif()
+    endforeach()
+endif()
+file(WRITE "${REPORT_FILE_PATH}" "[${REPORT_OBJECTS}\n]\n")
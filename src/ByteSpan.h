@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstddef>
+
+namespace cpp11embed {
+/**
+ * Contiguous bytes owned by something else, e.g. a MappedFile (std::span
+ * would need C++20)
+ */
+struct ByteSpan {
+  const char *data;
+  size_t size;
+};
+}  // namespace cpp11embed
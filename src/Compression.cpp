@@ -0,0 +1,175 @@
+#include "Compression.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace cpp11embed {
+namespace {
+constexpr size_t k_min_match_length = 4;
+// The format requires the last 5 bytes to be literals and the last match to
+// start at least 12 bytes before the end
+constexpr size_t k_last_literals = 5;
+constexpr size_t k_match_find_limit = 12;
+constexpr size_t k_max_offset = 65535;
+constexpr unsigned k_hash_bits = 16;
+constexpr size_t k_no_position = std::numeric_limits<size_t>::max();
+
+uint32_t Read32(const char *data) {
+  uint32_t value;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+uint32_t Hash(const uint32_t sequence) {
+  return (sequence * 2654435761U) >> (32 - k_hash_bits);
+}
+
+/**
+ * Lengths that don't fit in a token nibble continue in bytes of 255 until
+ * one that is smaller
+ */
+void WriteLength(size_t length, std::vector<char> &output) {
+  while (length >= 255) {
+    output.push_back(static_cast<char>(255));
+    length -= 255;
+  }
+  output.push_back(static_cast<char>(length));
+}
+
+/**
+ * @param match_length 0 for the final sequence, which only has literals
+ */
+void WriteSequence(const char *literals, const size_t literal_length,
+                   const size_t offset, const size_t match_length,
+                   std::vector<char> &output) {
+  const size_t match_length_code =
+      (match_length == 0) ? 0 : match_length - k_min_match_length;
+  output.push_back(static_cast<char>((std::min<size_t>(literal_length, 15)
+                                      << 4) |
+                                     std::min<size_t>(match_length_code, 15)));
+  if (literal_length >= 15) {
+    WriteLength(literal_length - 15, output);
+  }
+  output.insert(output.end(), literals, literals + literal_length);
+  if (match_length == 0) {
+    return;
+  }
+  output.push_back(static_cast<char>(offset & 0xFF));
+  output.push_back(static_cast<char>(offset >> 8));
+  if (match_length_code >= 15) {
+    WriteLength(match_length_code - 15, output);
+  }
+}
+
+/**
+ * @returns false if the input ended first
+ */
+bool ReadLength(const unsigned char *&input, const unsigned char *input_end,
+                size_t &length) {
+  unsigned char byte;
+  do {
+    if (input == input_end) {
+      return false;
+    }
+    byte = *input++;
+    length += byte;
+  } while (byte == 255);
+  return true;
+}
+}  // namespace
+
+std::vector<char> CompressLz4Block(const ByteSpan input) {
+  std::vector<char> output;
+  // Incompressible data grows by a byte for every 255 bytes
+  output.reserve(input.size + input.size / 255 + 16);
+
+  size_t anchor = 0;
+  if (input.size > k_match_find_limit) {
+    std::vector<size_t> positions(size_t{1} << k_hash_bits, k_no_position);
+    const size_t match_start_limit = input.size - k_match_find_limit;
+    const size_t match_end_limit = input.size - k_last_literals;
+    size_t position = 0;
+    while (position < match_start_limit) {
+      const uint32_t sequence = Read32(input.data + position);
+      size_t &entry = positions[Hash(sequence)];
+      size_t candidate = entry;
+      entry = position;
+      if (candidate == k_no_position ||
+          position - candidate > k_max_offset ||
+          Read32(input.data + candidate) != sequence) {
+        // Skip ahead faster the longer nothing has matched, which keeps
+        // incompressible data quick to get through
+        position += 1 + ((position - anchor) >> 6);
+        continue;
+      }
+
+      size_t match_length = k_min_match_length;
+      while (position + match_length < match_end_limit &&
+             input.data[candidate + match_length] ==
+                 input.data[position + match_length]) {
+        match_length++;
+      }
+      while (position > anchor && candidate > 0 &&
+             input.data[position - 1] == input.data[candidate - 1]) {
+        position--;
+        candidate--;
+        match_length++;
+      }
+      WriteSequence(input.data + anchor, position - anchor,
+                    position - candidate, match_length, output);
+      position += match_length;
+      anchor = position;
+    }
+  }
+  WriteSequence(input.data + anchor, input.size - anchor, 0, 0, output);
+  return output;
+}
+
+bool DecompressLz4Block(const ByteSpan input, char *const output,
+                        const size_t output_size) {
+  const unsigned char *in = reinterpret_cast<const unsigned char *>(input.data);
+  const unsigned char *const in_end = in + input.size;
+  size_t written = 0;
+  while (in != in_end) {
+    const unsigned token = *in++;
+    size_t literal_length = token >> 4;
+    if (literal_length == 15 && !ReadLength(in, in_end, literal_length)) {
+      return false;
+    }
+    if (literal_length > static_cast<size_t>(in_end - in) ||
+        literal_length > output_size - written) {
+      return false;
+    }
+    std::copy(in, in + literal_length, output + written);
+    in += literal_length;
+    written += literal_length;
+    // The final sequence only has literals
+    if (in == in_end) {
+      break;
+    }
+
+    if (in_end - in < 2) {
+      return false;
+    }
+    const size_t offset = in[0] | (static_cast<size_t>(in[1]) << 8);
+    in += 2;
+    size_t match_length = token & 15;
+    if (match_length == 15 && !ReadLength(in, in_end, match_length)) {
+      return false;
+    }
+    match_length += k_min_match_length;
+    if (offset == 0 || offset > written ||
+        match_length > output_size - written) {
+      return false;
+    }
+    // The match may overlap what it is copying, e.g. to repeat a run
+    for (size_t i = 0; i < match_length; i++) {
+      output[written + i] = output[written + i - offset];
+    }
+    written += match_length;
+  }
+  return written == output_size;
+}
+}  // namespace cpp11embed
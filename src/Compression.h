@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "ByteSpan.h"
+
+namespace cpp11embed {
+/**
+ * Compresses the input into a single LZ4 block (see
+ * https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md). Only a
+ * greedy search is done as decompression speed matters far more than the
+ * ratio for embedded data.
+ */
+std::vector<char> CompressLz4Block(ByteSpan input);
+
+/**
+ * The inverse of CompressLz4Block, which is also what the generated
+ * decompressor does.
+ * @param output must have room for output_size bytes
+ * @returns false if the input is corrupt or doesn't decompress to exactly
+ * output_size bytes
+ */
+bool DecompressLz4Block(ByteSpan input, char *output, size_t output_size);
+}  // namespace cpp11embed
@@ -0,0 +1,89 @@
+#include "Directory.h"
+
+#include <algorithm>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+namespace cpp11embed {
+namespace {
+/**
+ * @param prefix the path of directory relative to the one being listed,
+ * either empty or ending in /
+ */
+bool ListFiles(const std::string &directory, const std::string &prefix,
+               std::vector<std::string> &relative_paths) {
+#ifdef _WIN32
+  WIN32_FIND_DATAA find_data;
+  const HANDLE find_handle =
+      FindFirstFileA((directory + "\\*").c_str(), &find_data);
+  if (find_handle == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  bool succeeded = true;
+  do {
+    const std::string name = find_data.cFileName;
+    if (name == "." || name == "..") {
+      continue;
+    }
+    if ((find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0) {
+      if ((find_data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) == 0) {
+        succeeded &= ListFiles(directory + "\\" + name, prefix + name + "/",
+                               relative_paths);
+      }
+    } else {
+      relative_paths.push_back(prefix + name);
+    }
+  } while (FindNextFileA(find_handle, &find_data));
+  FindClose(find_handle);
+  return succeeded;
+#else
+  DIR *const directory_stream = opendir(directory.c_str());
+  if (directory_stream == nullptr) {
+    return false;
+  }
+  bool succeeded = true;
+  while (const dirent *const entry = readdir(directory_stream)) {
+    const std::string name = entry->d_name;
+    if (name == "." || name == "..") {
+      continue;
+    }
+    const std::string path = directory + "/" + name;
+    struct stat status;
+    if (lstat(path.c_str(), &status) != 0) {
+      succeeded = false;
+      continue;
+    }
+    if (S_ISDIR(status.st_mode)) {
+      succeeded &= ListFiles(path, prefix + name + "/", relative_paths);
+      continue;
+    }
+    if (S_ISLNK(status.st_mode) && stat(path.c_str(), &status) != 0) {
+      // Dangling link
+      continue;
+    }
+    if (S_ISREG(status.st_mode)) {
+      relative_paths.push_back(prefix + name);
+    }
+  }
+  closedir(directory_stream);
+  return succeeded;
+#endif
+}
+}  // namespace
+
+bool ListFilesInDirectory(const std::string &directory,
+                          std::vector<std::string> &relative_paths) {
+  relative_paths.clear();
+  const bool succeeded = ListFiles(directory, "", relative_paths);
+  std::sort(relative_paths.begin(), relative_paths.end());
+  return succeeded;
+}
+}  // namespace cpp11embed
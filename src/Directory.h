@@ -0,0 +1,17 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace cpp11embed {
+/**
+ * Finds every regular file in the directory and its subdirectories.
+ * Symbolic links to files are followed but symbolic links to directories
+ * are not (so that loops can't happen).
+ * @param relative_paths set to the paths of the files relative to the
+ * directory, separated by / on every platform and sorted
+ * @returns false if the directory (or any subdirectory) couldn't be read
+ */
+bool ListFilesInDirectory(const std::string &directory,
+                          std::vector<std::string> &relative_paths);
+}  // namespace cpp11embed
@@ -0,0 +1,245 @@
+#include "ElfObject.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace {
+// See https://refspecs.linuxfoundation.org/elf/gabi4+/contents.html
+constexpr size_t k_elf_header_size = 64;
+constexpr size_t k_section_header_size = 64;
+constexpr size_t k_symbol_size = 24;
+
+constexpr uint16_t k_et_rel = 1;
+constexpr uint16_t k_em_x86_64 = 62;
+constexpr uint16_t k_em_aarch64 = 183;
+
+constexpr uint32_t k_sht_progbits = 1;
+constexpr uint32_t k_sht_symtab = 2;
+constexpr uint32_t k_sht_strtab = 3;
+constexpr uint64_t k_shf_alloc = 2;
+
+constexpr uint8_t k_stb_global = 1;
+constexpr uint8_t k_stt_object = 1;
+
+// Section indices
+enum : uint16_t {
+  k_null_section,
+  k_rodata_section,
+  k_note_gnu_stack_section,
+  k_symtab_section,
+  k_strtab_section,
+  k_shstrtab_section,
+  k_number_of_sections
+};
+
+size_t RoundUp(const size_t value, const size_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+/**
+ * Little endian encoding, which is what both supported machines use
+ */
+class ByteWriter {
+ public:
+  template <typename T>
+  void Write(const T value) {
+    for (size_t i = 0; i < sizeof(T); i++) {
+      bytes_.push_back(static_cast<char>((static_cast<uint64_t>(value) >>
+                                          (8 * i)) &
+                                         0xff));
+    }
+  }
+
+  void Write(const std::string &value) {
+    bytes_.insert(bytes_.end(), value.begin(), value.end());
+  }
+
+  void PadTo(const size_t size) { bytes_.resize(size, '\0'); }
+
+  size_t size() const { return bytes_.size(); }
+
+  void Flush(std::ostream &output_stream) {
+    output_stream.write(bytes_.data(),
+                        static_cast<std::streamsize>(bytes_.size()));
+    bytes_.clear();
+  }
+
+ private:
+  std::vector<char> bytes_;
+};
+
+struct SectionHeader {
+  uint32_t name;
+  uint32_t type;
+  uint64_t flags;
+  uint64_t offset;
+  uint64_t size;
+  uint32_t link;
+  uint32_t info;
+  uint64_t alignment;
+  uint64_t entry_size;
+};
+
+void WriteSectionHeader(ByteWriter &writer, const SectionHeader &header) {
+  writer.Write(header.name);
+  writer.Write(header.type);
+  writer.Write(header.flags);
+  writer.Write(uint64_t{0});  // Address
+  writer.Write(header.offset);
+  writer.Write(header.size);
+  writer.Write(header.link);
+  writer.Write(header.info);
+  writer.Write(header.alignment);
+  writer.Write(header.entry_size);
+}
+
+void WriteSymbol(ByteWriter &writer, const uint32_t name, const uint64_t value,
+                 const uint64_t size) {
+  writer.Write(name);
+  writer.Write(static_cast<uint8_t>((k_stb_global << 4) | k_stt_object));
+  writer.Write(uint8_t{0});  // Default visibility
+  writer.Write(uint16_t{k_rodata_section});
+  writer.Write(value);
+  writer.Write(size);
+}
+
+/**
+ * @param output_data writes the size bytes of data to the output stream
+ * @returns false if output_data did
+ */
+bool OutputElfObjectImpl(const std::string &identifier_name,
+                         const cpp11embed::ElfMachine machine,
+                         const size_t alignment, const size_t size,
+                         std::ostream &output_stream,
+                         const std::function<bool()> &output_data) {
+  // .rodata holds the data followed by its size
+  const size_t rodata_offset = RoundUp(k_elf_header_size, alignment);
+  const size_t size_value_offset = RoundUp(size, sizeof(uint64_t));
+  const size_t rodata_size = size_value_offset + sizeof(uint64_t);
+
+  const std::string size_identifier_name = identifier_name + "_size";
+  const std::string strtab =
+      std::string{'\0'} + identifier_name + '\0' + size_identifier_name + '\0';
+  const uint32_t identifier_name_index = 1;
+  const auto size_identifier_name_index =
+      static_cast<uint32_t>(identifier_name.size() + 2);
+
+  const std::string shstrtab = std::string{"\0.rodata\0.note.GNU-stack\0",
+                                           25} +
+                               ".symtab" + '\0' + ".strtab" + '\0' +
+                               ".shstrtab" + '\0';
+  const uint32_t rodata_name = 1;
+  const uint32_t note_gnu_stack_name = 9;
+  const uint32_t symtab_name = 25;
+  const uint32_t strtab_name = 33;
+  const uint32_t shstrtab_name = 41;
+
+  const size_t symtab_offset =
+      RoundUp(rodata_offset + rodata_size, sizeof(uint64_t));
+  const size_t symtab_size = 3 * k_symbol_size;
+  const size_t strtab_offset = symtab_offset + symtab_size;
+  const size_t shstrtab_offset = strtab_offset + strtab.size();
+  const size_t section_headers_offset =
+      RoundUp(shstrtab_offset + shstrtab.size(), sizeof(uint64_t));
+
+  ByteWriter writer;
+  // ELF header: 64 bit, little endian, current version, System V ABI
+  writer.Write(std::string{"\x7f" "ELF\x02\x01\x01\x00", 8});
+  writer.PadTo(16);
+  writer.Write(k_et_rel);
+  writer.Write(machine == cpp11embed::ElfMachine::k_aarch64 ? k_em_aarch64
+                                                            : k_em_x86_64);
+  writer.Write(uint32_t{1});  // Version
+  writer.Write(uint64_t{0});  // Entry point
+  writer.Write(uint64_t{0});  // Program header offset
+  writer.Write(static_cast<uint64_t>(section_headers_offset));
+  writer.Write(uint32_t{0});  // Flags
+  writer.Write(static_cast<uint16_t>(k_elf_header_size));
+  writer.Write(uint16_t{0});  // Program header entry size
+  writer.Write(uint16_t{0});  // Number of program headers
+  writer.Write(static_cast<uint16_t>(k_section_header_size));
+  writer.Write(static_cast<uint16_t>(k_number_of_sections));
+  writer.Write(static_cast<uint16_t>(k_shstrtab_section));
+  writer.PadTo(rodata_offset);
+  writer.Flush(output_stream);
+
+  if (!output_data()) {
+    return false;
+  }
+
+  // The size and everything after the data
+  writer.PadTo(size_value_offset - size);
+  writer.Write(static_cast<uint64_t>(size));
+  writer.PadTo(symtab_offset - rodata_offset - size);
+  writer.PadTo(writer.size() + k_symbol_size);  // Null symbol
+  WriteSymbol(writer, identifier_name_index, 0, size);
+  WriteSymbol(writer, size_identifier_name_index, size_value_offset,
+              sizeof(uint64_t));
+  writer.Write(strtab);
+  writer.Write(shstrtab);
+  writer.PadTo(section_headers_offset - rodata_offset - size);
+
+  WriteSectionHeader(writer, {});
+  WriteSectionHeader(writer,
+                     {rodata_name, k_sht_progbits, k_shf_alloc, rodata_offset,
+                      rodata_size, 0, 0, std::max<size_t>(alignment, 8), 0});
+  WriteSectionHeader(writer, {note_gnu_stack_name, k_sht_progbits, 0,
+                              symtab_offset, 0, 0, 0, 1, 0});
+  // info is the index of the first global symbol
+  WriteSectionHeader(writer,
+                     {symtab_name, k_sht_symtab, 0, symtab_offset, symtab_size,
+                      k_strtab_section, 1, 8, k_symbol_size});
+  WriteSectionHeader(writer, {strtab_name, k_sht_strtab, 0, strtab_offset,
+                              strtab.size(), 0, 0, 1, 0});
+  WriteSectionHeader(writer, {shstrtab_name, k_sht_strtab, 0, shstrtab_offset,
+                              shstrtab.size(), 0, 0, 1, 0});
+  writer.Flush(output_stream);
+  return true;
+}
+}  // namespace
+
+namespace cpp11embed {
+ElfMachine GetHostElfMachine() {
+#if defined(__aarch64__) || defined(_M_ARM64)
+  return ElfMachine::k_aarch64;
+#else
+  return ElfMachine::k_x86_64;
+#endif
+}
+
+bool OutputElfObject(const std::string &identifier_name,
+                     const ElfMachine machine, const size_t alignment,
+                     std::istream &input_stream, const size_t size,
+                     std::ostream &output_stream) {
+  return OutputElfObjectImpl(
+      identifier_name, machine, alignment, size, output_stream, [&]() {
+        // Stream the data straight through
+        std::vector<char> block(64 * 1024);
+        size_t remaining = size;
+        while (remaining > 0 && input_stream) {
+          input_stream.read(block.data(),
+                            static_cast<std::streamsize>(
+                                std::min(block.size(), remaining)));
+          const auto bytes_read = static_cast<size_t>(input_stream.gcount());
+          output_stream.write(block.data(),
+                              static_cast<std::streamsize>(bytes_read));
+          remaining -= bytes_read;
+        }
+        return remaining == 0;
+      });
+}
+
+void OutputElfObject(const std::string &identifier_name,
+                     const ElfMachine machine, const size_t alignment,
+                     const ByteSpan input, std::ostream &output_stream) {
+  OutputElfObjectImpl(identifier_name, machine, alignment, input.size,
+                      output_stream, [&]() {
+                        output_stream.write(
+                            input.data,
+                            static_cast<std::streamsize>(input.size));
+                        return true;
+                      });
+}
+}  // namespace cpp11embed
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <istream>
+#include <ostream>
+#include <string>
+
+#include "ByteSpan.h"
+
+namespace cpp11embed {
+enum class ElfMachine { k_x86_64, k_aarch64 };
+
+/**
+ * @returns the machine that this program was compiled for, or x86-64 if it
+ * is not one that ELF objects can be written for
+ */
+ElfMachine GetHostElfMachine();
+
+/**
+ * Writes a relocatable ELF64 object file with the data in .rodata, ready to
+ * be linked in without going through a compiler or assembler. Exports the
+ * same symbols as OutputIncbinAssembly so OutputExternBinaryDataHeader
+ * declares them: <identifier_name> and <identifier_name>_size.
+ * @param alignment the alignment of the data, must be a power of two
+ * @param size the number of bytes to copy from the input
+ * @returns false if the input ended before size bytes were read
+ */
+bool OutputElfObject(const std::string &identifier_name, ElfMachine machine,
+                     size_t alignment, std::istream &input_stream,
+                     size_t size, std::ostream &output_stream);
+void OutputElfObject(const std::string &identifier_name, ElfMachine machine,
+                     size_t alignment, ByteSpan input,
+                     std::ostream &output_stream);
+}  // namespace cpp11embed
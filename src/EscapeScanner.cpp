@@ -0,0 +1,196 @@
+#include "EscapeScanner.h"
+
+#include <array>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)
+#define CPP11_EMBED_HAS_SSE2
+#include <emmintrin.h>
+// Only GCC and Clang can compile individual functions for AVX2
+#if defined(__GNUC__)
+#define CPP11_EMBED_HAS_AVX2
+#include <immintrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define CPP11_EMBED_HAS_NEON
+#include <arm_neon.h>
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace {
+// The characters that need escaping are \a to \r (7 to 13), ", ', ? and \.
+// Anything else is copied into the string literal as it is.
+constexpr uint8_t k_first_control_character_to_escape = '\a';
+constexpr uint8_t k_number_of_control_characters_to_escape = '\r' - '\a' + 1;
+
+const std::array<bool, 256> k_needs_escaping = [] {
+  std::array<bool, 256> table{};
+  for (unsigned c = k_first_control_character_to_escape; c <= '\r'; c++) {
+    table[c] = true;
+  }
+  table['"'] = true;
+  table['\''] = true;
+  table['?'] = true;
+  table['\\'] = true;
+  return table;
+}();
+
+size_t FindNextCharacterToEscapeScalar(const char *const data,
+                                       const size_t size) {
+  for (size_t i = 0; i < size; i++) {
+    if (k_needs_escaping[static_cast<uint8_t>(data[i])]) {
+      return i;
+    }
+  }
+  return size;
+}
+
+#if defined(CPP11_EMBED_HAS_SSE2) || defined(CPP11_EMBED_HAS_NEON)
+unsigned CountTrailingZeros(const uint64_t value) {
+#if defined(_MSC_VER) && !defined(__clang__)
+  unsigned long index;
+  _BitScanForward64(&index, value);
+  return static_cast<unsigned>(index);
+#else
+  return static_cast<unsigned>(__builtin_ctzll(value));
+#endif
+}
+#endif
+
+#ifdef CPP11_EMBED_HAS_SSE2
+size_t FindNextCharacterToEscapeSse2(const char *const data,
+                                     const size_t size) {
+  const __m128i first_control_character =
+      _mm_set1_epi8(static_cast<char>(k_first_control_character_to_escape));
+  const __m128i last_control_character_offset = _mm_set1_epi8(
+      static_cast<char>(k_number_of_control_characters_to_escape - 1));
+  const __m128i double_quote = _mm_set1_epi8('"');
+  const __m128i single_quote = _mm_set1_epi8('\'');
+  const __m128i question_mark = _mm_set1_epi8('?');
+  const __m128i backslash = _mm_set1_epi8('\\');
+
+  size_t i = 0;
+  for (; i + 16 <= size; i += 16) {
+    const __m128i bytes =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+    // There's no unsigned comparison so check that
+    // max(c - '\a', '\r' - '\a') == '\r' - '\a' instead
+    const __m128i offset = _mm_sub_epi8(bytes, first_control_character);
+    const __m128i is_control_character = _mm_cmpeq_epi8(
+        _mm_max_epu8(offset, last_control_character_offset),
+        last_control_character_offset);
+    const __m128i needs_escaping = _mm_or_si128(
+        _mm_or_si128(is_control_character,
+                     _mm_cmpeq_epi8(bytes, double_quote)),
+        _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(bytes, single_quote),
+                         _mm_cmpeq_epi8(bytes, question_mark)),
+            _mm_cmpeq_epi8(bytes, backslash)));
+    const auto mask =
+        static_cast<uint32_t>(_mm_movemask_epi8(needs_escaping));
+    if (mask != 0) {
+      return i + CountTrailingZeros(mask);
+    }
+  }
+  return i + FindNextCharacterToEscapeScalar(data + i, size - i);
+}
+#endif
+
+#ifdef CPP11_EMBED_HAS_AVX2
+__attribute__((target("avx2"))) size_t FindNextCharacterToEscapeAvx2(
+    const char *const data, const size_t size) {
+  const __m256i first_control_character = _mm256_set1_epi8(
+      static_cast<char>(k_first_control_character_to_escape));
+  const __m256i last_control_character_offset = _mm256_set1_epi8(
+      static_cast<char>(k_number_of_control_characters_to_escape - 1));
+  const __m256i double_quote = _mm256_set1_epi8('"');
+  const __m256i single_quote = _mm256_set1_epi8('\'');
+  const __m256i question_mark = _mm256_set1_epi8('?');
+  const __m256i backslash = _mm256_set1_epi8('\\');
+
+  size_t i = 0;
+  for (; i + 32 <= size; i += 32) {
+    const __m256i bytes =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+    const __m256i offset = _mm256_sub_epi8(bytes, first_control_character);
+    const __m256i is_control_character = _mm256_cmpeq_epi8(
+        _mm256_max_epu8(offset, last_control_character_offset),
+        last_control_character_offset);
+    const __m256i needs_escaping = _mm256_or_si256(
+        _mm256_or_si256(is_control_character,
+                        _mm256_cmpeq_epi8(bytes, double_quote)),
+        _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(bytes, single_quote),
+                            _mm256_cmpeq_epi8(bytes, question_mark)),
+            _mm256_cmpeq_epi8(bytes, backslash)));
+    const auto mask =
+        static_cast<uint32_t>(_mm256_movemask_epi8(needs_escaping));
+    if (mask != 0) {
+      return i + CountTrailingZeros(mask);
+    }
+  }
+  return i + FindNextCharacterToEscapeSse2(data + i, size - i);
+}
+#endif
+
+#ifdef CPP11_EMBED_HAS_NEON
+size_t FindNextCharacterToEscapeNeon(const char *const data,
+                                     const size_t size) {
+  const uint8x16_t first_control_character =
+      vdupq_n_u8(k_first_control_character_to_escape);
+  const uint8x16_t number_of_control_characters =
+      vdupq_n_u8(k_number_of_control_characters_to_escape);
+
+  size_t i = 0;
+  for (; i + 16 <= size; i += 16) {
+    const uint8x16_t bytes =
+        vld1q_u8(reinterpret_cast<const uint8_t *>(data + i));
+    const uint8x16_t is_control_character = vcltq_u8(
+        vsubq_u8(bytes, first_control_character), number_of_control_characters);
+    const uint8x16_t needs_escaping = vorrq_u8(
+        vorrq_u8(is_control_character, vceqq_u8(bytes, vdupq_n_u8('"'))),
+        vorrq_u8(vorrq_u8(vceqq_u8(bytes, vdupq_n_u8('\'')),
+                          vceqq_u8(bytes, vdupq_n_u8('?'))),
+                 vceqq_u8(bytes, vdupq_n_u8('\\'))));
+    // Narrow every byte of the mask to 4 bits to get something that fits in
+    // a general purpose register
+    const uint64_t mask = vget_lane_u64(
+        vreinterpret_u64_u8(
+            vshrn_n_u16(vreinterpretq_u16_u8(needs_escaping), 4)),
+        0);
+    if (mask != 0) {
+      return i + CountTrailingZeros(mask) / 4;
+    }
+  }
+  return i + FindNextCharacterToEscapeScalar(data + i, size - i);
+}
+#endif
+
+using FindNextCharacterToEscapeFunction = size_t (*)(const char *, size_t);
+
+FindNextCharacterToEscapeFunction GetFastestFindNextCharacterToEscape() {
+#if defined(CPP11_EMBED_HAS_AVX2)
+  if (__builtin_cpu_supports("avx2")) {
+    return FindNextCharacterToEscapeAvx2;
+  }
+#endif
+#if defined(CPP11_EMBED_HAS_SSE2)
+  return FindNextCharacterToEscapeSse2;
+#elif defined(CPP11_EMBED_HAS_NEON)
+  return FindNextCharacterToEscapeNeon;
+#else
+  return FindNextCharacterToEscapeScalar;
+#endif
+}
+}  // namespace
+
+namespace cpp11embed {
+size_t FindNextCharacterToEscape(const char *const data, const size_t size) {
+  static const FindNextCharacterToEscapeFunction find_next_character_to_escape =
+      GetFastestFindNextCharacterToEscape();
+  return find_next_character_to_escape(data, size);
+}
+}  // namespace cpp11embed
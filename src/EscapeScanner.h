@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstddef>
+
+namespace cpp11embed {
+/**
+ * Finds the first character that OutputEscapedCharacter would escape, so
+ * that everything before it can be copied in one go. Uses SSE2/AVX2 or NEON
+ * when the machine supports them (checked at runtime where necessary).
+ * @returns the index of the character or size if there isn't one
+ */
+size_t FindNextCharacterToEscape(const char *data, size_t size);
+}  // namespace cpp11embed
@@ -0,0 +1,221 @@
+#include "Hash.h"
+
+#include <array>
+#include <cstring>
+#include <vector>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define CPP11_EMBED_HAS_SSE42
+#include <nmmintrin.h>
+#endif
+
+namespace cpp11embed {
+namespace {
+constexpr uint64_t k_prime_1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t k_prime_2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t k_prime_3 = 0x165667B19E3779F9ULL;
+constexpr uint64_t k_prime_4 = 0x85EBCA77C2B2AE63ULL;
+constexpr uint64_t k_prime_5 = 0x27D4EB2F165667C5ULL;
+
+uint64_t RotateLeft(const uint64_t value, const unsigned bits) {
+  return (value << bits) | (value >> (64 - bits));
+}
+
+// Assemble values byte by byte so that the hash doesn't depend on the
+// endianness or alignment requirements of the host
+uint64_t ReadLittleEndian64(const unsigned char *data) {
+  uint64_t value = 0;
+  for (unsigned i = 0; i < 8; i++) {
+    value |= static_cast<uint64_t>(data[i]) << (8 * i);
+  }
+  return value;
+}
+
+uint32_t ReadLittleEndian32(const unsigned char *data) {
+  uint32_t value = 0;
+  for (unsigned i = 0; i < 4; i++) {
+    value |= static_cast<uint32_t>(data[i]) << (8 * i);
+  }
+  return value;
+}
+
+uint64_t Round(uint64_t accumulator, const uint64_t input) {
+  accumulator += input * k_prime_2;
+  accumulator = RotateLeft(accumulator, 31);
+  return accumulator * k_prime_1;
+}
+
+uint64_t MergeRound(uint64_t hash, const uint64_t accumulator) {
+  hash ^= Round(0, accumulator);
+  return hash * k_prime_1 + k_prime_4;
+}
+
+// The CRC-32C polynomial, reversed
+constexpr uint32_t k_crc32c_polynomial = 0x82F63B78;
+
+// Slicing-by-8 tables: entry [i][b] is the CRC of byte b followed by i zeros
+const std::array<std::array<uint32_t, 256>, 8> k_crc32c_tables = [] {
+  std::array<std::array<uint32_t, 256>, 8> tables{};
+  for (uint32_t byte = 0; byte < 256; byte++) {
+    uint32_t crc = byte;
+    for (unsigned bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ ((crc & 1) ? k_crc32c_polynomial : 0);
+    }
+    tables[0][byte] = crc;
+  }
+  for (uint32_t byte = 0; byte < 256; byte++) {
+    for (size_t i = 1; i < tables.size(); i++) {
+      const uint32_t previous = tables[i - 1][byte];
+      tables[i][byte] = (previous >> 8) ^ tables[0][previous & 0xFF];
+    }
+  }
+  return tables;
+}();
+
+uint32_t UpdateCrc32cScalar(uint32_t crc, const unsigned char *data,
+                            size_t size) {
+  for (; size >= 8; data += 8, size -= 8) {
+    const uint32_t low = crc ^ ReadLittleEndian32(data);
+    const uint32_t high = ReadLittleEndian32(data + 4);
+    crc = k_crc32c_tables[7][low & 0xFF] ^
+          k_crc32c_tables[6][(low >> 8) & 0xFF] ^
+          k_crc32c_tables[5][(low >> 16) & 0xFF] ^
+          k_crc32c_tables[4][low >> 24] ^ k_crc32c_tables[3][high & 0xFF] ^
+          k_crc32c_tables[2][(high >> 8) & 0xFF] ^
+          k_crc32c_tables[1][(high >> 16) & 0xFF] ^
+          k_crc32c_tables[0][high >> 24];
+  }
+  for (; size > 0; data++, size--) {
+    crc = (crc >> 8) ^ k_crc32c_tables[0][(crc ^ *data) & 0xFF];
+  }
+  return crc;
+}
+
+#ifdef CPP11_EMBED_HAS_SSE42
+__attribute__((target("sse4.2"))) uint32_t UpdateCrc32cSse42(
+    uint32_t crc, const unsigned char *data, size_t size) {
+#ifdef __x86_64__
+  uint64_t crc64 = crc;
+  for (; size >= 8; data += 8, size -= 8) {
+    uint64_t word;
+    std::memcpy(&word, data, sizeof(word));
+    crc64 = _mm_crc32_u64(crc64, word);
+  }
+  crc = static_cast<uint32_t>(crc64);
+#endif
+  for (; size > 0; data++, size--) {
+    crc = _mm_crc32_u8(crc, *data);
+  }
+  return crc;
+}
+#endif
+
+using UpdateCrc32cFunction = uint32_t (*)(uint32_t, const unsigned char *,
+                                          size_t);
+
+UpdateCrc32cFunction GetFastestUpdateCrc32c() {
+#ifdef CPP11_EMBED_HAS_SSE42
+  if (__builtin_cpu_supports("sse4.2")) {
+    return UpdateCrc32cSse42;
+  }
+#endif
+  return UpdateCrc32cScalar;
+}
+}  // namespace
+
+void Crc32c::Update(const void *const data, const size_t size) {
+  static const UpdateCrc32cFunction update_crc32c = GetFastestUpdateCrc32c();
+  crc_ = update_crc32c(crc_, static_cast<const unsigned char *>(data), size);
+}
+
+Xxh64::Xxh64(const uint64_t seed)
+    : accumulators_{seed + k_prime_1 + k_prime_2, seed + k_prime_2, seed,
+                    seed - k_prime_1},
+      seed_(seed) {}
+
+void Xxh64::Update(const void *const data, size_t size) {
+  if (size == 0) {
+    // data may be null, e.g. for an empty mapped file
+    return;
+  }
+  const unsigned char *bytes = static_cast<const unsigned char *>(data);
+  total_size_ += size;
+
+  if (buffer_size_ + size < sizeof(buffer_)) {
+    std::memcpy(buffer_ + buffer_size_, bytes, size);
+    buffer_size_ += size;
+    return;
+  }
+
+  if (buffer_size_ > 0) {
+    const size_t bytes_needed = sizeof(buffer_) - buffer_size_;
+    std::memcpy(buffer_ + buffer_size_, bytes, bytes_needed);
+    for (unsigned i = 0; i < 4; i++) {
+      accumulators_[i] =
+          Round(accumulators_[i], ReadLittleEndian64(buffer_ + 8 * i));
+    }
+    bytes += bytes_needed;
+    size -= bytes_needed;
+    buffer_size_ = 0;
+  }
+
+  for (; size >= sizeof(buffer_); bytes += 32, size -= 32) {
+    for (unsigned i = 0; i < 4; i++) {
+      accumulators_[i] =
+          Round(accumulators_[i], ReadLittleEndian64(bytes + 8 * i));
+    }
+  }
+
+  std::memcpy(buffer_, bytes, size);
+  buffer_size_ = size;
+}
+
+uint64_t Xxh64::Digest() const {
+  uint64_t hash;
+  if (total_size_ >= sizeof(buffer_)) {
+    hash = RotateLeft(accumulators_[0], 1) +
+           RotateLeft(accumulators_[1], 7) +
+           RotateLeft(accumulators_[2], 12) +
+           RotateLeft(accumulators_[3], 18);
+    for (const uint64_t accumulator : accumulators_) {
+      hash = MergeRound(hash, accumulator);
+    }
+  } else {
+    hash = seed_ + k_prime_5;
+  }
+  hash += total_size_;
+
+  const unsigned char *bytes = buffer_;
+  size_t size = buffer_size_;
+  for (; size >= 8; bytes += 8, size -= 8) {
+    hash ^= Round(0, ReadLittleEndian64(bytes));
+    hash = RotateLeft(hash, 27) * k_prime_1 + k_prime_4;
+  }
+  if (size >= 4) {
+    hash ^= static_cast<uint64_t>(ReadLittleEndian32(bytes)) * k_prime_1;
+    hash = RotateLeft(hash, 23) * k_prime_2 + k_prime_3;
+    bytes += 4;
+    size -= 4;
+  }
+  for (; size > 0; bytes++, size--) {
+    hash ^= (*bytes) * k_prime_5;
+    hash = RotateLeft(hash, 11) * k_prime_1;
+  }
+
+  hash ^= hash >> 33;
+  hash *= k_prime_2;
+  hash ^= hash >> 29;
+  hash *= k_prime_3;
+  hash ^= hash >> 32;
+  return hash;
+}
+
+bool UpdateFromStream(Xxh64 &hash, std::istream &input_stream) {
+  std::vector<char> block(64 * 1024);
+  while (input_stream) {
+    input_stream.read(block.data(), block.size());
+    hash.Update(block.data(), static_cast<size_t>(input_stream.gcount()));
+  }
+  return input_stream.eof();
+}
+}  // namespace cpp11embed
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+
+namespace cpp11embed {
+/**
+ * Incrementally computes the XXH64 hash of some data (see
+ * https://github.com/Cyan4973/xxHash). Fast and non-cryptographic, so only
+ * suitable for detecting changes.
+ */
+class Xxh64 {
+ public:
+  explicit Xxh64(uint64_t seed = 0);
+
+  void Update(const void *data, size_t size);
+
+  /**
+   * @returns the hash of everything passed to Update so far
+   */
+  uint64_t Digest() const;
+
+ private:
+  uint64_t accumulators_[4];
+  uint64_t seed_;
+  uint64_t total_size_ = 0;
+  // Bytes that don't yet make up a full 32 byte stripe
+  unsigned char buffer_[32];
+  size_t buffer_size_ = 0;
+};
+
+/**
+ * Incrementally computes the CRC-32C (Castagnoli) checksum of some data, as
+ * used by iSCSI, ext4 etc. Uses the SSE4.2 crc32 instruction where the CPU
+ * has it.
+ */
+class Crc32c {
+ public:
+  void Update(const void *data, size_t size);
+
+  /**
+   * @returns the checksum of everything passed to Update so far
+   */
+  uint32_t Digest() const { return ~crc_; }
+
+ private:
+  uint32_t crc_ = 0xFFFFFFFF;
+};
+
+/**
+ * Reads the rest of the stream and adds it to the hash
+ * @returns false if the stream couldn't be read
+ */
+bool UpdateFromStream(Xxh64 &hash, std::istream &input_stream);
+}  // namespace cpp11embed
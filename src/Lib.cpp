@@ -1,40 +1,1367 @@
 #include "Lib.h"
 
 #include <algorithm>
+#include <array>
 #include <cctype>
+#include <cstdint>
 #include <functional>
 #include <iterator>
+#include <limits>
+#include <memory>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Compression.h"
+#include "EscapeScanner.h"
+#include "Hash.h"
+#include "Parallel.h"
+#include "PerfectHash.h"
 
 namespace {
-void OutputHeader(
-    const std::string &identifier_name, const bool use_header_guard,
-    std::istream &input_stream, std::ostream &output_stream,
-    void (*const output_header_content)(const std::string &identifier_name,
-                                        std::istream &input_stream,
-                                        std::ostream &output_stream)) {
-  if (use_header_guard) {
-    const auto output_upper_case = [&]() {
-      for (const auto &c : identifier_name) {
-        output_stream << static_cast<char>(std::toupper(c));
+using cpp11embed::BufferedOutput;
+
+// Size of the blocks that input streams are read in
+constexpr size_t k_block_size = 64 * 1024;
+
+struct DecimalByte {
+  char digits[3];
+  uint8_t length;
+};
+
+// Decimal representation of every possible byte value so that formatting a
+// byte is just a table lookup
+const std::array<DecimalByte, 256> k_decimal_bytes = [] {
+  std::array<DecimalByte, 256> table{};
+  for (size_t value = 0; value < table.size(); value++) {
+    const std::string digits = std::to_string(value);
+    std::copy(digits.begin(), digits.end(), table[value].digits);
+    table[value].length = static_cast<uint8_t>(digits.size());
+  }
+  return table;
+}();
+
+struct EscapedByte {
+  char characters[4];
+  uint8_t length;
+};
+
+// How every possible byte value is written in a string literal that holds
+// binary data. Printable characters are escaped in the same way as for text
+// and everything else becomes a three digit octal escape (octal escapes never
+// consume more than three digits, unlike hex escapes, so they can safely be
+// followed by any character).
+const std::array<EscapedByte, 256> k_escaped_bytes = [] {
+  std::array<EscapedByte, 256> table{};
+  for (size_t value = 0; value < table.size(); value++) {
+    std::ostringstream escaped;
+    cpp11embed::OutputEscapedByte(static_cast<char>(value), escaped);
+    const std::string characters = escaped.str();
+    std::copy(characters.begin(), characters.end(), table[value].characters);
+    table[value].length = static_cast<uint8_t>(characters.size());
+  }
+  return table;
+}();
+
+// How every possible character is written in a string literal that holds
+// text (see OutputEscapedCharacter)
+const std::array<EscapedByte, 256> k_escaped_characters = [] {
+  std::array<EscapedByte, 256> table{};
+  for (size_t value = 0; value < table.size(); value++) {
+    std::ostringstream escaped;
+    cpp11embed::OutputEscapedCharacter(static_cast<char>(value), escaped);
+    const std::string characters = escaped.str();
+    std::copy(characters.begin(), characters.end(), table[value].characters);
+    table[value].length = static_cast<uint8_t>(characters.size());
+  }
+  return table;
+}();
+
+// Number of input bytes in each of the string literals that are concatenated
+// together to hold binary data. Keeps lines in the generated header a sensible
+// length without producing too many tokens.
+constexpr size_t k_bytes_per_string_literal = 256;
+
+// Large inputs are split into chunks of this many bytes that are formatted on
+// separate threads. A multiple of k_bytes_per_string_literal so that every
+// chunk of a binary string literal starts a new line.
+constexpr size_t k_chunk_size = 1024 * 1024;
+static_assert(k_chunk_size % k_bytes_per_string_literal == 0,
+              "Chunks must start at the beginning of a string literal");
+
+// Chunks handed out to each thread at a time, so that a thread that finishes
+// early has more work to pick up
+constexpr size_t k_chunks_per_job = 4;
+
+/**
+ * Formats bytes as the comma separated elements of a brace initialiser.
+ */
+class BinaryInitialiserWriter {
+ public:
+  /**
+   * @param number_of_elements the number already written by other writers
+   * (when formatting in chunks)
+   */
+  explicit BinaryInitialiserWriter(BufferedOutput &output,
+                                   const size_t number_of_elements = 0)
+      : output_(output), number_of_elements_(number_of_elements) {}
+
+  void Write(const char *const data, const size_t size) {
+    for (size_t i = 0; i < size; i++) {
+      // Longest possible element is ", 255"
+      char *out = output_.Reserve(5);
+      char *const start = out;
+      if (number_of_elements_ != 0) {
+        *out++ = ',';
+        *out++ = ' ';
+      }
+      const DecimalByte &decimal =
+          k_decimal_bytes[static_cast<uint8_t>(data[i])];
+      out = std::copy(decimal.digits, decimal.digits + decimal.length, out);
+      output_.Commit(static_cast<size_t>(out - start));
+      number_of_elements_++;
+    }
+  }
+
+  size_t number_of_elements() const { return number_of_elements_; }
+
+ private:
+  BufferedOutput &output_;
+  size_t number_of_elements_;
+};
+
+// The widest word that binary data can be packed into. Chunks and blocks of
+// the input must be whole numbers of words so that only the last word can
+// ever be split.
+constexpr size_t k_max_word_size = 8;
+static_assert(k_chunk_size % k_max_word_size == 0 &&
+                  k_block_size % k_max_word_size == 0,
+              "Chunks and blocks must not split words");
+
+/**
+ * Formats bytes packed into words as the comma separated hexadecimal elements
+ * of a brace initialiser, e.g. 0x0201 for the bytes 1 and 2 in a little endian
+ * 16 bit word. Any bytes missing from the last word are zeros.
+ */
+class WordInitialiserWriter {
+ public:
+  /**
+   * @param number_of_bytes the number already written by other writers (when
+   * formatting in chunks), which must be a multiple of the word size
+   */
+  WordInitialiserWriter(BufferedOutput &output,
+                        const cpp11embed::BinaryLayout &layout,
+                        const size_t number_of_bytes = 0)
+      : output_(output),
+        word_size_(layout.word_size),
+        big_endian_(layout.big_endian),
+        number_of_bytes_(number_of_bytes) {}
+
+  /**
+   * Every call but the last must be given a whole number of words
+   */
+  void Write(const char *const data, const size_t size) {
+    constexpr char k_hex_digits[] = "0123456789abcdef";
+    for (size_t i = 0; i < size; i += word_size_) {
+      const size_t bytes_in_word = std::min(word_size_, size - i);
+      char *out = output_.Reserve(4 + 2 * k_max_word_size);
+      char *const start = out;
+      if (number_of_bytes_ != 0) {
+        *out++ = ',';
+        *out++ = ' ';
+      }
+      *out++ = '0';
+      *out++ = 'x';
+      // The most significant byte comes first
+      for (size_t j = 0; j < word_size_; j++) {
+        const size_t index = big_endian_ ? j : word_size_ - 1 - j;
+        const uint8_t byte =
+            (index < bytes_in_word) ? static_cast<uint8_t>(data[i + index])
+                                    : 0;
+        *out++ = k_hex_digits[byte >> 4];
+        *out++ = k_hex_digits[byte & 0xF];
+      }
+      output_.Commit(static_cast<size_t>(out - start));
+      number_of_bytes_ += bytes_in_word;
+    }
+  }
+
+ private:
+  BufferedOutput &output_;
+  size_t word_size_;
+  bool big_endian_;
+  size_t number_of_bytes_;
+};
+
+/**
+ * Formats text as the contents of a string literal (without the quotes).
+ */
+class EscapedTextWriter {
+ public:
+  explicit EscapedTextWriter(BufferedOutput &output) : output_(output) {}
+
+  void Write(const char *const data, const size_t size) {
+    // Most text has long runs of characters that don't need escaping, which
+    // can be copied straight through
+    size_t i = 0;
+    while (i < size) {
+      const size_t run_length =
+          cpp11embed::FindNextCharacterToEscape(data + i, size - i);
+      output_.Write(data + i, run_length);
+      i += run_length;
+      if (i < size) {
+        const EscapedByte &escaped =
+            k_escaped_characters[static_cast<uint8_t>(data[i])];
+        output_.Write(escaped.characters, escaped.length);
+        i++;
+      }
+    }
+  }
+
+ private:
+  BufferedOutput &output_;
+};
+
+/**
+ * Hashes of the data as it is embedded (see cpp11embed::DataMetadata)
+ */
+class DataDigests {
+ public:
+  void Update(const char *const data, const size_t size) {
+    crc32c_.Update(data, size);
+    xxh64_.Update(data, size);
+    size_ += size;
+  }
+
+  uint32_t GetCrc32c() const { return crc32c_.Digest(); }
+  uint64_t GetXxh64() const { return xxh64_.Digest(); }
+  uint64_t GetSize() const { return size_; }
+
+ private:
+  cpp11embed::Crc32c crc32c_;
+  cpp11embed::Xxh64 xxh64_;
+  uint64_t size_ = 0;
+};
+
+/**
+ * Hashes everything before passing it on to another writer
+ */
+template <typename Writer>
+class DigestingWriter {
+ public:
+  DigestingWriter(Writer &writer, DataDigests &digests)
+      : writer_(writer), digests_(digests) {}
+
+  void Write(const char *const data, const size_t size) {
+    digests_.Update(data, size);
+    writer_.Write(data, size);
+  }
+
+ private:
+  Writer &writer_;
+  DataDigests &digests_;
+};
+
+/**
+ * Minifies text before formatting it like EscapedTextWriter. The minified
+ * text is held in a buffer that is never bigger than a block.
+ */
+class MinifiedTextWriter {
+ public:
+  /**
+   * @param digests if not null, updated with the minified text
+   */
+  MinifiedTextWriter(BufferedOutput &output,
+                     const cpp11embed::MinifyFormat format,
+                     DataDigests *const digests)
+      : minifier_(cpp11embed::MakeMinifier(format)),
+        escaped_writer_(output),
+        digests_(digests) {}
+
+  void Write(const char *const data, const size_t size) {
+    for (size_t i = 0; i < size; i += k_block_size) {
+      minified_.clear();
+      minifier_->Write(data + i, std::min(k_block_size, size - i), minified_);
+      WriteMinified();
+    }
+  }
+
+  /**
+   * Writes anything that the minifier held back
+   */
+  void Finish() {
+    minified_.clear();
+    minifier_->Finish(minified_);
+    WriteMinified();
+  }
+
+ private:
+  void WriteMinified() {
+    if (digests_ != nullptr) {
+      digests_->Update(minified_.data(), minified_.size());
+    }
+    escaped_writer_.Write(minified_.data(), minified_.size());
+  }
+
+  std::unique_ptr<cpp11embed::Minifier> minifier_;
+  EscapedTextWriter escaped_writer_;
+  DataDigests *digests_;
+  std::string minified_;
+};
+
+/**
+ * Formats bytes as a sequence of adjacent escaped string literals, e.g.
+ * "abc\000"
+ *     "def"
+ * which the compiler concatenates together.
+ */
+class BinaryStringLiteralWriter {
+ public:
+  /**
+   * @param number_of_bytes the number already written by other writers (when
+   * formatting in chunks). The string literal is only opened if this is 0.
+   */
+  explicit BinaryStringLiteralWriter(BufferedOutput &output,
+                                     const size_t number_of_bytes = 0)
+      : output_(output), number_of_bytes_(number_of_bytes) {
+    if (number_of_bytes_ == 0) {
+      output_.Write('"');
+    }
+  }
+
+  void Write(const char *const data, const size_t size) {
+    for (size_t i = 0; i < size; i++) {
+      // Longest possible output is the end of a literal, a new line, the
+      // indentation and the start of the next literal followed by an escape
+      char *out = output_.Reserve(11);
+      char *const start = out;
+      if (number_of_bytes_ != 0 &&
+          number_of_bytes_ % k_bytes_per_string_literal == 0) {
+        out = std::copy_n("\"\n    \"", 7, out);
       }
-    };
-    output_stream << "#ifndef ";
-    output_upper_case();
-    output_stream << "\n#define ";
-    output_upper_case();
-    output_stream << "\n\n";
+      const EscapedByte &escaped =
+          k_escaped_bytes[static_cast<uint8_t>(data[i])];
+      out = std::copy(escaped.characters, escaped.characters + escaped.length,
+                      out);
+      output_.Commit(static_cast<size_t>(out - start));
+      number_of_bytes_++;
+    }
+  }
+
+  /**
+   * Closes the string literal
+   */
+  void Finish() { output_.Write('"'); }
+
+  size_t number_of_bytes() const { return number_of_bytes_; }
+
+ private:
+  BufferedOutput &output_;
+  size_t number_of_bytes_;
+};
+
+/**
+ * Reads the stream in blocks and passes each of them to the writer.
+ * @param max_bytes stop after this many bytes even if there is more input
+ * @returns the number of bytes read
+ */
+template <typename Writer>
+size_t WriteStreamInBlocks(std::istream &input_stream, Writer &writer,
+                           const size_t max_bytes) {
+  if (!input_stream) {
+    return 0;
+  }
+  std::vector<char> block(k_block_size);
+  size_t remaining = max_bytes;
+  while (remaining > 0) {
+    input_stream.read(block.data(), static_cast<std::streamsize>(std::min(
+                                        block.size(), remaining)));
+    const size_t bytes_read = static_cast<size_t>(input_stream.gcount());
+    if (bytes_read == 0) {
+      break;
+    }
+    writer.Write(block.data(), bytes_read);
+    remaining -= bytes_read;
+  }
+  return max_bytes - remaining;
+}
+
+/**
+ * Formats each chunk of the data on its own thread into its own buffer and
+ * then writes the buffers out in order. Only a few chunks per thread are held
+ * in memory at once.
+ * @param offset where the data starts in the input
+ * @param make_writer called with somewhere to write to and the offset of a
+ * chunk in the input, returns a writer that carries on from there (so that
+ * the output is exactly the same as from a single writer)
+ */
+template <typename MakeWriter>
+void WriteChunksInParallel(const char *const data, const size_t size,
+                           const size_t offset, BufferedOutput &output,
+                           const unsigned number_of_jobs,
+                           const MakeWriter &make_writer) {
+  const size_t number_of_chunks = (size + k_chunk_size - 1) / k_chunk_size;
+  const size_t chunks_per_round =
+      std::min(k_chunks_per_job * number_of_jobs, number_of_chunks);
+  std::vector<std::vector<char>> formatted_chunks(chunks_per_round);
+  for (size_t first_chunk = 0; first_chunk < number_of_chunks;
+       first_chunk += chunks_per_round) {
+    const size_t count =
+        std::min(chunks_per_round, number_of_chunks - first_chunk);
+    cpp11embed::ParallelFor(count, number_of_jobs, [&](const size_t i) {
+      const size_t chunk_offset = (first_chunk + i) * k_chunk_size;
+      std::vector<char> &formatted_chunk = formatted_chunks[i];
+      formatted_chunk.clear();
+      cpp11embed::VectorSink sink{formatted_chunk};
+      BufferedOutput chunk_output{sink};
+      auto writer = make_writer(chunk_output, offset + chunk_offset);
+      writer.Write(data + chunk_offset,
+                   std::min(k_chunk_size, size - chunk_offset));
+    });
+    for (size_t i = 0; i < count; i++) {
+      output.Write(formatted_chunks[i].data(), formatted_chunks[i].size());
+    }
+  }
+}
+
+/**
+ * Formats the whole input with writers from make_writer (see
+ * WriteChunksInParallel), spreading large inputs across several threads
+ * @param number_of_jobs 0 to use as many threads as there are cores
+ * @param max_bytes stop after this many bytes even if there is more input
+ * @param digests if not null, updated with the input (in order)
+ * @returns the number of bytes in the input
+ */
+template <typename MakeWriter>
+size_t WriteInput(cpp11embed::ByteSpan input, BufferedOutput &output,
+                  unsigned number_of_jobs, const MakeWriter &make_writer,
+                  const size_t max_bytes = std::numeric_limits<size_t>::max(),
+                  DataDigests *const digests = nullptr) {
+  input.size = std::min(input.size, max_bytes);
+  if (digests != nullptr) {
+    digests->Update(input.data, input.size);
+  }
+  if (number_of_jobs == 0) {
+    number_of_jobs = cpp11embed::GetDefaultNumberOfJobs();
+  }
+  if (number_of_jobs == 1 || input.size <= k_chunk_size) {
+    auto writer = make_writer(output, 0);
+    writer.Write(input.data, input.size);
   } else {
-    output_stream << "#pragma once\n\n";
+    WriteChunksInParallel(input.data, input.size, 0, output, number_of_jobs,
+                          make_writer);
+  }
+  return input.size;
+}
+
+/**
+ * @param first_offset where the stream starts in the input, if earlier parts
+ * of it have already been written (a multiple of k_chunk_size)
+ */
+template <typename MakeWriter>
+size_t WriteInput(std::istream &input_stream, BufferedOutput &output,
+                  unsigned number_of_jobs, const MakeWriter &make_writer,
+                  const size_t max_bytes = std::numeric_limits<size_t>::max(),
+                  DataDigests *const digests = nullptr,
+                  const size_t first_offset = 0) {
+  if (number_of_jobs == 0) {
+    number_of_jobs = cpp11embed::GetDefaultNumberOfJobs();
   }
+  if (number_of_jobs == 1) {
+    auto writer = make_writer(output, first_offset);
+    if (digests == nullptr) {
+      return WriteStreamInBlocks(input_stream, writer, max_bytes);
+    }
+    DigestingWriter<decltype(writer)> digesting_writer{writer, *digests};
+    return WriteStreamInBlocks(input_stream, digesting_writer, max_bytes);
+  }
+  // Enough for every thread to have a few chunks at once
+  const size_t round_size = k_chunks_per_job * number_of_jobs * k_chunk_size;
+  // The round is read a chunk at a time and only grows as the input arrives,
+  // so small inputs don't need a whole round's worth of memory
+  std::vector<char> round;
+  size_t offset = 0;
+  while (input_stream && offset < max_bytes) {
+    const size_t round_limit = std::min(round_size, max_bytes - offset);
+    size_t bytes_read = 0;
+    while (input_stream && bytes_read < round_limit) {
+      const size_t read_size = std::min(k_chunk_size, round_limit - bytes_read);
+      if (round.size() < bytes_read + read_size) {
+        round.resize(bytes_read + read_size);
+      }
+      input_stream.read(round.data() + bytes_read,
+                        static_cast<std::streamsize>(read_size));
+      bytes_read += static_cast<size_t>(input_stream.gcount());
+    }
+    if (bytes_read == 0) {
+      break;
+    }
+    if (digests != nullptr) {
+      digests->Update(round.data(), bytes_read);
+    }
+    WriteChunksInParallel(round.data(), bytes_read, first_offset + offset,
+                          output, number_of_jobs, make_writer);
+    offset += bytes_read;
+  }
+  if (first_offset + offset == 0) {
+    // Writers may write something even when there is no input (e.g. the
+    // start of a string literal)
+    make_writer(output, 0);
+  }
+  return offset;
+}
+
+const auto k_make_escaped_text_writer = [](BufferedOutput &output, size_t) {
+  return EscapedTextWriter{output};
+};
 
-  output_header_content(identifier_name, input_stream, output_stream);
-  output_stream << "\n";
+const auto k_make_binary_initialiser_writer = [](BufferedOutput &output,
+                                                 const size_t offset) {
+  return BinaryInitialiserWriter{output, offset};
+};
+
+const auto k_make_binary_string_literal_writer = [](BufferedOutput &output,
+                                                    const size_t offset) {
+  return BinaryStringLiteralWriter{output, offset};
+};
+
+void WriteSerially(const cpp11embed::ByteSpan input,
+                   MinifiedTextWriter &writer) {
+  writer.Write(input.data, input.size);
+}
+
+void WriteSerially(std::istream &input_stream, MinifiedTextWriter &writer) {
+  WriteStreamInBlocks(input_stream, writer,
+                      std::numeric_limits<size_t>::max());
+}
+
+template <typename Input>
+void OutputEscapedStringLiteralImpl(
+    Input &input, BufferedOutput &output, const unsigned number_of_jobs = 1,
+    const cpp11embed::MinifyFormat minify_format =
+        cpp11embed::MinifyFormat::k_none,
+    DataDigests *const digests = nullptr) {
+  output.Write('"');
+  if (minify_format == cpp11embed::MinifyFormat::k_none) {
+    WriteInput(input, output, number_of_jobs, k_make_escaped_text_writer,
+               std::numeric_limits<size_t>::max(), digests);
+  } else {
+    // How text is minified depends on everything before it, so it can't be
+    // split into chunks
+    MinifiedTextWriter writer{output, minify_format, digests};
+    WriteSerially(input, writer);
+    writer.Finish();
+  }
+  output.Write('"');
+}
+
+template <typename Input>
+size_t OutputBinaryInitialiserImpl(Input &input, BufferedOutput &output,
+                                   const unsigned number_of_jobs = 1) {
+  output.Write('{');
+  const size_t number_of_elements = WriteInput(
+      input, output, number_of_jobs, k_make_binary_initialiser_writer);
+  output.Write('}');
+  return number_of_elements;
+}
+
+template <typename Input>
+size_t OutputBinaryStringLiteralImpl(Input &input, BufferedOutput &output,
+                                     const unsigned number_of_jobs = 1,
+                                     DataDigests *const digests = nullptr) {
+  const size_t number_of_bytes = WriteInput(
+      input, output, number_of_jobs, k_make_binary_string_literal_writer,
+      std::numeric_limits<size_t>::max(), digests);
+  // Closes the string literal
+  output.Write('"');
+  return number_of_bytes;
+}
+
+void OutputHeader(const std::string &identifier_name,
+                  const bool use_header_guard, BufferedOutput &output,
+                  const std::function<void()> &output_header_content) {
+  if (use_header_guard) {
+    std::string header_guard = identifier_name;
+    std::transform(
+        header_guard.begin(), header_guard.end(), header_guard.begin(),
+        [](const char c) { return static_cast<char>(std::toupper(c)); });
+    output.Write("#ifndef ");
+    output.Write(header_guard);
+    output.Write("\n#define ");
+    output.Write(header_guard);
+    output.Write("\n\n");
+  } else {
+    output.Write("#pragma once\n\n");
+  }
+
+  output_header_content();
+  output.Write('\n');
 
   if (use_header_guard) {
-    output_stream << "\n#endif\n";
+    output.Write("\n#endif\n");
+  }
+}
+
+/**
+ * Writes the constants described by cpp11embed::DataMetadata, which need
+ * <cstddef> and <cstdint>
+ * @param size_written whether <identifier_name>_size has already been written
+ */
+void OutputMetadata(const std::string &identifier_name,
+                    const cpp11embed::DataMetadata &metadata,
+                    const DataDigests &digests, const bool size_written,
+                    BufferedOutput &output) {
+  const auto write_hex = [&output](const uint64_t value, const size_t digits) {
+    constexpr char k_hex_digits[] = "0123456789abcdef";
+    output.Write("0x");
+    for (size_t i = digits; i > 0; i--) {
+      output.Write(k_hex_digits[(value >> (4 * (i - 1))) & 0xF]);
+    }
+  };
+  output.Write("\n\n// Of the data as embedded, so it can be checked without "
+               "hashing it at runtime");
+  if (!size_written) {
+    output.Write("\nconstexpr std::size_t ");
+    output.Write(identifier_name);
+    output.Write("_size = ");
+    output.WriteDecimal(digests.GetSize());
+    output.Write(';');
+  }
+  output.Write("\nconstexpr std::uint32_t ");
+  output.Write(identifier_name);
+  output.Write("_crc32c = ");
+  write_hex(digests.GetCrc32c(), 8);
+  output.Write(";\nconstexpr std::uint64_t ");
+  output.Write(identifier_name);
+  output.Write("_xxh64 = ");
+  write_hex(digests.GetXxh64(), 16);
+  output.Write("ULL;\nconstexpr char ");
+  output.Write(identifier_name);
+  output.Write("_content_type[] = \"");
+  EscapedTextWriter{output}.Write(metadata.content_type.data(),
+                                  metadata.content_type.size());
+  output.Write("\";");
+}
+
+template <typename Input>
+void OutputEscapedStringLiteralHeaderImpl(
+    const std::string &identifier_name, const bool use_header_guard,
+    Input &input, BufferedOutput &output, const unsigned number_of_jobs,
+    const cpp11embed::MinifyFormat minify_format,
+    const cpp11embed::DataMetadata &metadata) {
+  OutputHeader(identifier_name, use_header_guard, output, [&]() {
+    DataDigests digests;
+    if (metadata.enabled) {
+      output.Write("#include <cstddef>\n#include <cstdint>\n\n");
+    }
+    output.Write("constexpr char ");
+    output.Write(identifier_name);
+    output.Write("[] = ");
+    OutputEscapedStringLiteralImpl(input, output, number_of_jobs,
+                                   minify_format,
+                                   metadata.enabled ? &digests : nullptr);
+    output.Write(';');
+    if (metadata.enabled) {
+      OutputMetadata(identifier_name, metadata, digests, false, output);
+    }
+  });
+}
+
+template <typename Input>
+void OutputBinaryStringLiteralHeaderImpl(
+    const std::string &identifier_name, const bool use_header_guard,
+    Input &input, BufferedOutput &output, const unsigned number_of_jobs,
+    const cpp11embed::DataMetadata &metadata) {
+  OutputHeader(identifier_name, use_header_guard, output, [&]() {
+    DataDigests digests;
+    output.Write(metadata.enabled ? "#include <cstddef>\n#include <cstdint>\n\n"
+                                  : "#include <cstddef>\n\n");
+    output.Write("constexpr unsigned char ");
+    output.Write(identifier_name);
+    output.Write("[] =\n    ");
+    OutputBinaryStringLiteralImpl(input, output, number_of_jobs,
+                                  metadata.enabled ? &digests : nullptr);
+    // The string literal has a null terminator that is not part of the data
+    output.Write(";\nconstexpr std::size_t ");
+    output.Write(identifier_name);
+    output.Write("_size = sizeof(");
+    output.Write(identifier_name);
+    output.Write(") - 1;");
+    if (metadata.enabled) {
+      OutputMetadata(identifier_name, metadata, digests, true, output);
+    }
+  });
+}
+
+// Shared by every compressed header, hence the include guard. Matches
+// cpp11embed::DecompressLz4Block.
+constexpr char k_lz4_decompressor[] = R"(#ifndef CPP11_EMBED_LZ4_DECOMPRESSOR
+#define CPP11_EMBED_LZ4_DECOMPRESSOR
+namespace cpp11embed_lz4 {
+inline bool ReadLength(const unsigned char *&in, const unsigned char *in_end,
+                       std::size_t &length) {
+  unsigned char byte;
+  do {
+    if (in == in_end) {
+      return false;
+    }
+    byte = *in++;
+    length += byte;
+  } while (byte == 255);
+  return true;
+}
+
+inline bool DecompressBlock(const unsigned char *in, std::size_t in_size,
+                            unsigned char *out, std::size_t out_size) {
+  const unsigned char *const in_end = in + in_size;
+  std::size_t written = 0;
+  while (in != in_end) {
+    const unsigned token = *in++;
+    std::size_t literal_length = token >> 4;
+    if (literal_length == 15 && !ReadLength(in, in_end, literal_length)) {
+      return false;
+    }
+    if (literal_length > static_cast<std::size_t>(in_end - in) ||
+        literal_length > out_size - written) {
+      return false;
+    }
+    for (std::size_t i = 0; i < literal_length; i++) {
+      out[written++] = *in++;
+    }
+    if (in == in_end) {
+      break;
+    }
+    if (in_end - in < 2) {
+      return false;
+    }
+    const std::size_t offset = in[0] | (static_cast<std::size_t>(in[1]) << 8);
+    in += 2;
+    std::size_t match_length = token & 15;
+    if (match_length == 15 && !ReadLength(in, in_end, match_length)) {
+      return false;
+    }
+    match_length += 4;
+    if (offset == 0 || offset > written || match_length > out_size - written) {
+      return false;
+    }
+    for (std::size_t i = 0; i < match_length; i++, written++) {
+      out[written] = out[written - offset];
+    }
+  }
+  return written == out_size;
+}
+}  // namespace cpp11embed_lz4
+#endif
+
+)";
+
+/**
+ * Writes out a template for how some data is accessed, with $ replaced by
+ * the identifier name, @ by the type of the elements (char for text and
+ * unsigned char for binary data) and % by the path as a string literal
+ */
+void OutputAccessors(const char *const accessors,
+                     const std::string &identifier_name, const bool text,
+                     BufferedOutput &output, const std::string &path = "") {
+  for (const char *c = accessors; *c != '\0'; c++) {
+    if (*c == '$') {
+      output.Write(identifier_name);
+    } else if (*c == '@') {
+      output.Write(text ? "char" : "unsigned char");
+    } else if (*c == '%') {
+      output.Write('"');
+      EscapedTextWriter{output}.Write(path.data(), path.size());
+      output.Write('"');
+    } else {
+      output.Write(*c);
+    }
+  }
+}
+
+// How the compressed data is accessed (see OutputAccessors)
+constexpr char k_compressed_data_accessors[] = R"(
+// Decompresses the data into buffer, which must have room for $_size bytes.
+// Returns false if the data is corrupt.
+inline bool $_decompress(void *buffer) {
+  return cpp11embed_lz4::DecompressBlock($_compressed, $_compressed_size,
+                                         static_cast<unsigned char *>(buffer),
+                                         $_size);
+}
+
+// The data (with a null terminator after it), decompressed the first time
+// this is called. Safe to call from several threads at once. Aborts if the
+// data is corrupt.
+inline const @ *$() {
+  static const std::unique_ptr<@[]> data = []() -> std::unique_ptr<@[]> {
+    std::unique_ptr<@[]> buffer(new @[$_size + 1]);
+    if (!$_decompress(buffer.get())) {
+      std::fprintf(stderr, "Unable to decompress the embedded data $\n");
+      std::abort();
+    }
+    buffer[$_size] = 0;
+    return buffer;
+  }();
+  return data.get();
+})";
+
+void OutputCompressedDataHeaderImpl(const std::string &identifier_name,
+                                    const bool use_header_guard,
+                                    const bool text,
+                                    const cpp11embed::ByteSpan input,
+                                    BufferedOutput &output) {
+  const std::vector<char> compressed = cpp11embed::CompressLz4Block(input);
+  OutputHeader(identifier_name, use_header_guard, output, [&]() {
+    output.Write(
+        "#include <cstddef>\n#include <cstdio>\n#include <cstdlib>\n"
+        "#include <memory>\n\n");
+    output.Write(k_lz4_decompressor);
+    output.Write("constexpr unsigned char ");
+    output.Write(identifier_name);
+    output.Write("_compressed[] =\n    ");
+    const cpp11embed::ByteSpan compressed_input{compressed.data(),
+                                                compressed.size()};
+    OutputBinaryStringLiteralImpl(compressed_input, output);
+    // The string literal has a null terminator that is not part of the data
+    output.Write(";\nconstexpr std::size_t ");
+    output.Write(identifier_name);
+    output.Write("_compressed_size = sizeof(");
+    output.Write(identifier_name);
+    output.Write("_compressed) - 1;\nconstexpr std::size_t ");
+    output.Write(identifier_name);
+    output.Write("_size = ");
+    output.WriteDecimal(input.size);
+    output.Write(";\n");
+    OutputAccessors(k_compressed_data_accessors, identifier_name, text,
+                    output);
+  });
+}
+
+// Shared by every header that can load its data at runtime, hence the
+// include guard
+constexpr char k_runtime_loader[] = R"(#ifndef CPP11_EMBED_RUNTIME_LOADER
+#define CPP11_EMBED_RUNTIME_LOADER
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <utility>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+namespace cpp11embed_runtime_load {
+// The contents of a file with a null terminator after them, mapped into
+// memory where possible and otherwise read into it. Stops the program if the
+// file can't be read.
+class File {
+ public:
+  explicit File(const char *path) {
+#ifndef _WIN32
+    Map(path);
+#endif
+    if (data_ == nullptr) {
+      Read(path);
+    }
+  }
+  File(const File &) = delete;
+  File &operator=(const File &) = delete;
+  ~File() {
+#ifndef _WIN32
+    if (mapping_ != nullptr) {
+      munmap(mapping_, size_);
+    }
+#endif
+  }
+
+  const unsigned char *data() const { return data_; }
+  std::size_t size() const { return size_; }
+
+ private:
+#ifndef _WIN32
+  void Map(const char *path) {
+    const int file_descriptor = open(path, O_RDONLY);
+    if (file_descriptor < 0) {
+      return;
+    }
+    // Mappings are padded with zeros to a whole number of pages, which gives
+    // the data a null terminator unless it exactly fills the last page
+    const long page_size = sysconf(_SC_PAGESIZE);
+    struct stat status;
+    if (page_size > 0 && fstat(file_descriptor, &status) == 0 &&
+        S_ISREG(status.st_mode) && status.st_size > 0 &&
+        status.st_size % page_size != 0) {
+      const std::size_t size = static_cast<std::size_t>(status.st_size);
+      void *const mapping =
+          mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+      if (mapping != MAP_FAILED) {
+        mapping_ = mapping;
+        data_ = static_cast<const unsigned char *>(mapping);
+        size_ = size;
+      }
+    }
+    close(file_descriptor);
+  }
+#endif
+
+  void Read(const char *path) {
+    std::FILE *const file = std::fopen(path, "rb");
+    if (file == nullptr) {
+      Fail(path, "it can't be opened");
+    }
+    // Room for one more byte than the file had when it was opened so that
+    // reaching the end doesn't need another read, grown if it has changed
+    std::size_t capacity = 4096;
+    if (std::fseek(file, 0, SEEK_END) == 0) {
+      const long end = std::ftell(file);
+      if (end >= 0) {
+        capacity = static_cast<std::size_t>(end) + 1;
+      }
+    }
+    std::rewind(file);
+    buffer_.reset(new unsigned char[capacity + 1]);
+    while (true) {
+      size_ += std::fread(buffer_.get() + size_, 1, capacity - size_, file);
+      if (size_ < capacity) {
+        break;
+      }
+      std::unique_ptr<unsigned char[]> bigger(
+          new unsigned char[capacity * 2 + 1]);
+      std::memcpy(bigger.get(), buffer_.get(), size_);
+      buffer_ = std::move(bigger);
+      capacity *= 2;
+    }
+    const bool read = std::ferror(file) == 0;
+    std::fclose(file);
+    if (!read) {
+      Fail(path, "it can't be read");
+    }
+    buffer_[size_] = 0;
+    data_ = buffer_.get();
+  }
+
+  [[noreturn]] static void Fail(const char *path, const char *reason) {
+    std::fprintf(stderr, "Unable to load embedded data from %s as %s\n", path,
+                 reason);
+    std::abort();
+  }
+
+  std::size_t size_ = 0;
+  const unsigned char *data_ = nullptr;
+#ifndef _WIN32
+  void *mapping_ = nullptr;
+#endif
+  std::unique_ptr<unsigned char[]> buffer_;
+};
+}  // namespace cpp11embed_runtime_load
+#endif
+)";
+
+// How data loaded at runtime is accessed (see OutputAccessors). The inline
+// namespaces keep code built with and without CPP11_EMBED_RUNTIME_LOAD from
+// breaking the one definition rule when it is linked together.
+constexpr char k_runtime_loaded_data_accessors[] = R"(
+inline namespace cpp11embed_loaded_at_runtime {
+inline const cpp11embed_runtime_load::File &$_file() {
+  static const cpp11embed_runtime_load::File file(%);
+  return file;
+}
+
+// The data (with a null terminator after it), loaded from the file that it
+// was generated from the first time that it (or its size) is needed rather
+// than compiled in. Safe to call from several threads at once.
+inline const @ *$() { return reinterpret_cast<const @ *>($_file().data()); }
+
+// The size of the file when it was loaded, which may differ from when the
+// header was generated
+inline std::size_t $_size() { return $_file().size(); }
+}  // namespace cpp11embed_loaded_at_runtime
+)";
+
+constexpr char k_embedded_data_accessors[] = R"(
+inline namespace cpp11embed_embedded {
+// The data (with a null terminator after it)
+inline const @ *$() { return $_data; }
+
+constexpr std::size_t $_size() { return sizeof($_data) - 1; }
+}  // namespace cpp11embed_embedded
+)";
+
+void OutputRuntimeLoadHeaderImpl(const std::string &identifier_name,
+                                 const bool use_header_guard, const bool text,
+                                 const std::string &input_path,
+                                 cpp11embed::ByteSpan input,
+                                 BufferedOutput &output,
+                                 const unsigned number_of_jobs) {
+  OutputHeader(identifier_name, use_header_guard, output, [&]() {
+    output.Write("#include <cstddef>\n\n#ifdef CPP11_EMBED_RUNTIME_LOAD\n");
+    output.Write(k_runtime_loader);
+    OutputAccessors(k_runtime_loaded_data_accessors, identifier_name, text,
+                    output, input_path);
+    // Skipped entirely by the preprocessor when loading at runtime, so
+    // however large the data is it costs next to nothing to compile
+    output.Write("#else\n");
+    if (text) {
+      output.Write("constexpr char ");
+      output.Write(identifier_name);
+      output.Write("_data[] = ");
+      OutputEscapedStringLiteralImpl(input, output, number_of_jobs);
+    } else {
+      output.Write("constexpr unsigned char ");
+      output.Write(identifier_name);
+      output.Write("_data[] =\n    ");
+      OutputBinaryStringLiteralImpl(input, output, number_of_jobs);
+    }
+    output.Write(";\n");
+    OutputAccessors(k_embedded_data_accessors, identifier_name, text, output);
+    output.Write("#endif");
+  });
+}
+
+// Looks files up in a directory header. Must hash exactly like
+// cpp11embed::HashKey.
+constexpr char k_directory_lookup[] = R"(
+inline std::uint32_t hash_path(std::uint32_t seed, const char *path,
+                               std::size_t size) {
+  std::uint32_t hash = 2166136261U ^ seed;
+  for (std::size_t i = 0; i < size; i++) {
+    hash ^= static_cast<unsigned char>(path[i]);
+    hash *= 16777619U;
+  }
+  hash ^= hash >> 16;
+  hash *= 0x85EBCA6BU;
+  hash ^= hash >> 13;
+  hash *= 0xC2B2AE35U;
+  hash ^= hash >> 16;
+  return hash;
+}
+
+// Returns the file with the given path (relative to the directory and
+// separated by /) or nullptr if there isn't one
+inline const Entry *find(const char *path, std::size_t size) {
+  const std::uint32_t seed =
+      seeds[hash_path(0, path, size) % number_of_entries];
+  const Entry &entry = entries[hash_path(seed, path, size) % number_of_entries];
+  return (entry.path_size == size && std::memcmp(entry.path, path, size) == 0)
+             ? &entry
+             : nullptr;
+}
+
+inline const Entry *find(const char *path) {
+  return find(path, std::strlen(path));
+}
+)";
+
+bool OutputDirectoryHeaderImpl(
+    const std::string &identifier_name, const bool use_header_guard,
+    const std::vector<cpp11embed::DirectoryEntry> &entries,
+    const size_t alignment, BufferedOutput &output) {
+  std::vector<std::string> paths;
+  for (const cpp11embed::DirectoryEntry &entry : entries) {
+    paths.push_back(entry.path);
+  }
+  cpp11embed::PerfectHash perfect_hash;
+  if (!cpp11embed::BuildPerfectHash(paths, perfect_hash)) {
+    return false;
+  }
+  // Files stay in the order they were given (e.g. sorted by path so that
+  // files in the same directory are next to each other) but are listed in
+  // the order that find looks them up in. Files with the same contents as
+  // an earlier one share its storage.
+  std::vector<size_t> offsets;
+  std::vector<bool> is_duplicate(entries.size(), false);
+  std::vector<size_t> entry_in_slot(entries.size());
+  std::unordered_map<uint64_t, std::vector<size_t>> entries_by_hash;
+  size_t blob_size = 0;
+  size_t deduplicated_bytes = 0;
+  for (size_t i = 0; i < entries.size(); i++) {
+    const cpp11embed::ByteSpan contents = entries[i].contents;
+    entry_in_slot[perfect_hash.slots[i]] = i;
+    cpp11embed::Xxh64 hash;
+    hash.Update(contents.data, contents.size);
+    std::vector<size_t> &same_hash = entries_by_hash[hash.Digest()];
+    const auto original = std::find_if(
+        same_hash.begin(), same_hash.end(), [&](const size_t j) {
+          return entries[j].contents.size == contents.size &&
+                 std::equal(contents.data, contents.data + contents.size,
+                            entries[j].contents.data);
+        });
+    if (contents.size != 0 && original != same_hash.end()) {
+      offsets.push_back(offsets[*original]);
+      is_duplicate[i] = true;
+      deduplicated_bytes += contents.size;
+      continue;
+    }
+    same_hash.push_back(i);
+    blob_size = (blob_size + alignment - 1) / alignment * alignment;
+    offsets.push_back(blob_size);
+    blob_size += contents.size;
+  }
+
+  OutputHeader(identifier_name, use_header_guard, output, [&]() {
+    output.Write(
+        "#include <cstddef>\n#include <cstdint>\n#include <cstring>\n\n"
+        "namespace ");
+    output.Write(identifier_name);
+    output.Write(
+        " {\nstruct Entry {\n  const char *path;\n  std::size_t path_size;\n"
+        "  const unsigned char *data;\n  std::size_t size;\n};\n\n"
+        "// Every file, each aligned to ");
+    output.WriteDecimal(alignment);
+    output.Write(" bytes\nalignas(");
+    output.WriteDecimal(alignment);
+    output.Write(") constexpr unsigned char blob[] =\n    ");
+    BinaryStringLiteralWriter writer{output};
+    const std::vector<char> padding(alignment, '\0');
+    for (size_t i = 0; i < entries.size(); i++) {
+      if (is_duplicate[i]) {
+        continue;
+      }
+      writer.Write(padding.data(), offsets[i] - writer.number_of_bytes());
+      writer.Write(entries[i].contents.data, entries[i].contents.size);
+    }
+    writer.Finish();
+
+    output.Write(";\n\nconstexpr std::size_t number_of_entries = ");
+    output.WriteDecimal(entries.size());
+    output.Write(
+        ";\n// Bytes not stored because files had the same contents as an "
+        "earlier one\nconstexpr std::size_t deduplicated_bytes = ");
+    output.WriteDecimal(deduplicated_bytes);
+    output.Write(";\n\n// In the order that find looks them up in\n"
+                 "constexpr Entry entries[number_of_entries] = {\n");
+    for (const size_t i : entry_in_slot) {
+      const cpp11embed::ByteSpan path{entries[i].path.data(),
+                                      entries[i].path.size()};
+      output.Write("    {");
+      OutputEscapedStringLiteralImpl(path, output);
+      output.Write(", ");
+      output.WriteDecimal(path.size);
+      output.Write(", blob + ");
+      output.WriteDecimal(offsets[i]);
+      output.Write(", ");
+      output.WriteDecimal(entries[i].contents.size);
+      output.Write("},\n");
+    }
+    output.Write("};\n\nconstexpr std::uint32_t seeds[number_of_entries] = {");
+    for (size_t i = 0; i < perfect_hash.seeds.size(); i++) {
+      output.Write(i == 0 ? "" : ", ");
+      output.WriteDecimal(perfect_hash.seeds[i]);
+    }
+    output.Write("};\n");
+    output.Write(k_directory_lookup);
+    output.Write("}  // namespace ");
+    output.Write(identifier_name);
+  });
+  return true;
+}
+
+/**
+ * Writes what comes before the type of the array that holds binary data: a
+ * comment describing the words (if they are wider than a byte) and the
+ * alignment
+ */
+void OutputBinaryLayout(const cpp11embed::BinaryLayout &layout,
+                        BufferedOutput &output) {
+  const size_t word_size = layout.word_size;
+  if (word_size != 1) {
+    output.Write(layout.big_endian ? "// Big" : "// Little");
+    output.Write(" endian ");
+    output.WriteDecimal(word_size);
+    output.Write(" byte words, the last padded with zeros\n");
+  }
+  // Asking for less than the natural alignment is ill-formed
+  if (layout.alignment > word_size) {
+    output.Write("alignas(");
+    output.WriteDecimal(layout.alignment);
+    output.Write(") ");
+  }
+}
+
+/**
+ * Writes the array that holds the data along with its size (when that isn't
+ * just the size of the array)
+ * @param size the number of bytes in the input
+ * @param max_bytes stop after this many bytes even if there is more input
+ * @returns the number of bytes written, which is less than size if the input
+ * ended early
+ */
+template <typename Input>
+size_t OutputBinaryDataDefinition(
+    const std::string &identifier_name, Input &input, const size_t size,
+    const cpp11embed::BinaryLayout &layout,
+    const cpp11embed::DataMetadata &metadata, BufferedOutput &output,
+    const unsigned number_of_jobs,
+    const size_t max_bytes = std::numeric_limits<size_t>::max()) {
+  const size_t word_size = layout.word_size;
+  if (word_size == 1) {
+    output.Write(metadata.enabled
+                     ? "#include <array>\n#include <cstddef>\n"
+                       "#include <cstdint>\n\n"
+                     : "#include <array>\n#include <cstdint>\n\n");
+  } else {
+    output.Write(
+        "#include <array>\n#include <cstddef>\n#include <cstdint>\n\n");
+  }
+  OutputBinaryLayout(layout, output);
+  output.Write("constexpr std::array<uint");
+  output.WriteDecimal(word_size * 8);
+  output.Write("_t, ");
+  output.WriteDecimal((size + word_size - 1) / word_size);
+  output.Write("> ");
+  output.Write(identifier_name);
+  output.Write('{');
+  DataDigests digests;
+  DataDigests *const digests_to_update = metadata.enabled ? &digests : nullptr;
+  size_t bytes_written;
+  if (word_size == 1) {
+    bytes_written = WriteInput(input, output, number_of_jobs,
+                               k_make_binary_initialiser_writer, max_bytes,
+                               digests_to_update);
+  } else {
+    bytes_written = WriteInput(
+        input, output, number_of_jobs,
+        [&layout](BufferedOutput &chunk_output, const size_t offset) {
+          return WordInitialiserWriter{chunk_output, layout, offset};
+        },
+        max_bytes, digests_to_update);
+  }
+  output.Write("};");
+  if (word_size != 1) {
+    output.Write("\nconstexpr std::size_t ");
+    output.Write(identifier_name);
+    output.Write("_size = ");
+    output.WriteDecimal(size);
+    output.Write(';');
+  }
+  if (metadata.enabled) {
+    OutputMetadata(identifier_name, metadata, digests, word_size != 1,
+                   output);
+  }
+  return bytes_written;
+}
+
+/**
+ * Writes the array that holds data whose size isn't known up front (e.g. as
+ * it comes from a pipe) as the data is read, followed by its size. It is a
+ * plain array rather than a std::array as the size of a std::array has to
+ * come before its initialiser.
+ * @param start what has already been read from the stream, a multiple of
+ * k_chunk_size
+ */
+void OutputStreamedBinaryDataDefinition(
+    const std::string &identifier_name, const cpp11embed::ByteSpan start,
+    std::istream &input_stream, const cpp11embed::BinaryLayout &layout,
+    const cpp11embed::DataMetadata &metadata, BufferedOutput &output,
+    const unsigned number_of_jobs) {
+  const size_t word_size = layout.word_size;
+  output.Write("#include <cstddef>\n#include <cstdint>\n\n");
+  OutputBinaryLayout(layout, output);
+  output.Write("constexpr uint");
+  output.WriteDecimal(word_size * 8);
+  output.Write("_t ");
+  output.Write(identifier_name);
+  output.Write("[] = {");
+  DataDigests digests;
+  DataDigests *const digests_to_update = metadata.enabled ? &digests : nullptr;
+  const auto write = [&](const auto &make_writer) {
+    const size_t start_size =
+        WriteInput(start, output, number_of_jobs, make_writer,
+                   std::numeric_limits<size_t>::max(), digests_to_update);
+    return start_size +
+           WriteInput(input_stream, output, number_of_jobs, make_writer,
+                      std::numeric_limits<size_t>::max(), digests_to_update,
+                      start_size);
+  };
+  const size_t size =
+      (word_size == 1)
+          ? write(k_make_binary_initialiser_writer)
+          : write([&layout](BufferedOutput &chunk_output,
+                            const size_t offset) {
+              return WordInitialiserWriter{chunk_output, layout, offset};
+            });
+  if (size == 0) {
+    // Arrays can't be empty
+    output.Write('0');
+  }
+  output.Write("};\nconstexpr std::size_t ");
+  output.Write(identifier_name);
+  output.Write("_size = ");
+  output.WriteDecimal(size);
+  output.Write(';');
+  if (metadata.enabled) {
+    OutputMetadata(identifier_name, metadata, digests, true, output);
+  }
+}
+
+/**
+ * @returns the offset of the shard in data of the given size. Every shard is
+ * the same size apart from the last (which may be smaller or even empty).
+ */
+size_t GetShardOffset(const size_t size, const size_t shard,
+                      const size_t number_of_shards) {
+  const size_t shard_size = (size + number_of_shards - 1) / number_of_shards;
+  return std::min(shard * shard_size, size);
+}
+
+size_t GetShardSize(const size_t size, const size_t shard,
+                    const size_t number_of_shards) {
+  return GetShardOffset(size, shard + 1, number_of_shards) -
+         GetShardOffset(size, shard, number_of_shards);
+}
+
+std::string GetShardIdentifierName(const std::string &identifier_name,
+                                   const size_t shard,
+                                   const size_t number_of_shards) {
+  return (number_of_shards == 1)
+             ? identifier_name
+             : identifier_name + "_shard_" + std::to_string(shard);
+}
+
+/**
+ * Writes the type and name of the array that holds a shard
+ * @param size the number of bytes in the shard
+ */
+void OutputShardDeclarator(const std::string &identifier_name,
+                           const cpp11embed::DefinitionType type,
+                           const size_t size, const size_t shard,
+                           const size_t number_of_shards,
+                           BufferedOutput &output) {
+  const std::string shard_identifier_name =
+      GetShardIdentifierName(identifier_name, shard, number_of_shards);
+  // Shards that don't make up the whole of the data are always stored in
+  // string literals, which are much quicker to compile
+  if (number_of_shards == 1 &&
+      type == cpp11embed::DefinitionType::k_binary_array) {
+    output.Write("const std::array<uint8_t, ");
+    output.WriteDecimal(size);
+    output.Write("> ");
+    output.Write(shard_identifier_name);
+    return;
   }
+  output.Write((type == cpp11embed::DefinitionType::k_text)
+                   ? "const char "
+                   : "const unsigned char ");
+  output.Write(shard_identifier_name);
+  output.Write('[');
+  // Room for the null terminator of the string literal
+  output.WriteDecimal(size + 1);
+  output.Write(']');
+}
+
+void OutputBinaryDataHeaderImpl(
+    const std::string &identifier_name, const bool use_header_guard,
+    const cpp11embed::ByteSpan input, BufferedOutput &output,
+    const unsigned number_of_jobs = 1,
+    const cpp11embed::BinaryLayout &layout = cpp11embed::BinaryLayout{},
+    const cpp11embed::DataMetadata &metadata = cpp11embed::DataMetadata{}) {
+  OutputHeader(identifier_name, use_header_guard, output, [&]() {
+    OutputBinaryDataDefinition(identifier_name, input, input.size, layout,
+                               metadata, output, number_of_jobs);
+  });
 }
 }  // namespace
 
@@ -85,53 +1412,161 @@ void OutputEscapedCharacter(const char c, std::ostream &out) {
   }
 }
 
+std::string GuessContentType(const std::string &filename, const bool text) {
+  static const std::unordered_map<std::string, std::string> k_content_types{
+      {"css", "text/css"},
+      {"csv", "text/csv"},
+      {"frag", "text/x-glsl"},
+      {"gif", "image/gif"},
+      {"glsl", "text/x-glsl"},
+      {"htm", "text/html"},
+      {"html", "text/html"},
+      {"ico", "image/vnd.microsoft.icon"},
+      {"jpeg", "image/jpeg"},
+      {"jpg", "image/jpeg"},
+      {"js", "text/javascript"},
+      {"json", "application/json"},
+      {"md", "text/markdown"},
+      {"pdf", "application/pdf"},
+      {"png", "image/png"},
+      {"sql", "application/sql"},
+      {"svg", "image/svg+xml"},
+      {"ttf", "font/ttf"},
+      {"txt", "text/plain"},
+      {"vert", "text/x-glsl"},
+      {"wasm", "application/wasm"},
+      {"webp", "image/webp"},
+      {"woff", "font/woff"},
+      {"woff2", "font/woff2"},
+      {"xml", "application/xml"},
+      {"yaml", "application/yaml"},
+      {"yml", "application/yaml"},
+      {"zip", "application/zip"}};
+  const size_t name_start = filename.find_last_of("/\\") + 1;
+  const size_t extension_start = filename.rfind('.');
+  if (extension_start != std::string::npos && extension_start > name_start) {
+    std::string extension = filename.substr(extension_start + 1);
+    std::transform(
+        extension.begin(), extension.end(), extension.begin(),
+        [](const char c) { return static_cast<char>(std::tolower(c)); });
+    const auto content_type = k_content_types.find(extension);
+    if (content_type != k_content_types.end()) {
+      return content_type->second;
+    }
+  }
+  return text ? "text/plain" : "application/octet-stream";
+}
+
+void OutputEscapedByte(const char c, std::ostream &out) {
+  const auto byte = static_cast<uint8_t>(c);
+  if ((byte >= ' ' && byte <= '~') || (byte >= '\a' && byte <= '\r')) {
+    OutputEscapedCharacter(c, out);
+  } else {
+    out << '\\' << static_cast<char>('0' + ((byte >> 6) & 7))
+        << static_cast<char>('0' + ((byte >> 3) & 7))
+        << static_cast<char>('0' + (byte & 7));
+  }
+}
+
 void OutputEscapedStringLiteral(std::istream &input_stream,
                                 std::ostream &output_stream) {
-  output_stream << '"';
-  std::for_each(std::istreambuf_iterator<char>(input_stream),
-                std::istreambuf_iterator<char>(),
-                [&output_stream](const char c) {
-                  OutputEscapedCharacter(c, output_stream);
-                });
-  output_stream << '"';
+  OstreamSink sink{output_stream};
+  BufferedOutput output{sink};
+  OutputEscapedStringLiteralImpl(input_stream, output);
+}
+
+void OutputEscapedStringLiteral(ByteSpan input, std::ostream &output_stream) {
+  OstreamSink sink{output_stream};
+  BufferedOutput output{sink};
+  OutputEscapedStringLiteralImpl(input, output);
 }
 
 void OutputEscapedStringLiteralHeader(const std::string &identifier_name,
                                       const bool use_header_guard,
                                       std::istream &input_stream,
                                       std::ostream &output_stream) {
-  OutputHeader(identifier_name, use_header_guard, input_stream, output_stream,
-               [](const std::string &identifier_name,
-                  std::istream &input_stream, std::ostream &output_stream) {
-                 output_stream << "constexpr char " << identifier_name
-                               << "[] = ";
-                 OutputEscapedStringLiteral(input_stream, output_stream);
-                 output_stream << ";";
-               });
+  OstreamSink sink{output_stream};
+  OutputEscapedStringLiteralHeader(identifier_name, use_header_guard,
+                                   input_stream, sink);
+}
+
+void OutputEscapedStringLiteralHeader(const std::string &identifier_name,
+                                      const bool use_header_guard,
+                                      ByteSpan input,
+                                      std::ostream &output_stream) {
+  OstreamSink sink{output_stream};
+  OutputEscapedStringLiteralHeader(identifier_name, use_header_guard, input,
+                                   sink);
+}
+
+void OutputEscapedStringLiteralHeader(const std::string &identifier_name,
+                                      const bool use_header_guard,
+                                      std::istream &input_stream,
+                                      OutputSink &sink,
+                                      const unsigned number_of_jobs,
+                                      const MinifyFormat minify_format,
+                                      const DataMetadata &metadata) {
+  BufferedOutput output{sink};
+  OutputEscapedStringLiteralHeaderImpl(identifier_name, use_header_guard,
+                                       input_stream, output, number_of_jobs,
+                                       minify_format, metadata);
+}
+
+void OutputEscapedStringLiteralHeader(const std::string &identifier_name,
+                                      const bool use_header_guard,
+                                      ByteSpan input, OutputSink &sink,
+                                      const unsigned number_of_jobs,
+                                      const MinifyFormat minify_format,
+                                      const DataMetadata &metadata) {
+  BufferedOutput output{sink};
+  OutputEscapedStringLiteralHeaderImpl(identifier_name, use_header_guard,
+                                       input, output, number_of_jobs,
+                                       minify_format, metadata);
+}
+
+std::streamoff GetRemainingStreamSize(std::istream &input_stream) {
+  if (!input_stream) {
+    return -1;
+  }
+  const std::istream::pos_type current_position = input_stream.tellg();
+  if (current_position == std::istream::pos_type(-1)) {
+    input_stream.clear();
+    return -1;
+  }
+  input_stream.seekg(0, std::ios::end);
+  const std::istream::pos_type end_position = input_stream.tellg();
+  input_stream.seekg(current_position);
+  if (!input_stream || end_position == std::istream::pos_type(-1)) {
+    input_stream.clear();
+    input_stream.seekg(current_position);
+    return -1;
+  }
+  return end_position - current_position;
+}
+
+size_t OutputBinaryInitialiser(std::istream &input_stream,
+                               std::ostream &output_stream,
+                               const size_t max_bytes) {
+  OstreamSink sink{output_stream};
+  BufferedOutput output{sink};
+  output.Write('{');
+  BinaryInitialiserWriter writer{output};
+  WriteStreamInBlocks(input_stream, writer, max_bytes);
+  output.Write('}');
+  return writer.number_of_elements();
+}
+
+size_t OutputBinaryInitialiser(ByteSpan input, std::ostream &output_stream) {
+  OstreamSink sink{output_stream};
+  BufferedOutput output{sink};
+  return OutputBinaryInitialiserImpl(input, output);
 }
 
 InitialiserAndNumberOfElements GetBinaryInitialiser(
     std::istream &input_stream) {
   std::ostringstream output_stream;
-  output_stream << "{";
-  size_t num_elements = 0;
-  if (input_stream) {
-    while (1) {
-      uint8_t c;
-      input_stream.read(reinterpret_cast<char *>(&c), sizeof(uint8_t));
-      output_stream << std::to_string(c);
-      num_elements++;
-      // Check to see if there is another byte
-      input_stream.peek();
-      if (input_stream.eof()) {
-        break;
-      } else {
-        // Not yet at the last element
-        output_stream << ", ";
-      }
-    }
-  }
-  output_stream << "}";
+  const size_t num_elements =
+      OutputBinaryInitialiser(input_stream, output_stream);
   return {output_stream.str(), num_elements};
 }
 
@@ -139,18 +1574,507 @@ void OutputBinaryDataHeader(const std::string &identifier_name,
                             const bool use_header_guard,
                             std::istream &input_stream,
                             std::ostream &output_stream) {
-  OutputHeader(
-      identifier_name, use_header_guard, input_stream, output_stream,
-      [](const std::string &identifier_name, std::istream &input_stream,
-         std::ostream &output_stream) {
-        const InitialiserAndNumberOfElements binary_initialiser_details =
-            GetBinaryInitialiser(input_stream);
-        output_stream << "#include <array>\n"
-                      << "#include <cstdint>\n\n"
-                      << "constexpr std::array<uint8_t, "
-                      << binary_initialiser_details.number_of_elements << "> "
-                      << identifier_name
-                      << binary_initialiser_details.initialiser << ";";
-      });
-}
-}  // namespace cpp11embed
\ No newline at end of file
+  OstreamSink sink{output_stream};
+  OutputBinaryDataHeader(identifier_name, use_header_guard, input_stream,
+                         sink);
+}
+
+void OutputBinaryDataHeader(const std::string &identifier_name,
+                            const bool use_header_guard, ByteSpan input,
+                            std::ostream &output_stream) {
+  OstreamSink sink{output_stream};
+  OutputBinaryDataHeader(identifier_name, use_header_guard, input, sink);
+}
+
+void OutputBinaryDataHeader(const std::string &identifier_name,
+                            const bool use_header_guard,
+                            std::istream &input_stream, OutputSink &sink,
+                            const unsigned number_of_jobs,
+                            const BinaryLayout &layout,
+                            const DataMetadata &metadata) {
+  BufferedOutput output{sink};
+  const std::streamoff input_size = GetRemainingStreamSize(input_stream);
+  if (input_size < 0) {
+    // Can't find out how big the input is (e.g. it is a pipe) without
+    // reading all of it. Inputs that fit in a chunk are embedded just as
+    // they would be from a file, anything bigger is streamed so that memory
+    // use doesn't grow with the input.
+    std::string start(k_chunk_size, '\0');
+    size_t start_size = 0;
+    if (input_stream) {
+      input_stream.read(&start[0], static_cast<std::streamsize>(start.size()));
+      start_size = static_cast<size_t>(input_stream.gcount());
+    }
+    const ByteSpan start_span{start.data(), start_size};
+    if (!input_stream) {
+      OutputBinaryDataHeaderImpl(identifier_name, use_header_guard,
+                                 start_span, output, number_of_jobs, layout,
+                                 metadata);
+      return;
+    }
+    OutputHeader(identifier_name, use_header_guard, output, [&]() {
+      OutputStreamedBinaryDataDefinition(identifier_name, start_span,
+                                         input_stream, layout, metadata,
+                                         output, number_of_jobs);
+    });
+    return;
+  }
+
+  // The size is known up front so the initialiser can be streamed straight
+  // to the output
+  size_t bytes_written;
+  OutputHeader(identifier_name, use_header_guard, output, [&]() {
+    bytes_written = OutputBinaryDataDefinition(
+        identifier_name, input_stream, static_cast<size_t>(input_size),
+        layout, metadata, output, number_of_jobs,
+        static_cast<size_t>(input_size));
+  });
+  if (bytes_written != static_cast<size_t>(input_size)) {
+    // The array would have been silently padded with zeros
+    throw std::runtime_error("The input ended before the end of the file");
+  }
+}
+
+void OutputBinaryDataHeader(const std::string &identifier_name,
+                            const bool use_header_guard, ByteSpan input,
+                            OutputSink &sink, const unsigned number_of_jobs,
+                            const BinaryLayout &layout,
+                            const DataMetadata &metadata) {
+  BufferedOutput output{sink};
+  OutputBinaryDataHeaderImpl(identifier_name, use_header_guard, input, output,
+                             number_of_jobs, layout, metadata);
+}
+
+size_t OutputBinaryStringLiteral(std::istream &input_stream,
+                                 std::ostream &output_stream) {
+  OstreamSink sink{output_stream};
+  BufferedOutput output{sink};
+  return OutputBinaryStringLiteralImpl(input_stream, output);
+}
+
+size_t OutputBinaryStringLiteral(ByteSpan input, std::ostream &output_stream) {
+  OstreamSink sink{output_stream};
+  BufferedOutput output{sink};
+  return OutputBinaryStringLiteralImpl(input, output);
+}
+
+void OutputBinaryStringLiteralHeader(const std::string &identifier_name,
+                                     const bool use_header_guard,
+                                     std::istream &input_stream,
+                                     std::ostream &output_stream) {
+  OstreamSink sink{output_stream};
+  OutputBinaryStringLiteralHeader(identifier_name, use_header_guard,
+                                  input_stream, sink);
+}
+
+void OutputBinaryStringLiteralHeader(const std::string &identifier_name,
+                                     const bool use_header_guard,
+                                     ByteSpan input,
+                                     std::ostream &output_stream) {
+  OstreamSink sink{output_stream};
+  OutputBinaryStringLiteralHeader(identifier_name, use_header_guard, input,
+                                  sink);
+}
+
+void OutputBinaryStringLiteralHeader(const std::string &identifier_name,
+                                     const bool use_header_guard,
+                                     std::istream &input_stream,
+                                     OutputSink &sink,
+                                     const unsigned number_of_jobs,
+                                     const DataMetadata &metadata) {
+  BufferedOutput output{sink};
+  OutputBinaryStringLiteralHeaderImpl(identifier_name, use_header_guard,
+                                      input_stream, output, number_of_jobs,
+                                      metadata);
+}
+
+void OutputBinaryStringLiteralHeader(const std::string &identifier_name,
+                                     const bool use_header_guard,
+                                     ByteSpan input, OutputSink &sink,
+                                     const unsigned number_of_jobs,
+                                     const DataMetadata &metadata) {
+  BufferedOutput output{sink};
+  OutputBinaryStringLiteralHeaderImpl(identifier_name, use_header_guard,
+                                      input, output, number_of_jobs,
+                                      metadata);
+}
+
+void OutputCompressedDataHeader(const std::string &identifier_name,
+                                const bool use_header_guard, const bool text,
+                                std::istream &input_stream,
+                                std::ostream &output_stream) {
+  OstreamSink sink{output_stream};
+  OutputCompressedDataHeader(identifier_name, use_header_guard, text,
+                             input_stream, sink);
+}
+
+void OutputCompressedDataHeader(const std::string &identifier_name,
+                                const bool use_header_guard, const bool text,
+                                ByteSpan input, std::ostream &output_stream) {
+  OstreamSink sink{output_stream};
+  OutputCompressedDataHeader(identifier_name, use_header_guard, text, input,
+                             sink);
+}
+
+void OutputCompressedDataHeader(const std::string &identifier_name,
+                                const bool use_header_guard, const bool text,
+                                std::istream &input_stream, OutputSink &sink) {
+  // The whole input is needed to compress it
+  std::string input;
+  if (input_stream) {
+    input.assign(std::istreambuf_iterator<char>(input_stream),
+                 std::istreambuf_iterator<char>());
+  }
+  OutputCompressedDataHeader(identifier_name, use_header_guard, text,
+                             ByteSpan{input.data(), input.size()}, sink);
+}
+
+void OutputCompressedDataHeader(const std::string &identifier_name,
+                                const bool use_header_guard, const bool text,
+                                ByteSpan input, OutputSink &sink) {
+  BufferedOutput output{sink};
+  OutputCompressedDataHeaderImpl(identifier_name, use_header_guard, text,
+                                 input, output);
+}
+
+void OutputRuntimeLoadHeader(const std::string &identifier_name,
+                             const bool use_header_guard, const bool text,
+                             const std::string &input_path,
+                             std::istream &input_stream,
+                             std::ostream &output_stream) {
+  OstreamSink sink{output_stream};
+  OutputRuntimeLoadHeader(identifier_name, use_header_guard, text, input_path,
+                          input_stream, sink);
+}
+
+void OutputRuntimeLoadHeader(const std::string &identifier_name,
+                             const bool use_header_guard, const bool text,
+                             const std::string &input_path, ByteSpan input,
+                             std::ostream &output_stream) {
+  OstreamSink sink{output_stream};
+  OutputRuntimeLoadHeader(identifier_name, use_header_guard, text, input_path,
+                          input, sink);
+}
+
+void OutputRuntimeLoadHeader(const std::string &identifier_name,
+                             const bool use_header_guard, const bool text,
+                             const std::string &input_path,
+                             std::istream &input_stream, OutputSink &sink,
+                             const unsigned number_of_jobs) {
+  // The size has to be known before any of the data is written out
+  std::string input;
+  if (input_stream) {
+    input.assign(std::istreambuf_iterator<char>(input_stream),
+                 std::istreambuf_iterator<char>());
+  }
+  OutputRuntimeLoadHeader(identifier_name, use_header_guard, text, input_path,
+                          ByteSpan{input.data(), input.size()}, sink,
+                          number_of_jobs);
+}
+
+void OutputRuntimeLoadHeader(const std::string &identifier_name,
+                             const bool use_header_guard, const bool text,
+                             const std::string &input_path, ByteSpan input,
+                             OutputSink &sink, const unsigned number_of_jobs) {
+  BufferedOutput output{sink};
+  OutputRuntimeLoadHeaderImpl(identifier_name, use_header_guard, text,
+                              input_path, input, output, number_of_jobs);
+}
+
+bool OutputDirectoryHeader(const std::string &identifier_name,
+                           const bool use_header_guard,
+                           const std::vector<DirectoryEntry> &entries,
+                           const size_t alignment,
+                           std::ostream &output_stream) {
+  OstreamSink sink{output_stream};
+  return OutputDirectoryHeader(identifier_name, use_header_guard, entries,
+                               alignment, sink);
+}
+
+bool OutputDirectoryHeader(const std::string &identifier_name,
+                           const bool use_header_guard,
+                           const std::vector<DirectoryEntry> &entries,
+                           const size_t alignment, OutputSink &sink) {
+  BufferedOutput output{sink};
+  return OutputDirectoryHeaderImpl(identifier_name, use_header_guard, entries,
+                                   alignment, output);
+}
+
+void OutputAliasHeader(const std::string &identifier_name,
+                       const bool use_header_guard,
+                       const std::string &canonical_identifier_name,
+                       const std::string &include_path,
+                       const AliasedHeader aliased_header,
+                       std::ostream &output_stream, const bool metadata) {
+  OstreamSink sink{output_stream};
+  OutputAliasHeader(identifier_name, use_header_guard,
+                    canonical_identifier_name, include_path, aliased_header,
+                    sink, metadata);
+}
+
+void OutputAliasHeader(const std::string &identifier_name,
+                       const bool use_header_guard,
+                       const std::string &canonical_identifier_name,
+                       const std::string &include_path,
+                       const AliasedHeader aliased_header, OutputSink &sink,
+                       const bool metadata) {
+  BufferedOutput output{sink};
+  const auto output_alias = [&](const char *type, const char *suffix) {
+    output.Write('\n');
+    output.Write(type);
+    output.Write(identifier_name);
+    output.Write(suffix);
+    output.Write(" = ");
+    output.Write(canonical_identifier_name);
+    output.Write(suffix);
+    output.Write(';');
+  };
+  OutputHeader(identifier_name, use_header_guard, output, [&]() {
+    output.Write("#include <cstddef>\n\n#include \"");
+    output.Write(include_path);
+    output.Write("\"\n\n// The same data as ");
+    output.Write(canonical_identifier_name);
+    output.Write(" rather than another copy of it");
+    // A reference at namespace scope has external linkage unless it is
+    // declared static (unlike the constexpr data that it refers to)
+    const char *const reference_type = "static constexpr const auto &";
+    const char *const size_type = "constexpr std::size_t ";
+    switch (aliased_header) {
+      case AliasedHeader::k_data:
+        output_alias(reference_type, "");
+        break;
+      case AliasedHeader::k_binary_string_literal:
+        output_alias(reference_type, "");
+        output_alias(size_type, "_size");
+        break;
+      case AliasedHeader::k_compressed:
+        output_alias(reference_type, "_compressed");
+        output_alias(size_type, "_compressed_size");
+        output_alias(size_type, "_size");
+        output.Write("\n\ninline bool ");
+        output.Write(identifier_name);
+        output.Write("_decompress(void *buffer) {\n  return ");
+        output.Write(canonical_identifier_name);
+        output.Write("_decompress(buffer);\n}\n\ninline auto ");
+        output.Write(identifier_name);
+        output.Write("() -> decltype(");
+        output.Write(canonical_identifier_name);
+        output.Write("()) {\n  return ");
+        output.Write(canonical_identifier_name);
+        output.Write("();\n}");
+        break;
+    }
+    if (metadata) {
+      if (aliased_header == AliasedHeader::k_data) {
+        output_alias(size_type, "_size");
+      }
+      output_alias("constexpr auto ", "_crc32c");
+      output_alias("constexpr auto ", "_xxh64");
+      output_alias(reference_type, "_content_type");
+    }
+  });
+}
+
+void OutputDeclarationHeader(const std::string &identifier_name,
+                             const bool use_header_guard,
+                             const DefinitionType type, const size_t size,
+                             const size_t number_of_shards,
+                             std::ostream &output_stream) {
+  OstreamSink sink{output_stream};
+  OutputDeclarationHeader(identifier_name, use_header_guard, type, size,
+                          number_of_shards, sink);
+}
+
+void OutputDeclarationHeader(const std::string &identifier_name,
+                             const bool use_header_guard,
+                             const DefinitionType type, const size_t size,
+                             const size_t number_of_shards,
+                             OutputSink &sink) {
+  BufferedOutput output{sink};
+  OutputHeader(identifier_name, use_header_guard, output, [&]() {
+    output.Write((number_of_shards == 1 &&
+                  type == DefinitionType::k_binary_array)
+                     ? "#include <array>\n#include <cstddef>\n#include "
+                       "<cstdint>\n\nconstexpr std::size_t "
+                     : "#include <cstddef>\n\nconstexpr std::size_t ");
+    output.Write(identifier_name);
+    output.Write("_size = ");
+    output.WriteDecimal(size);
+    output.Write(";\n");
+    if (number_of_shards == 1) {
+      output.Write("extern ");
+      OutputShardDeclarator(identifier_name, type, size, 0, 1, output);
+      output.Write(';');
+      return;
+    }
+
+    output.Write("constexpr std::size_t ");
+    output.Write(identifier_name);
+    output.Write("_shard_size = ");
+    output.WriteDecimal(GetShardSize(size, 0, number_of_shards));
+    output.Write(";\nconstexpr std::size_t ");
+    output.Write(identifier_name);
+    output.Write("_number_of_shards = ");
+    output.WriteDecimal(number_of_shards);
+    output.Write(";\n\n");
+    for (size_t shard = 0; shard < number_of_shards; shard++) {
+      output.Write("extern ");
+      OutputShardDeclarator(identifier_name, type,
+                            GetShardSize(size, shard, number_of_shards), shard,
+                            number_of_shards, output);
+      output.Write(";\n");
+    }
+    output.Write("\nconstexpr const ");
+    output.Write((type == DefinitionType::k_text) ? "char" : "unsigned char");
+    output.Write(" *");
+    output.Write(identifier_name);
+    output.Write("_shards[");
+    output.Write(identifier_name);
+    output.Write("_number_of_shards] = {");
+    for (size_t shard = 0; shard < number_of_shards; shard++) {
+      output.Write("\n    ");
+      output.Write(GetShardIdentifierName(identifier_name, shard,
+                                          number_of_shards));
+      output.Write(',');
+    }
+    output.Write("\n};");
+  });
+}
+
+void OutputDefinitionSource(const std::string &identifier_name,
+                            const DefinitionType type,
+                            const std::string &header_include_path,
+                            const ByteSpan input, const size_t shard,
+                            const size_t number_of_shards,
+                            std::ostream &output_stream) {
+  OstreamSink sink{output_stream};
+  OutputDefinitionSource(identifier_name, type, header_include_path, input,
+                         shard, number_of_shards, sink);
+}
+
+void OutputDefinitionSource(const std::string &identifier_name,
+                            const DefinitionType type,
+                            const std::string &header_include_path,
+                            const ByteSpan input, const size_t shard,
+                            const size_t number_of_shards, OutputSink &sink) {
+  BufferedOutput output{sink};
+  ByteSpan shard_input{
+      input.data + GetShardOffset(input.size, shard, number_of_shards),
+      GetShardSize(input.size, shard, number_of_shards)};
+  // Including the header makes sure that the definition matches the
+  // declaration (and gives it external linkage)
+  output.Write("#include \"");
+  output.Write(header_include_path);
+  output.Write("\"\n\n");
+  OutputShardDeclarator(identifier_name, type, shard_input.size, shard,
+                        number_of_shards, output);
+  if (type == DefinitionType::k_text) {
+    output.Write(" = ");
+    OutputEscapedStringLiteralImpl(shard_input, output);
+  } else if (number_of_shards == 1 &&
+             type == DefinitionType::k_binary_array) {
+    OutputBinaryInitialiserImpl(shard_input, output);
+  } else {
+    output.Write(" =\n    ");
+    OutputBinaryStringLiteralImpl(shard_input, output);
+  }
+  output.Write(";\n");
+}
+
+void OutputExternBinaryDataHeader(const std::string &identifier_name,
+                                  const bool use_header_guard,
+                                  const size_t size,
+                                  std::ostream &output_stream) {
+  OstreamSink sink{output_stream};
+  OutputExternBinaryDataHeader(identifier_name, use_header_guard, size, sink);
+}
+
+void OutputExternBinaryDataHeader(const std::string &identifier_name,
+                                  const bool use_header_guard,
+                                  const size_t size, OutputSink &sink) {
+  BufferedOutput output{sink};
+  OutputHeader(identifier_name, use_header_guard, output, [&]() {
+    output.Write(
+        "#include <cstddef>\n#include <cstdint>\n\nextern \"C\" const "
+        "uint8_t ");
+    output.Write(identifier_name);
+    output.Write('[');
+    // Zero length arrays are not allowed
+    if (size != 0) {
+      output.WriteDecimal(size);
+    }
+    output.Write("];\nextern \"C\" const std::size_t ");
+    output.Write(identifier_name);
+    output.Write("_size;");
+  });
+}
+
+void OutputIncbinAssembly(const std::string &identifier_name,
+                          const std::string &input_file_path,
+                          std::ostream &output_stream, const size_t alignment) {
+  // Needs to be run through the C preprocessor (i.e. a .S file) so that it
+  // can adapt to the size of size_t
+  output_stream << "/* Generated by Cpp11Embed */\n"
+                << "#if !defined(__ELF__)\n"
+                << "#error \"Cpp11Embed .incbin output requires an ELF "
+                   "target\"\n"
+                << "#endif\n\n"
+                << "    .section .rodata\n"
+                << "    .global " << identifier_name << "\n"
+                << "    .type " << identifier_name << ", %object\n"
+                << "    .balign " << alignment << "\n"
+                << identifier_name << ":\n"
+                << "    .incbin \"";
+  for (const char c : input_file_path) {
+    if (c == '\\' || c == '"') {
+      output_stream << '\\';
+    }
+    output_stream << c;
+  }
+  output_stream << "\"\n"
+                << ".L" << identifier_name << "_end:\n"
+                << "    .size " << identifier_name << ", .L" << identifier_name
+                << "_end - " << identifier_name << "\n\n"
+                << "    .global " << identifier_name << "_size\n"
+                << "    .type " << identifier_name << "_size, %object\n"
+                << "    .balign __SIZEOF_SIZE_T__\n"
+                << identifier_name << "_size:\n"
+                << "#if __SIZEOF_SIZE_T__ == 8\n"
+                << "    .quad .L" << identifier_name << "_end - "
+                << identifier_name << "\n"
+                << "#else\n"
+                << "    .long .L" << identifier_name << "_end - "
+                << identifier_name << "\n"
+                << "#endif\n"
+                << "    .size " << identifier_name
+                << "_size, __SIZEOF_SIZE_T__\n\n"
+                << "    .section .note.GNU-stack,\"\",%progbits\n";
+}
+
+void OutputMakeDepfile(const std::string &target,
+                       const std::vector<std::string> &prerequisites,
+                       std::ostream &output_stream) {
+  const auto output_escaped_path = [&output_stream](const std::string &path) {
+    for (const char c : path) {
+      switch (c) {
+        case ' ':
+        case '#':
+          output_stream << '\\' << c;
+          break;
+        case '$':
+          output_stream << "$$";
+          break;
+        default:
+          output_stream << c;
+      }
+    }
+  };
+  output_escaped_path(target);
+  output_stream << ':';
+  for (const std::string &prerequisite : prerequisites) {
+    output_stream << ' ';
+    output_escaped_path(prerequisite);
+  }
+  output_stream << '\n';
+}
+}  // namespace cpp11embed
@@ -1,18 +1,94 @@
 #include <istream>
+#include <limits>
 #include <ostream>
+#include <string>
+#include <vector>
 
+#include "ByteSpan.h"
+#include "Minify.h"
+#include "OutputSink.h"
+
+// Functions that read input take either a stream, which is read in blocks,
+// or a ByteSpan holding all of it (e.g. a MappedFile), which is formatted
+// straight from memory. Both produce exactly the same output.
+// Headers can be written to an OutputSink as well as a stream, which avoids
+// the stream entirely (all output is buffered either way). Those functions
+// can also format large inputs in chunks spread across number_of_jobs threads
+// (0 for as many as there are cores), which gives exactly the same output.
 namespace cpp11embed {
 std::string GetSafeHeaderGuardIdentifier(const std::string &unsafe);
 
 void OutputEscapedCharacter(char c, std::ostream &out);
 
+/**
+ * Constants describing the data that can be written after it, so that it can
+ * be checked (or used as a cache key) without hashing it at runtime:
+ * <identifier_name>_size, <identifier_name>_crc32c (CRC-32C),
+ * <identifier_name>_xxh64 (XXH64 with a seed of 0) and
+ * <identifier_name>_content_type. They are all of the data as it is embedded
+ * (so after any minifying, and without null terminators or padding).
+ */
+struct DataMetadata {
+  bool enabled = false;
+  // e.g. application/json (see GuessContentType)
+  std::string content_type;
+};
+
+/**
+ * @returns a MIME type for the file based on its extension, or text/plain or
+ * application/octet-stream (depending on whether it is embedded as text) if
+ * the extension isn't known
+ */
+std::string GuessContentType(const std::string &filename, bool text);
+
+/**
+ * Like OutputEscapedCharacter but for arbitrary bytes rather than text:
+ * anything that is not printable is written as an octal escape sequence.
+ */
+void OutputEscapedByte(char c, std::ostream &out);
+
 void OutputEscapedStringLiteral(std::istream &input_stream,
                                 std::ostream &output_stream);
+void OutputEscapedStringLiteral(ByteSpan input, std::ostream &output_stream);
 
 void OutputEscapedStringLiteralHeader(const std::string &identifier_name,
                                       bool use_header_guard,
                                       std::istream &input_stream,
                                       std::ostream &output_stream);
+void OutputEscapedStringLiteralHeader(const std::string &identifier_name,
+                                      bool use_header_guard, ByteSpan input,
+                                      std::ostream &output_stream);
+/**
+ * @param minify_format if not MinifyFormat::k_none the text is minified
+ * before it is escaped, in which case it is never split across threads
+ */
+void OutputEscapedStringLiteralHeader(
+    const std::string &identifier_name, bool use_header_guard,
+    std::istream &input_stream, OutputSink &sink, unsigned number_of_jobs = 1,
+    MinifyFormat minify_format = MinifyFormat::k_none,
+    const DataMetadata &metadata = DataMetadata{});
+void OutputEscapedStringLiteralHeader(
+    const std::string &identifier_name, bool use_header_guard, ByteSpan input,
+    OutputSink &sink, unsigned number_of_jobs = 1,
+    MinifyFormat minify_format = MinifyFormat::k_none,
+    const DataMetadata &metadata = DataMetadata{});
+
+/**
+ * @returns the number of bytes between the current position and the end of
+ * the stream or -1 if the stream does not support seeking (e.g. a pipe)
+ */
+std::streamoff GetRemainingStreamSize(std::istream &input_stream);
+
+/**
+ * Streams the input out as a brace initialiser, e.g. {1, 2, 3}, reading and
+ * writing it in fixed size blocks so that memory usage stays constant.
+ * @param max_bytes the maximum number of bytes to read from the input
+ * @returns the number of elements in the initialiser
+ */
+size_t OutputBinaryInitialiser(
+    std::istream &input_stream, std::ostream &output_stream,
+    size_t max_bytes = std::numeric_limits<size_t>::max());
+size_t OutputBinaryInitialiser(ByteSpan input, std::ostream &output_stream);
 
 struct InitialiserAndNumberOfElements {
   std::string initialiser;
@@ -23,7 +99,286 @@ struct InitialiserAndNumberOfElements {
  */
 InitialiserAndNumberOfElements GetBinaryInitialiser(std::istream &input_stream);
 
+/**
+ * How OutputBinaryDataHeader lays out the array that holds the data
+ */
+struct BinaryLayout {
+  // Minimum alignment of the array in bytes (a power of two), 0 for the
+  // natural alignment of its elements
+  size_t alignment = 0;
+  // Bytes packed into each element of the array: 1, 2, 4 or 8. Wider words
+  // make for far fewer tokens in the initialiser. The last word is padded
+  // with zeros and the size of the data in bytes is available as
+  // <identifier_name>_size.
+  size_t word_size = 1;
+  // The order of the bytes in each word, which only matters when it is wider
+  // than a byte
+  bool big_endian = false;
+};
+
+/**
+ * Writes a header with the data in a std::array. The size of a stream is
+ * found by seeking where possible. Otherwise (e.g. for a pipe) a stream of
+ * more than a megabyte is embedded as it is read in a plain array followed
+ * by <identifier_name>_size, so that memory use doesn't grow with the input.
+ * @throws std::runtime_error if a stream ends before the size found by
+ * seeking
+ */
+void OutputBinaryDataHeader(const std::string &identifier_name,
+                            bool use_header_guard, std::istream &input_stream,
+                            std::ostream &output_stream);
+void OutputBinaryDataHeader(const std::string &identifier_name,
+                            bool use_header_guard, ByteSpan input,
+                            std::ostream &output_stream);
 void OutputBinaryDataHeader(const std::string &identifier_name,
                             bool use_header_guard, std::istream &input_stream,
+                            OutputSink &sink, unsigned number_of_jobs = 1,
+                            const BinaryLayout &layout = BinaryLayout{},
+                            const DataMetadata &metadata = DataMetadata{});
+void OutputBinaryDataHeader(const std::string &identifier_name,
+                            bool use_header_guard, ByteSpan input,
+                            OutputSink &sink, unsigned number_of_jobs = 1,
+                            const BinaryLayout &layout = BinaryLayout{},
+                            const DataMetadata &metadata = DataMetadata{});
+
+/**
+ * Streams the input out as one or more adjacent string literals (that the
+ * compiler concatenates) in which every byte is escaped with
+ * OutputEscapedByte.
+ * @returns the number of bytes in the string literal (excluding the null
+ * terminator)
+ */
+size_t OutputBinaryStringLiteral(std::istream &input_stream,
+                                 std::ostream &output_stream);
+size_t OutputBinaryStringLiteral(ByteSpan input, std::ostream &output_stream);
+
+/**
+ * Binary data stored in a string literal rather than a brace initialiser,
+ * which is much quicker for compilers to parse. The size of the data is
+ * available as <identifier_name>_size.
+ */
+void OutputBinaryStringLiteralHeader(const std::string &identifier_name,
+                                     bool use_header_guard,
+                                     std::istream &input_stream,
+                                     std::ostream &output_stream);
+void OutputBinaryStringLiteralHeader(const std::string &identifier_name,
+                                     bool use_header_guard, ByteSpan input,
+                                     std::ostream &output_stream);
+void OutputBinaryStringLiteralHeader(
+    const std::string &identifier_name, bool use_header_guard,
+    std::istream &input_stream, OutputSink &sink, unsigned number_of_jobs = 1,
+    const DataMetadata &metadata = DataMetadata{});
+void OutputBinaryStringLiteralHeader(
+    const std::string &identifier_name, bool use_header_guard, ByteSpan input,
+    OutputSink &sink, unsigned number_of_jobs = 1,
+    const DataMetadata &metadata = DataMetadata{});
+
+/**
+ * Compresses the input with CompressLz4Block and embeds it along with a small
+ * decompressor, which makes for smaller binaries and headers that are quicker
+ * to compile when the data compresses well. The data is accessible through
+ * <identifier_name>(), which decompresses it the first time it is called,
+ * or can be decompressed into a buffer of <identifier_name>_size bytes with
+ * <identifier_name>_decompress(buffer).
+ * @param text whether <identifier_name>() gives a const char * (for text)
+ * or a const unsigned char * (for binary data)
+ */
+void OutputCompressedDataHeader(const std::string &identifier_name,
+                                bool use_header_guard, bool text,
+                                std::istream &input_stream,
+                                std::ostream &output_stream);
+void OutputCompressedDataHeader(const std::string &identifier_name,
+                                bool use_header_guard, bool text,
+                                ByteSpan input, std::ostream &output_stream);
+void OutputCompressedDataHeader(const std::string &identifier_name,
+                                bool use_header_guard, bool text,
+                                std::istream &input_stream, OutputSink &sink);
+void OutputCompressedDataHeader(const std::string &identifier_name,
+                                bool use_header_guard, bool text,
+                                ByteSpan input, OutputSink &sink);
+
+/**
+ * Embeds the input, accessed through <identifier_name>() and
+ * <identifier_name>_size(), except that when CPP11_EMBED_RUNTIME_LOAD is
+ * defined the data isn't compiled in at all. The file at input_path is then
+ * mapped into memory (or read) the first time either of them is called,
+ * which makes the header next to free to compile and picks up any changes
+ * to the file without rebuilding, e.g. for debug builds. The size is a
+ * function as it is that of the file when it was loaded. Code built either
+ * way can be linked together. The program is stopped if the file can't be
+ * read.
+ * @param input_path where the input is loaded from at runtime, which should
+ * be absolute
+ * @param text whether <identifier_name>() gives a const char * (for text)
+ * or a const unsigned char * (for binary data)
+ */
+void OutputRuntimeLoadHeader(const std::string &identifier_name,
+                             bool use_header_guard, bool text,
+                             const std::string &input_path,
+                             std::istream &input_stream,
+                             std::ostream &output_stream);
+void OutputRuntimeLoadHeader(const std::string &identifier_name,
+                             bool use_header_guard, bool text,
+                             const std::string &input_path, ByteSpan input,
+                             std::ostream &output_stream);
+void OutputRuntimeLoadHeader(const std::string &identifier_name,
+                             bool use_header_guard, bool text,
+                             const std::string &input_path,
+                             std::istream &input_stream, OutputSink &sink,
+                             unsigned number_of_jobs = 1);
+void OutputRuntimeLoadHeader(const std::string &identifier_name,
+                             bool use_header_guard, bool text,
+                             const std::string &input_path, ByteSpan input,
+                             OutputSink &sink, unsigned number_of_jobs = 1);
+
+/**
+ * A file to embed with OutputDirectoryHeader
+ */
+struct DirectoryEntry {
+  // Relative to the directory and separated by /
+  std::string path;
+  ByteSpan contents;
+};
+
+/**
+ * Embeds every file in one contiguous blob, each aligned to alignment bytes,
+ * along with a minimal perfect hash over their paths (see BuildPerfectHash).
+ * Everything goes in namespace <identifier_name>, where find(path) looks up
+ * a file in constant time and returns a pointer to its Entry (path, data and
+ * size) or nullptr if there isn't one, and entries lists every file. Files
+ * with the same contents are only stored once, and deduplicated_bytes says
+ * how much space that saved.
+ * @param entries must not be empty and the paths must be unique
+ * @param alignment must be a power of two
+ * @returns false if no perfect hash could be found
+ */
+bool OutputDirectoryHeader(const std::string &identifier_name,
+                           bool use_header_guard,
+                           const std::vector<DirectoryEntry> &entries,
+                           size_t alignment, std::ostream &output_stream);
+bool OutputDirectoryHeader(const std::string &identifier_name,
+                           bool use_header_guard,
+                           const std::vector<DirectoryEntry> &entries,
+                           size_t alignment, OutputSink &sink);
+
+/**
+ * The kind of header whose data is referred to by OutputAliasHeader
+ */
+enum class AliasedHeader {
+  // OutputEscapedStringLiteralHeader or OutputBinaryDataHeader
+  k_data,
+  // OutputBinaryStringLiteralHeader, or OutputBinaryDataHeader with words
+  // wider than a byte (anything with <identifier_name>_size)
+  k_binary_string_literal,
+  k_compressed
+};
+
+/**
+ * A header that refers to data already embedded as
+ * <canonical_identifier_name> by another header rather than embedding
+ * another copy of it. Everything that the other header defines is available
+ * under <identifier_name> as well.
+ * @param include_path how to #include the other header (relative to this
+ * one or absolute)
+ * @param metadata whether the other header has DataMetadata
+ */
+void OutputAliasHeader(const std::string &identifier_name,
+                       bool use_header_guard,
+                       const std::string &canonical_identifier_name,
+                       const std::string &include_path,
+                       AliasedHeader aliased_header,
+                       std::ostream &output_stream, bool metadata = false);
+void OutputAliasHeader(const std::string &identifier_name,
+                       bool use_header_guard,
+                       const std::string &canonical_identifier_name,
+                       const std::string &include_path,
+                       AliasedHeader aliased_header, OutputSink &sink,
+                       bool metadata = false);
+
+/**
+ * How data defined by OutputDefinitionSource is stored
+ */
+enum class DefinitionType {
+  // A null terminated char array, as with OutputEscapedStringLiteralHeader
+  k_text,
+  // A std::array<uint8_t, N>, as with OutputBinaryDataHeader
+  k_binary_array,
+  // As with OutputBinaryStringLiteralHeader
+  k_binary_string_literal
+};
+
+/**
+ * Declares data that is defined in separate source files by
+ * OutputDefinitionSource, so including the header is cheap however large
+ * the data is. <identifier_name>_size is the number of bytes in the data.
+ * With more than one shard the data is split (in order) across the arrays
+ * in <identifier_name>_shards, each holding <identifier_name>_shard_size
+ * bytes apart from the last, so that the sources can be compiled in
+ * parallel. Shards are null terminated char arrays for text and unsigned
+ * char arrays otherwise.
+ * @param size the number of bytes in the data
+ * @param number_of_shards must be at least 1
+ */
+void OutputDeclarationHeader(const std::string &identifier_name,
+                             bool use_header_guard, DefinitionType type,
+                             size_t size, size_t number_of_shards,
+                             std::ostream &output_stream);
+void OutputDeclarationHeader(const std::string &identifier_name,
+                             bool use_header_guard, DefinitionType type,
+                             size_t size, size_t number_of_shards,
+                             OutputSink &sink);
+
+/**
+ * A source file that defines one shard of the data declared by
+ * OutputDeclarationHeader
+ * @param header_include_path how to #include the header (relative to the
+ * source file or absolute)
+ * @param input all of the data, not just this shard
+ * @param shard which shard to define, from 0 to number_of_shards - 1
+ */
+void OutputDefinitionSource(const std::string &identifier_name,
+                            DefinitionType type,
+                            const std::string &header_include_path,
+                            ByteSpan input, size_t shard,
+                            size_t number_of_shards,
                             std::ostream &output_stream);
-}  // namespace cpp11embed
\ No newline at end of file
+void OutputDefinitionSource(const std::string &identifier_name,
+                            DefinitionType type,
+                            const std::string &header_include_path,
+                            ByteSpan input, size_t shard,
+                            size_t number_of_shards, OutputSink &sink);
+
+/**
+ * Declares (but does not define) binary data that is stored elsewhere, e.g.
+ * by OutputIncbinAssembly. The data is accessible through <identifier_name>
+ * and its size through <identifier_name>_size, both with C linkage.
+ * @param size the number of bytes in the data
+ */
+void OutputExternBinaryDataHeader(const std::string &identifier_name,
+                                  bool use_header_guard, size_t size,
+                                  std::ostream &output_stream);
+void OutputExternBinaryDataHeader(const std::string &identifier_name,
+                                  bool use_header_guard, size_t size,
+                                  OutputSink &sink);
+
+/**
+ * Assembly (for the GNU assembler, to be run through the C preprocessor)
+ * that uses .incbin to define the data declared by
+ * OutputExternBinaryDataHeader. The assembler copies the file in directly so
+ * this is much cheaper to build than a header containing the data.
+ * @param input_file_path the file to embed. The path should be absolute as it
+ * is resolved relative to wherever the assembler is run.
+ * @param alignment the alignment of the data, must be a power of two
+ */
+void OutputIncbinAssembly(const std::string &identifier_name,
+                          const std::string &input_file_path,
+                          std::ostream &output_stream, size_t alignment = 16);
+
+/**
+ * A Make style depfile (also understood by Ninja) stating that target
+ * depends on the prerequisites, so that build systems can track them.
+ */
+void OutputMakeDepfile(const std::string &target,
+                       const std::vector<std::string> &prerequisites,
+                       std::ostream &output_stream);
+}  // namespace cpp11embed
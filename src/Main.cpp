@@ -1,74 +1,918 @@
 // Standard library
+#include <algorithm>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <iterator>
 #include <memory>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Platform (realpath/_fullpath and PATH_MAX/_MAX_PATH)
+#include <limits.h>
+#include <stdlib.h>
 
 // 3rd party
 #include <args.hxx>
 
 // Project
+#include "Directory.h"
+#include "ElfObject.h"
+#include "Hash.h"
 #include "Lib.h"
+#include "Manifest.h"
+#include "MappedFile.h"
+#include "OutputSink.h"
+#include "Parallel.h"
+#include "Stats.h"
+#include "Watch.h"
 
 namespace {
-bool OutputHeader(args::Positional<std::string> &input_file,
-                  args::Positional<std::string> &identifier_name,
-                  args::ValueFlag<std::string> &output_filename,
-                  args::Flag &binary_mode, args::Flag &use_header_guard) {
-  const std::string &input_filename = args::get(input_file);
+struct Options {
+  std::string input_filename;
+  std::string identifier_name;
+  // Empty for standard output
+  std::string output_filename;
+  bool binary_mode = false;
+  bool binary_string_literal = false;
+  // Embed the data compressed along with a decompressor
+  bool compress = false;
+  // Embed the data so that it can be loaded from the input file at runtime
+  // instead (see cpp11embed::OutputRuntimeLoadHeader)
+  bool runtime_load = false;
+  // The input is a directory and every file in it should be embedded
+  bool directory = false;
+  bool use_header_guard = false;
+  // Empty unless the data should be embedded with .incbin
+  std::string incbin_filename;
+  // Empty unless the data should be written to an ELF object
+  std::string elf_object_filename;
+  cpp11embed::ElfMachine elf_machine = cpp11embed::GetHostElfMachine();
+  // Empty unless the data should be defined in C++ source files (see
+  // GetDefinitionFilename) with the output only declaring it
+  std::string definition_filename;
+  size_t number_of_shards = 1;
+  // 0 for the default (see GetAlignment)
+  size_t alignment = 0;
+  // How data embedded with -b is packed (see cpp11embed::BinaryLayout)
+  size_t word_size = 1;
+  bool big_endian = false;
+  // Strip comments and insignificant whitespace from text before embedding it
+  cpp11embed::MinifyFormat minify_format = cpp11embed::MinifyFormat::k_none;
+  // Write the size, hashes and content type after the data (see
+  // cpp11embed::DataMetadata). An empty content type is guessed from the
+  // input filename.
+  bool metadata = false;
+  std::string content_type;
+  // Empty unless generating everything listed in a manifest
+  std::string manifest_filename;
+  // The number of threads to generate manifest entries or format a large
+  // input with, 0 to use as many as there are cores
+  unsigned jobs = 0;
+  // Skip generating the outputs if a hash of the input and options matches
+  // the one saved when they were last generated
+  bool incremental = false;
+  // Empty unless a depfile should be written
+  std::string depfile_filename;
+  // Manifest entries with the same input as an earlier one refer to its data
+  // rather than embedding another copy
+  bool deduplicate = false;
+  // Empty unless this refers to the data embedded by another header (written
+  // to canonical_output_filename) rather than embedding the input itself
+  std::string canonical_identifier_name;
+  std::string canonical_output_filename;
+  // Report what it took to generate the outputs on standard error and/or as
+  // JSON written to stats_json_filename (unless that is empty)
+  bool stats = false;
+  std::string stats_json_filename;
+  // Keep regenerating the outputs whenever the inputs change, writing each
+  // output to a temporary file first (see GetWritePath)
+  bool watch = false;
+};
+
+constexpr int k_standard_output_file_descriptor = 1;
+
+/**
+ * @returns the alignment of data embedded with --incbin, --elf-object or
+ * --directory
+ */
+size_t GetAlignment(const Options &options) {
+  return (options.alignment == 0) ? 16 : options.alignment;
+}
+
+// Change this whenever the outputs for the same input and options change so
+// that outputs generated by an older version aren't considered up to date
+constexpr char k_incremental_format_version[] = "1";
+
+enum class ParseResult { k_success, k_help, k_failure };
+
+/**
+ * @returns the absolute path or an empty string if it could not be resolved
+ */
+std::string GetAbsolutePath(const std::string &path) {
+#ifdef _WIN32
+  char absolute_path[_MAX_PATH];
+  return (_fullpath(absolute_path, path.c_str(), _MAX_PATH) != nullptr)
+             ? absolute_path
+             : "";
+#else
+  char absolute_path[PATH_MAX];
+  return (realpath(path.c_str(), absolute_path) != nullptr) ? absolute_path
+                                                            : "";
+#endif
+}
+
+/**
+ * Splits a path at every / (and \\ on Windows)
+ */
+std::vector<std::string> SplitPath(const std::string &path) {
+#ifdef _WIN32
+  const char *const separators = "/\\";
+#else
+  const char *const separators = "/";
+#endif
+  std::vector<std::string> components;
+  size_t start = 0;
+  for (;;) {
+    const size_t end = path.find_first_of(separators, start);
+    components.push_back(path.substr(start, end - start));
+    if (end == std::string::npos) {
+      return components;
+    }
+    start = end + 1;
+  }
+}
+
+/**
+ * @returns the path to #include the header at to_path with from the header
+ * at from_path, relative if possible (so that the headers can be moved
+ * together) and otherwise absolute
+ */
+std::string GetIncludePath(const std::string &from_path,
+                           const std::string &to_path) {
+  std::vector<std::string> from_components = SplitPath(from_path);
+  std::vector<std::string> to_components = SplitPath(to_path);
+  const std::string filename = to_components.back();
+  from_components.pop_back();
+  to_components.pop_back();
+  // The headers may not have been written yet but their directories must
+  // exist
+  const auto join = [](const std::vector<std::string> &components) {
+    if (components.empty()) {
+      return std::string{"."};
+    }
+    std::string joined = components.front();
+    for (size_t i = 1; i < components.size(); i++) {
+      joined += "/" + components[i];
+    }
+    // The root directory
+    return joined.empty() ? std::string{"/"} : joined;
+  };
+  const std::string from_directory = GetAbsolutePath(join(from_components));
+  const std::string to_directory = GetAbsolutePath(join(to_components));
+  if (from_directory.empty() || to_directory.empty()) {
+    return to_path;
+  }
+  from_components = SplitPath(from_directory);
+  to_components = SplitPath(to_directory);
+  // Different drives on Windows
+  if (from_components.front() != to_components.front()) {
+    return to_directory + "/" + filename;
+  }
+  size_t common = 0;
+  while (common < from_components.size() && common < to_components.size() &&
+         from_components[common] == to_components[common]) {
+    common++;
+  }
+  std::string include_path;
+  for (size_t i = common; i < from_components.size(); i++) {
+    include_path += "../";
+  }
+  for (size_t i = common; i < to_components.size(); i++) {
+    include_path += to_components[i] + "/";
+  }
+  return include_path + filename;
+}
+
+/**
+ * @returns where the shard of the data is defined. When there is more than
+ * one shard _<shard> goes before the extension of --definition.
+ */
+std::string GetDefinitionFilename(const Options &options, const size_t shard) {
+  if (options.number_of_shards == 1) {
+    return options.definition_filename;
+  }
+  const size_t separator = options.definition_filename.find_last_of("/\\");
+  size_t extension = options.definition_filename.rfind('.');
+  if (extension == std::string::npos ||
+      (separator != std::string::npos && extension < separator)) {
+    extension = options.definition_filename.size();
+  }
+  return options.definition_filename.substr(0, extension) + "_" +
+         std::to_string(shard) + options.definition_filename.substr(extension);
+}
+
+/**
+ * @returns where an output should be written. With --watch that is a
+ * temporary file that replaces the output once it is complete (see
+ * ReplaceOutputs), so that whatever is reading the output never sees it
+ * half written.
+ */
+std::string GetWritePath(const Options &options, const std::string &filename) {
+  return options.watch ? filename + ".cpp11embed-tmp" : filename;
+}
+
+std::streamoff GetInputSize(std::istream &input_stream) {
+  return cpp11embed::GetRemainingStreamSize(input_stream);
+}
+
+std::streamoff GetInputSize(const cpp11embed::ByteSpan input) {
+  return static_cast<std::streamoff>(input.size);
+}
+
+/**
+ * Writes an assembly file that embeds the input with .incbin and a header
+ * that declares the data defined by it.
+ * @param input_size -1 if unknown
+ */
+bool OutputIncbinHeader(const Options &options,
+                        const std::streamoff input_size,
+                        cpp11embed::OutputSink &output_sink,
+                        std::ostream &error_stream) {
+  if (options.input_filename == "-") {
+    error_stream << "--incbin requires an input file, not standard input\n";
+    return false;
+  }
+  const std::string absolute_input_path =
+      GetAbsolutePath(options.input_filename);
+  if (absolute_input_path.empty() || input_size < 0) {
+    error_stream << "Unable to read input\n";
+    return false;
+  }
+
+  std::ofstream assembly_file_stream{
+      GetWritePath(options, options.incbin_filename)};
+  if (!assembly_file_stream) {
+    error_stream << "Unable to open assembly output file\n";
+    return false;
+  }
+  cpp11embed::OutputIncbinAssembly(options.identifier_name,
+                                   absolute_input_path, assembly_file_stream,
+                                   GetAlignment(options));
+  assembly_file_stream.flush();
+  if (!assembly_file_stream) {
+    error_stream << "Unable to write assembly output file\n";
+    return false;
+  }
+  cpp11embed::OutputExternBinaryDataHeader(
+      options.identifier_name, options.use_header_guard,
+      static_cast<size_t>(input_size), output_sink);
+  return true;
+}
+
+/**
+ * Writes an ELF object file that contains the data and a header that
+ * declares the data defined by it.
+ */
+bool OutputElfObjectHeader(const Options &options,
+                           const cpp11embed::ByteSpan input,
+                           cpp11embed::OutputSink &output_sink,
+                           std::ostream &error_stream) {
+  std::ofstream object_file_stream{
+      GetWritePath(options, options.elf_object_filename),
+      std::ofstream::binary};
+  if (!object_file_stream) {
+    error_stream << "Unable to open object output file\n";
+    return false;
+  }
+  cpp11embed::OutputElfObject(options.identifier_name, options.elf_machine,
+                              GetAlignment(options), input,
+                              object_file_stream);
+  object_file_stream.flush();
+  if (!object_file_stream) {
+    error_stream << "Unable to write object output file\n";
+    return false;
+  }
+  cpp11embed::OutputExternBinaryDataHeader(
+      options.identifier_name, options.use_header_guard, input.size,
+      output_sink);
+  return true;
+}
+
+bool OutputElfObjectHeader(const Options &options, std::istream &input_stream,
+                           cpp11embed::OutputSink &output_sink,
+                           std::ostream &error_stream) {
+  const std::streamoff input_size =
+      cpp11embed::GetRemainingStreamSize(input_stream);
+  if (input_size < 0) {
+    // The size has to be known before any of the data is written out so
+    // buffer up inputs that can't tell us (e.g. pipes)
+    const std::string input{std::istreambuf_iterator<char>(input_stream),
+                            std::istreambuf_iterator<char>()};
+    return OutputElfObjectHeader(
+        options, cpp11embed::ByteSpan{input.data(), input.size()},
+        output_sink, error_stream);
+  }
+
+  std::ofstream object_file_stream{
+      GetWritePath(options, options.elf_object_filename),
+      std::ofstream::binary};
+  if (!object_file_stream) {
+    error_stream << "Unable to open object output file\n";
+    return false;
+  }
+  if (!cpp11embed::OutputElfObject(
+          options.identifier_name, options.elf_machine, GetAlignment(options),
+          input_stream, static_cast<size_t>(input_size),
+          object_file_stream)) {
+    error_stream << "Unable to read input\n";
+    return false;
+  }
+  object_file_stream.flush();
+  if (!object_file_stream) {
+    error_stream << "Unable to write object output file\n";
+    return false;
+  }
+  cpp11embed::OutputExternBinaryDataHeader(
+      options.identifier_name, options.use_header_guard,
+      static_cast<size_t>(input_size), output_sink);
+  return true;
+}
+
+/**
+ * Writes C++ source files that define the data and a header that declares
+ * it
+ */
+bool OutputDefinitionHeader(const Options &options,
+                            const cpp11embed::ByteSpan input,
+                            cpp11embed::OutputSink &output_sink,
+                            std::ostream &error_stream) {
+  const cpp11embed::DefinitionType type =
+      options.binary_string_literal
+          ? cpp11embed::DefinitionType::k_binary_string_literal
+          : options.binary_mode ? cpp11embed::DefinitionType::k_binary_array
+                                : cpp11embed::DefinitionType::k_text;
+  for (size_t shard = 0; shard < options.number_of_shards; shard++) {
+    const std::string definition_filename =
+        GetDefinitionFilename(options, shard);
+    std::ofstream definition_file_stream{
+        GetWritePath(options, definition_filename), std::ofstream::binary};
+    cpp11embed::OutputDefinitionSource(
+        options.identifier_name, type,
+        GetIncludePath(definition_filename, options.output_filename), input,
+        shard, options.number_of_shards, definition_file_stream);
+    if (!definition_file_stream) {
+      error_stream << "Unable to write definition file "
+                   << definition_filename << "\n";
+      return false;
+    }
+  }
+  cpp11embed::OutputDeclarationHeader(
+      options.identifier_name, options.use_header_guard, type, input.size,
+      options.number_of_shards, output_sink);
+  return true;
+}
+
+bool OutputDefinitionHeader(const Options &options, std::istream &input_stream,
+                            cpp11embed::OutputSink &output_sink,
+                            std::ostream &error_stream) {
+  // The size of every shard has to be known up front
+  const std::string input{std::istreambuf_iterator<char>(input_stream),
+                          std::istreambuf_iterator<char>()};
+  const cpp11embed::ByteSpan input_span{input.data(), input.size()};
+  return OutputDefinitionHeader(options, input_span, output_sink,
+                                error_stream);
+}
+
+/**
+ * Embeds every file in the input directory, with an index to look them up
+ * by path
+ */
+bool OutputDirectoryHeader(const Options &options,
+                           cpp11embed::OutputSink &output_sink,
+                           std::ostream &error_stream,
+                           uint64_t &input_bytes) {
+  std::vector<std::string> relative_paths;
+  if (!cpp11embed::ListFilesInDirectory(options.input_filename,
+                                        relative_paths)) {
+    error_stream << "Unable to read input directory\n";
+    return false;
+  }
+  if (relative_paths.empty()) {
+    error_stream << "No files found in the input directory\n";
+    return false;
+  }
+
+  std::vector<std::unique_ptr<cpp11embed::MappedFile>> mapped_files;
+  std::vector<cpp11embed::DirectoryEntry> entries;
+  for (const std::string &relative_path : relative_paths) {
+    mapped_files.push_back(std::make_unique<cpp11embed::MappedFile>(
+        options.input_filename + "/" + relative_path));
+    if (!mapped_files.back()->IsMapped()) {
+      error_stream << "Unable to read " << relative_path << "\n";
+      return false;
+    }
+    entries.push_back({relative_path, mapped_files.back()->GetBytes()});
+    input_bytes += entries.back().contents.size;
+  }
+  if (!cpp11embed::OutputDirectoryHeader(options.identifier_name,
+                                         options.use_header_guard, entries,
+                                         GetAlignment(options), output_sink)) {
+    error_stream << "Unable to find a perfect hash for the paths\n";
+    return false;
+  }
+  return true;
+}
+
+cpp11embed::DataMetadata GetDataMetadata(const Options &options) {
+  cpp11embed::DataMetadata metadata;
+  metadata.enabled = options.metadata;
+  if (options.metadata) {
+    metadata.content_type =
+        !options.content_type.empty()
+            ? options.content_type
+            : cpp11embed::GuessContentType(
+                  (options.input_filename == "-") ? "" : options.input_filename,
+                  !options.binary_mode && !options.binary_string_literal);
+  }
+  return metadata;
+}
+
+/**
+ * @param input either a stream or a cpp11embed::ByteSpan
+ */
+template <typename Input>
+bool GenerateOutputsFrom(const Options &options, Input &input,
+                         cpp11embed::OutputSink &output_sink,
+                         std::ostream &error_stream) {
+  if (!options.elf_object_filename.empty()) {
+    return OutputElfObjectHeader(options, input, output_sink, error_stream);
+  } else if (!options.incbin_filename.empty()) {
+    return OutputIncbinHeader(options, GetInputSize(input), output_sink,
+                              error_stream);
+  } else if (!options.definition_filename.empty()) {
+    return OutputDefinitionHeader(options, input, output_sink, error_stream);
+  } else if (options.compress) {
+    cpp11embed::OutputCompressedDataHeader(
+        options.identifier_name, options.use_header_guard,
+        !options.binary_mode && !options.binary_string_literal, input,
+        output_sink);
+  } else if (options.runtime_load) {
+    const std::string absolute_input_path =
+        GetAbsolutePath(options.input_filename);
+    if (absolute_input_path.empty()) {
+      error_stream << "Unable to read input\n";
+      return false;
+    }
+    cpp11embed::OutputRuntimeLoadHeader(
+        options.identifier_name, options.use_header_guard,
+        !options.binary_mode && !options.binary_string_literal,
+        absolute_input_path, input, output_sink, options.jobs);
+  } else if (options.binary_string_literal) {
+    cpp11embed::OutputBinaryStringLiteralHeader(
+        options.identifier_name, options.use_header_guard, input, output_sink,
+        options.jobs, GetDataMetadata(options));
+  } else if (options.binary_mode) {
+    cpp11embed::BinaryLayout layout;
+    layout.alignment = options.alignment;
+    layout.word_size = options.word_size;
+    layout.big_endian = options.big_endian;
+    try {
+      cpp11embed::OutputBinaryDataHeader(
+          options.identifier_name, options.use_header_guard, input,
+          output_sink, options.jobs, layout, GetDataMetadata(options));
+    } catch (const std::runtime_error &e) {
+      error_stream << e.what() << "\n";
+      return false;
+    }
+  } else {
+    cpp11embed::OutputEscapedStringLiteralHeader(
+        options.identifier_name, options.use_header_guard, input, output_sink,
+        options.jobs, options.minify_format, GetDataMetadata(options));
+  }
+  return true;
+}
+
+cpp11embed::AliasedHeader GetAliasedHeader(const Options &options) {
+  if (options.compress) {
+    return cpp11embed::AliasedHeader::k_compressed;
+  }
+  // Words wider than a byte come with the size of the data too
+  return (options.binary_string_literal || options.word_size != 1)
+             ? cpp11embed::AliasedHeader::k_binary_string_literal
+             : cpp11embed::AliasedHeader::k_data;
+}
+
+/**
+ * @returns the outputs other than the header
+ */
+std::vector<std::string> GetOtherOutputFilenames(const Options &options) {
+  std::vector<std::string> filenames;
+  for (const std::string &filename :
+       {options.incbin_filename, options.elf_object_filename}) {
+    if (!filename.empty()) {
+      filenames.push_back(filename);
+    }
+  }
+  if (!options.definition_filename.empty()) {
+    for (size_t shard = 0; shard < options.number_of_shards; shard++) {
+      filenames.push_back(GetDefinitionFilename(options, shard));
+    }
+  }
+  return filenames;
+}
+
+/**
+ * With --watch, moves the outputs that were written to temporary files into
+ * place if they were all written successfully and otherwise removes them.
+ * The header is moved last as it refers to the other outputs.
+ * @returns false if they couldn't be moved
+ */
+bool ReplaceOutputs(const Options &options, const bool succeeded) {
+  if (!options.watch) {
+    return true;
+  }
+  std::vector<std::string> filenames = GetOtherOutputFilenames(options);
+  filenames.push_back(options.output_filename);
+  bool replaced = true;
+  for (const std::string &filename : filenames) {
+    const std::string write_path = GetWritePath(options, filename);
+    if (!succeeded) {
+      std::remove(write_path.c_str());
+    } else if (std::rename(write_path.c_str(), filename.c_str()) != 0) {
+      replaced = false;
+    }
+  }
+  return replaced;
+}
+
+/**
+ * @returns how the data is embedded, for GenerationStats
+ */
+std::string GetModeName(const Options &options) {
+  if (options.directory) {
+    return "directory";
+  } else if (!options.canonical_identifier_name.empty()) {
+    return "deduplicated";
+  } else if (!options.incbin_filename.empty()) {
+    return "incbin";
+  } else if (!options.elf_object_filename.empty()) {
+    return "elf-object";
+  } else if (options.compress) {
+    return (options.binary_mode || options.binary_string_literal)
+               ? "compressed-binary"
+               : "compressed-text";
+  } else if (options.runtime_load) {
+    return (options.binary_mode || options.binary_string_literal)
+               ? "runtime-load-binary"
+               : "runtime-load-text";
+  }
+  const std::string mode =
+      options.binary_string_literal
+          ? "binary-string-literal"
+          : options.binary_mode
+                ? "binary"
+                : (options.minify_format == cpp11embed::MinifyFormat::k_none)
+                      ? "text"
+                      : "minified-text";
+  return options.definition_filename.empty() ? mode : mode + "-definition";
+}
+
+/**
+ * @param stats if not null, filled in with what it took to generate the
+ * outputs
+ */
+bool GenerateOutputs(const Options &options, std::ostream &error_stream,
+                     cpp11embed::GenerationStats *const stats = nullptr) {
+  const cpp11embed::Stopwatch stopwatch;
+  // Map files into memory where possible so that they can be formatted
+  // without copying them through a stream. Anything else (standard input,
+  // pipes etc.) is streamed.
+  const bool open_input_file = options.input_filename != "-" &&
+                               !options.directory &&
+                               options.canonical_identifier_name.empty();
+  const std::unique_ptr<cpp11embed::MappedFile> mapped_file =
+      !open_input_file
+          ? nullptr
+          : std::make_unique<cpp11embed::MappedFile>(options.input_filename);
+  const bool input_is_mapped =
+      mapped_file != nullptr && mapped_file->IsMapped();
+
   // Use std::optional? Would require C++17?
   // Read in binary mode so that we embed the file contents
   // exactly as they are
   const std::unique_ptr<std::ifstream> in_file_stream =
-      (input_filename == "-") ? nullptr
-                              : std::make_unique<std::ifstream>(
-                                    input_filename, std::ifstream::binary);
-  if (in_file_stream != nullptr && !in_file_stream) {
-    std::cerr << "Unable to read input\n";
+      (!open_input_file || input_is_mapped)
+          ? nullptr
+          : std::make_unique<std::ifstream>(options.input_filename,
+                                            std::ifstream::binary);
+  if (in_file_stream != nullptr && !*in_file_stream) {
+    error_stream << "Unable to read input\n";
     return false;
   }
+  double read_seconds = stopwatch.GetSeconds();
 
   const std::unique_ptr<std::ofstream> out_file_stream =
-      (output_filename)
-          ? std::make_unique<std::ofstream>(args::get(output_filename))
+      (!options.output_filename.empty())
+          ? std::make_unique<std::ofstream>(
+                GetWritePath(options, options.output_filename))
           : nullptr;
-  if (out_file_stream != nullptr && !out_file_stream) {
-    std::cerr << "Unable to open output file\n";
+  if (out_file_stream != nullptr && !*out_file_stream) {
+    error_stream << "Unable to open output file\n";
     return false;
   }
+  // Write to standard output directly rather than through std::cout as all
+  // of the output is buffered anyway
+  cpp11embed::FileDescriptorSink standard_output_sink{
+      k_standard_output_file_descriptor};
+  const std::unique_ptr<cpp11embed::OstreamSink> out_file_sink =
+      (out_file_stream == nullptr)
+          ? nullptr
+          : std::make_unique<cpp11embed::OstreamSink>(*out_file_stream);
+  cpp11embed::TimedOutputSink output_sink{
+      (out_file_sink == nullptr)
+          ? static_cast<cpp11embed::OutputSink &>(standard_output_sink)
+          : *out_file_sink};
+
+  bool succeeded;
+  uint64_t input_bytes = 0;
+  if (options.directory) {
+    succeeded =
+        OutputDirectoryHeader(options, output_sink, error_stream, input_bytes);
+  } else if (!options.canonical_identifier_name.empty()) {
+    cpp11embed::OutputAliasHeader(
+        options.identifier_name, options.use_header_guard,
+        options.canonical_identifier_name,
+        GetIncludePath(options.output_filename,
+                       options.canonical_output_filename),
+        GetAliasedHeader(options), output_sink, options.metadata);
+    succeeded = true;
+  } else if (input_is_mapped) {
+    const cpp11embed::ByteSpan input = mapped_file->GetBytes();
+    input_bytes = input.size;
+    succeeded = GenerateOutputsFrom(options, input, output_sink, error_stream);
+  } else if (stats == nullptr) {
+    std::istream &input_stream =
+        (in_file_stream == nullptr) ? std::cin : *in_file_stream;
+    succeeded =
+        GenerateOutputsFrom(options, input_stream, output_sink, error_stream);
+  } else {
+    // Only done when asked for as it costs an extra copy of the input
+    cpp11embed::TimedStreambuf input_streambuf{
+        (in_file_stream == nullptr) ? *std::cin.rdbuf()
+                                    : *in_file_stream->rdbuf()};
+    std::istream input_stream{&input_streambuf};
+    succeeded =
+        GenerateOutputsFrom(options, input_stream, output_sink, error_stream);
+    input_bytes = input_streambuf.GetBytesRead();
+    read_seconds += input_streambuf.GetSeconds();
+  }
+  double write_seconds = output_sink.GetSeconds();
+  if (out_file_stream != nullptr) {
+    const cpp11embed::Stopwatch flush_stopwatch;
+    out_file_stream->flush();
+    write_seconds += flush_stopwatch.GetSeconds();
+  }
+  if (succeeded && output_sink.HasFailed()) {
+    error_stream << "Unable to write output\n";
+    succeeded = false;
+  }
+  if (!ReplaceOutputs(options, succeeded) && succeeded) {
+    error_stream << "Unable to replace output\n";
+    succeeded = false;
+  }
+  if (succeeded && stats != nullptr) {
+    stats->output_filename = options.output_filename;
+    stats->identifier_name = options.identifier_name;
+    stats->mode = GetModeName(options);
+    stats->input_bytes = input_bytes;
+    stats->output_bytes = output_sink.GetBytesWritten();
+    for (const std::string &filename : GetOtherOutputFilenames(options)) {
+      std::ifstream output_file_stream{filename, std::ifstream::binary};
+      const std::streamoff size =
+          cpp11embed::GetRemainingStreamSize(output_file_stream);
+      stats->output_bytes += static_cast<uint64_t>(std::max<std::streamoff>(
+          size, 0));
+    }
+    stats->read_seconds = read_seconds;
+    stats->write_seconds = write_seconds;
+    stats->format_seconds =
+        std::max(stopwatch.GetSeconds() - read_seconds - write_seconds, 0.0);
+    stats->peak_rss_bytes = cpp11embed::GetPeakRss();
+  }
+  return succeeded;
+}
+
+bool WantsStats(const Options &options) {
+  return options.stats || !options.stats_json_filename.empty();
+}
+
+/**
+ * Writes the stats to wherever options asks for them
+ */
+bool ReportStats(const Options &options,
+                 const std::vector<cpp11embed::GenerationStats> &stats,
+                 std::ostream &error_stream) {
+  if (options.stats) {
+    for (const cpp11embed::GenerationStats &header_stats : stats) {
+      cpp11embed::OutputStats(header_stats, std::cerr);
+    }
+  }
+  if (!options.stats_json_filename.empty()) {
+    std::ofstream stats_json_stream{options.stats_json_filename};
+    cpp11embed::OutputStatsJson(stats, stats_json_stream);
+    if (!stats_json_stream) {
+      error_stream << "Unable to write stats file\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+std::string GetHashFilename(const Options &options) {
+  return options.output_filename + ".cpp11embed-hash";
+}
+
+/**
+ * Adds the contents of a file to the hash
+ * @returns false if the file couldn't be read
+ */
+bool UpdateHashFromFile(cpp11embed::Xxh64 &xxh64, const std::string &path) {
+  const cpp11embed::MappedFile mapped_file{path};
+  if (mapped_file.IsMapped()) {
+    const cpp11embed::ByteSpan input = mapped_file.GetBytes();
+    xxh64.Update(input.data, input.size);
+    return true;
+  }
+  std::ifstream input_stream{path, std::ifstream::binary};
+  return input_stream && cpp11embed::UpdateFromStream(xxh64, input_stream);
+}
 
-  std::istream &input_stream =
-      (in_file_stream == nullptr) ? std::cin : *in_file_stream;
-  std::ostream &output_stream =
-      (out_file_stream == nullptr) ? std::cout : *out_file_stream;
+/**
+ * Hashes the input along with every option that affects the outputs
+ * @returns false if the input couldn't be read
+ */
+bool GetOutputsHash(const Options &options, std::string &hash) {
+  std::ostringstream fingerprint;
+  fingerprint << k_incremental_format_version << '\0'
+              << GetAbsolutePath(options.input_filename) << '\0'
+              << options.identifier_name << '\0' << options.output_filename
+              << '\0' << options.binary_mode << options.binary_string_literal
+              << options.compress << options.runtime_load << options.directory
+              << options.use_header_guard << '\0' << options.incbin_filename
+              << '\0' << options.elf_object_filename << '\0'
+              << static_cast<int>(options.elf_machine) << '\0'
+              << options.alignment << '\0' << options.word_size
+              << options.big_endian << '\0'
+              << static_cast<int>(options.minify_format) << '\0'
+              << options.metadata << options.content_type << '\0'
+              << options.definition_filename
+              << '\0' << options.number_of_shards << '\0'
+              << options.canonical_identifier_name << '\0'
+              << options.canonical_output_filename;
+  const std::string fingerprint_string = fingerprint.str();
+  cpp11embed::Xxh64 xxh64;
+  xxh64.Update(fingerprint_string.data(), fingerprint_string.size());
 
-  if (binary_mode) {
-    cpp11embed::OutputBinaryDataHeader(args::get(identifier_name),
-                                       args::get(use_header_guard),
-                                       input_stream, output_stream);
+  if (!options.directory) {
+    if (!UpdateHashFromFile(xxh64, options.input_filename)) {
+      return false;
+    }
   } else {
-    cpp11embed::OutputEscapedStringLiteralHeader(args::get(identifier_name),
-                                                 args::get(use_header_guard),
-                                                 input_stream, output_stream);
+    // Files being added, removed or renamed changes the output too
+    std::vector<std::string> relative_paths;
+    if (!cpp11embed::ListFilesInDirectory(options.input_filename,
+                                          relative_paths)) {
+      return false;
+    }
+    for (const std::string &relative_path : relative_paths) {
+      xxh64.Update(relative_path.c_str(), relative_path.size() + 1);
+      if (!UpdateHashFromFile(xxh64,
+                              options.input_filename + "/" + relative_path)) {
+        return false;
+      }
+    }
   }
+  std::ostringstream hash_stream;
+  hash_stream << std::hex << std::setw(16) << std::setfill('0')
+              << xxh64.Digest();
+  hash = hash_stream.str();
   return true;
 }
-}  // namespace
 
-int main(const int argc, char *argv[]) {
+/**
+ * @returns true if the outputs exist and were generated from an input and
+ * options with the given hash
+ */
+bool AreOutputsUpToDate(const Options &options, const std::string &hash) {
+  std::ifstream hash_stream{GetHashFilename(options)};
+  std::string previous_hash;
+  if (!(hash_stream >> previous_hash) || previous_hash != hash) {
+    return false;
+  }
+  // The outputs may have been deleted since they were generated
+  std::vector<std::string> filenames = GetOtherOutputFilenames(options);
+  filenames.push_back(options.output_filename);
+  for (const std::string &filename : filenames) {
+    if (!std::ifstream{filename}) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Generates the output(s) for a single input. Safe to call from several
+ * threads at once provided that they are all writing to files.
+ * @param stats if not null, what it took to generate the outputs is
+ * appended to this (unless they were already up to date)
+ */
+bool OutputHeader(const Options &options, std::ostream &error_stream,
+                  std::vector<cpp11embed::GenerationStats> *const stats =
+                      nullptr) {
+  const auto generate_outputs = [&]() {
+    cpp11embed::GenerationStats header_stats;
+    if (!GenerateOutputs(options, error_stream,
+                         (stats == nullptr) ? nullptr : &header_stats)) {
+      return false;
+    }
+    if (stats != nullptr) {
+      stats->push_back(header_stats);
+    }
+    return true;
+  };
+  if (!options.depfile_filename.empty()) {
+    std::vector<std::string> prerequisites{options.input_filename};
+    if (options.directory) {
+      std::vector<std::string> relative_paths;
+      cpp11embed::ListFilesInDirectory(options.input_filename, relative_paths);
+      prerequisites.clear();
+      for (const std::string &relative_path : relative_paths) {
+        prerequisites.push_back(options.input_filename + "/" + relative_path);
+      }
+    }
+    std::ofstream depfile_stream{options.depfile_filename};
+    cpp11embed::OutputMakeDepfile(options.output_filename, prerequisites,
+                                  depfile_stream);
+    if (!depfile_stream) {
+      error_stream << "Unable to write depfile\n";
+      return false;
+    }
+  }
+  if (!options.incremental) {
+    return generate_outputs();
+  }
+
+  std::string hash;
+  if (!GetOutputsHash(options, hash)) {
+    error_stream << "Unable to read input\n";
+    return false;
+  }
+  // Leave the outputs untouched so that nothing that depends on them is
+  // rebuilt
+  if (AreOutputsUpToDate(options, hash)) {
+    return true;
+  }
+  // Remove the old hash first so that outputs left half written by a failure
+  // can't be mistaken for being up to date
+  std::remove(GetHashFilename(options).c_str());
+  if (!generate_outputs()) {
+    return false;
+  }
+  std::ofstream hash_stream{GetHashFilename(options)};
+  if (!(hash_stream << hash << '\n')) {
+    error_stream << "Unable to write hash file\n";
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @param arguments command line arguments (excluding the program name)
+ * @param output_stream where help is written
+ * @param error_stream where errors are written
+ */
+ParseResult ParseOptions(const std::vector<std::string> &arguments,
+                         Options &options, std::ostream &output_stream,
+                         std::ostream &error_stream) {
   args::ArgumentParser parser("CPP11 Embed", "Embed files in C++11 programs");
   args::HelpFlag help(parser, "help", "Display this help menu", {'h', "help"});
 
-  // Required arguments
+  // Required arguments (unless using a manifest)
   args::Positional<std::string> input_file(
       parser, "input_file",
       "Input file (use - to read from stdin). Note: input is read exactly and "
-      "line-endings are left unchanged",
-      args::Options::Required);
+      "line-endings are left unchanged");
   args::Positional<std::string> identifier_name(
       parser, "identifier_name",
-      "The name of constant/variable you want to store the data in",
-      args::Options::Required);
+      "The name of constant/variable you want to store the data in");
 
   // Optional flags
   args::ValueFlag<std::string> output_filename(
@@ -78,27 +922,661 @@ int main(const int argc, char *argv[]) {
   args::Flag binary_mode(parser, "binary_mode",
                          "The input is binary data and not text",
                          {'b', "binary-mode"});
+  args::Flag binary_string_literal(
+      parser, "binary_string_literal",
+      "The input is binary data and should be stored in a string literal "
+      "rather than an array initialiser (much faster to compile)",
+      {'s', "binary-string-literal"});
+  args::Flag compress(
+      parser, "compress",
+      "Embed the input compressed (LZ4) along with a decompressor. The data "
+      "is accessed through <identifier_name>(), which gives text unless -b "
+      "or -s is also given",
+      {"compress"});
+  args::Flag runtime_load(
+      parser, "runtime_load",
+      "Access the data through <identifier_name>() and "
+      "<identifier_name>_size() but, in code built with "
+      "CPP11_EMBED_RUNTIME_LOAD defined, map the input file (by its absolute "
+      "path) into memory the first time that it is accessed rather than "
+      "compiling it in, so that even huge inputs cost next to nothing to "
+      "compile and changes to the file are picked up without rebuilding "
+      "(e.g. in debug builds). Requires an input file",
+      {"runtime-load"});
+  args::Flag directory(
+      parser, "directory",
+      "input_file is a directory and every file in it (and its "
+      "subdirectories) should be embedded in one blob. Everything is put in "
+      "namespace <identifier_name>, where find(path) looks up a file by its "
+      "path relative to the directory in constant time",
+      {"directory"});
+  args::ValueFlag<std::string> incbin_filename(
+      parser, "incbin",
+      "Write a GNU assembler file that embeds the input with .incbin to this "
+      "path and make the output a header that declares the data (ELF targets "
+      "only)",
+      {"incbin"});
+  args::ValueFlag<std::string> elf_object_filename(
+      parser, "elf_object",
+      "Write an ELF object file containing the input to this path and make "
+      "the output a header that declares the data",
+      {"elf-object"});
+  args::ValueFlag<std::string> definition_filename(
+      parser, "definition",
+      "Define the data in a C++ source file at this path, which must be "
+      "compiled and linked in, and make the output a header that only "
+      "declares it (and its size as <identifier_name>_size), so that "
+      "including the header is cheap however large the data is. Requires an "
+      "output file",
+      {"definition"});
+  args::ValueFlag<size_t> number_of_shards(
+      parser, "shards",
+      "Split the data defined with --definition across this many source "
+      "files (named with _0, _1 etc. before the extension) so that they can "
+      "be compiled in parallel. The header then declares "
+      "<identifier_name>_shards, the pieces of the data in order",
+      {"shards"});
+  args::ValueFlag<std::string> elf_machine(
+      parser, "elf_machine",
+      "The machine to write ELF objects for: x86-64 or aarch64 (defaults to "
+      "the current machine)",
+      {"elf-machine"});
+  args::ValueFlag<size_t> alignment(
+      parser, "alignment",
+      "Alignment in bytes of data embedded with --incbin or --elf-object, or "
+      "of each file embedded with --directory (defaults to 16). Data "
+      "embedded with -b is given at least this alignment too (it defaults "
+      "to that of the array's elements)",
+      {"alignment"});
+  args::ValueFlag<size_t> word_size(
+      parser, "word_size",
+      "Only with -b: pack the data into an array of 1, 2, 4 or 8 byte "
+      "unsigned integers rather than bytes, padding the last with zeros. "
+      "The size of the data in bytes is then <identifier_name>_size",
+      {"word-size"});
+  args::ValueFlag<std::string> endianness(
+      parser, "endianness",
+      "The order of the bytes in words packed with --word-size: little or "
+      "big (defaults to little)",
+      {"endianness"});
+  args::ValueFlag<std::string> minify(
+      parser, "minify",
+      "Strip comments and collapse insignificant whitespace in the text as it "
+      "is embedded (in constant memory, so standard input works too). The "
+      "format of the text: json, glsl, css, html or sql",
+      {"minify"});
+  args::Flag metadata(
+      parser, "metadata",
+      "Also write the size, CRC-32C and XXH64 of the data and a content type "
+      "as constants after it (<identifier_name>_size, _crc32c, _xxh64 and "
+      "_content_type) so that it can be checked without hashing it at "
+      "runtime. Can't be used with --compress, --directory, --incbin, "
+      "--elf-object or --definition",
+      {"metadata"});
+  args::ValueFlag<std::string> content_type(
+      parser, "content_type",
+      "Only with --metadata: the content type to write (guessed from the "
+      "input file's extension by default)",
+      {"content-type"});
   args::Flag use_header_guard(parser, "use_header_guard",
                               "Use a header guard rather than #pragma once",
                               {'g', "use-header-guard"});
+  args::ValueFlag<std::string> manifest_filename(
+      parser, "manifest",
+      "Generate every header listed in this file in one go instead of a "
+      "single input (input_file and identifier_name must not be given). "
+      "Each line has tab separated fields: the input file, the identifier "
+      "name, the output file and then any other arguments, one per field. "
+      "--incremental applies to every entry",
+      {"manifest"});
+  args::Flag deduplicate(
+      parser, "deduplicate",
+      "Only with --manifest: entries whose input has the same contents as "
+      "that of an earlier entry (and that are embedded the same way) refer "
+      "to the earlier entry's data rather than embedding another copy, and "
+      "the number of bytes saved is reported",
+      {"deduplicate"});
+  args::ValueFlag<unsigned> jobs(
+      parser, "jobs",
+      "The number of threads to use, either to generate the entries of a "
+      "manifest or to format a large input in chunks (defaults to the number "
+      "of cores, at most 256). The output is the same however many are used",
+      {'j', "jobs"});
+  args::Flag incremental(
+      parser, "incremental",
+      "Only write the outputs if the input or options have changed since "
+      "they were last generated, so that their timestamps only change when "
+      "their contents do. A hash is kept in <output>.cpp11embed-hash. "
+      "Requires an input file and an output file",
+      {"incremental"});
+  args::ValueFlag<std::string> depfile_filename(
+      parser, "depfile",
+      "Also write a Make/Ninja depfile listing the input to this path. "
+      "Requires an input file and an output file",
+      {"depfile"});
+  args::Flag stats(
+      parser, "stats",
+      "Report what it took to generate each header on standard error: how "
+      "the data was embedded, the bytes read and written (including any "
+      "files generated alongside the header), how much bigger the output is "
+      "than the input, the time spent reading, formatting and writing and "
+      "the peak memory usage. Nothing is reported for outputs that "
+      "--incremental finds up to date",
+      {"stats"});
+  args::ValueFlag<std::string> stats_json_filename(
+      parser, "stats_json",
+      "Write the same as --stats to this path as a JSON array with an object "
+      "for each header",
+      {"stats-json"});
+  args::Flag watch(
+      parser, "watch",
+      "After generating the outputs, keep watching the input (or the "
+      "manifest and the inputs of its entries) and regenerate the outputs "
+      "affected by each change within milliseconds until stopped. Each "
+      "output is written to a temporary file that then replaces it, so that "
+      "it is never seen half written. Requires an input file and an output "
+      "file (or a manifest). Only available on Linux",
+      {"watch"});
 
   try {
-    parser.ParseCLI(argc, argv);
+    parser.ParseArgs(arguments);
   } catch (args::Help &) {
-    std::cout << parser;
-    return EXIT_SUCCESS;
+    output_stream << parser;
+    return ParseResult::k_help;
   } catch (args::ParseError &e) {
-    std::cerr << e.what() << std::endl;
-    std::cerr << parser;
-    return EXIT_FAILURE;
+    error_stream << e.what() << std::endl;
+    error_stream << parser;
+    return ParseResult::k_failure;
   } catch (args::ValidationError &e) {
-    std::cerr << e.what() << std::endl;
-    std::cerr << parser;
-    return EXIT_FAILURE;
+    error_stream << e.what() << std::endl;
+    error_stream << parser;
+    return ParseResult::k_failure;
   }
 
-  return OutputHeader(input_file, identifier_name, output_filename, binary_mode,
-                      use_header_guard)
-             ? EXIT_SUCCESS
-             : EXIT_FAILURE;
-}
\ No newline at end of file
+  if (manifest_filename) {
+    if (input_file || identifier_name) {
+      error_stream << "input_file and identifier_name can't be used with "
+                      "--manifest\n";
+      return ParseResult::k_failure;
+    }
+  } else if (!input_file || !identifier_name) {
+    error_stream << "Option '"
+                 << (input_file ? "identifier_name" : "input_file")
+                 << "' is required" << std::endl;
+    error_stream << parser;
+    return ParseResult::k_failure;
+  }
+
+  options.input_filename = args::get(input_file);
+  options.identifier_name = args::get(identifier_name);
+  options.output_filename = args::get(output_filename);
+  options.binary_mode = args::get(binary_mode);
+  options.binary_string_literal = args::get(binary_string_literal);
+  options.compress = args::get(compress);
+  options.runtime_load = args::get(runtime_load);
+  options.directory = args::get(directory);
+  options.use_header_guard = args::get(use_header_guard);
+  options.incbin_filename = args::get(incbin_filename);
+  options.elf_object_filename = args::get(elf_object_filename);
+  options.definition_filename = args::get(definition_filename);
+  if (number_of_shards) {
+    options.number_of_shards = args::get(number_of_shards);
+    if (options.number_of_shards == 0 || options.definition_filename.empty()) {
+      error_stream << "--shards must be at least 1 and requires "
+                      "--definition\n";
+      return ParseResult::k_failure;
+    }
+  }
+  if (elf_machine) {
+    const std::string &machine = args::get(elf_machine);
+    if (machine == "x86-64" || machine == "x86_64") {
+      options.elf_machine = cpp11embed::ElfMachine::k_x86_64;
+    } else if (machine == "aarch64" || machine == "arm64") {
+      options.elf_machine = cpp11embed::ElfMachine::k_aarch64;
+    } else {
+      error_stream << "Unsupported ELF machine: " << machine << "\n";
+      return ParseResult::k_failure;
+    }
+  }
+  if (alignment) {
+    options.alignment = args::get(alignment);
+    // Must be a power of two
+    if (options.alignment == 0 ||
+        (options.alignment & (options.alignment - 1)) != 0) {
+      error_stream << "Alignment must be a power of two\n";
+      return ParseResult::k_failure;
+    }
+  }
+  if (word_size) {
+    options.word_size = args::get(word_size);
+    if (options.word_size != 1 && options.word_size != 2 &&
+        options.word_size != 4 && options.word_size != 8) {
+      error_stream << "Word size must be 1, 2, 4 or 8\n";
+      return ParseResult::k_failure;
+    }
+  }
+  if (endianness) {
+    const std::string &byte_order = args::get(endianness);
+    if (byte_order != "little" && byte_order != "big") {
+      error_stream << "Unsupported endianness: " << byte_order << "\n";
+      return ParseResult::k_failure;
+    }
+    options.big_endian = byte_order == "big";
+  }
+  if (minify && !cpp11embed::GetMinifyFormat(args::get(minify),
+                                             options.minify_format)) {
+    error_stream << "Unsupported minify format: " << args::get(minify)
+                 << "\n";
+    return ParseResult::k_failure;
+  }
+  options.metadata = args::get(metadata);
+  options.content_type = args::get(content_type);
+  options.manifest_filename = args::get(manifest_filename);
+  options.deduplicate = args::get(deduplicate);
+  options.jobs = args::get(jobs);
+  // Each job buffers a few chunks of the input, and far more threads than
+  // cores only slows things down
+  if (options.jobs > 256) {
+    error_stream << "--jobs must be at most 256\n";
+    return ParseResult::k_failure;
+  }
+  options.incremental = args::get(incremental);
+  options.depfile_filename = args::get(depfile_filename);
+  options.stats = args::get(stats);
+  options.stats_json_filename = args::get(stats_json_filename);
+  options.watch = args::get(watch);
+
+  if (options.manifest_filename.empty() &&
+      (options.incremental || !options.depfile_filename.empty()) &&
+      (options.input_filename == "-" || options.output_filename.empty())) {
+    error_stream << "--incremental and --depfile require an input file and "
+                    "an output file\n";
+    return ParseResult::k_failure;
+  }
+  if (options.compress && (!options.incbin_filename.empty() ||
+                           !options.elf_object_filename.empty())) {
+    error_stream << "--compress can't be used with --incbin or --elf-object\n";
+    return ParseResult::k_failure;
+  }
+  if (!options.incbin_filename.empty() &&
+      !options.elf_object_filename.empty()) {
+    error_stream << "--incbin can't be used with --elf-object\n";
+    return ParseResult::k_failure;
+  }
+  if (!options.definition_filename.empty() &&
+      (options.output_filename.empty() || options.compress ||
+       options.directory || !options.incbin_filename.empty() ||
+       !options.elf_object_filename.empty())) {
+    error_stream << "--definition requires an output file and can't be used "
+                    "with --compress, --directory, --incbin or "
+                    "--elf-object\n";
+    return ParseResult::k_failure;
+  }
+  if (options.directory &&
+      (options.input_filename == "-" || options.binary_mode ||
+       options.binary_string_literal || options.compress ||
+       !options.incbin_filename.empty() ||
+       !options.elf_object_filename.empty())) {
+    error_stream << "--directory requires an input directory and can't be "
+                    "used with -b, -s, --compress, --incbin or --elf-object\n";
+    return ParseResult::k_failure;
+  }
+  if ((word_size || endianness) &&
+      (!options.binary_mode || options.binary_string_literal ||
+       options.compress || !options.incbin_filename.empty() ||
+       !options.elf_object_filename.empty() ||
+       !options.definition_filename.empty())) {
+    error_stream << "--word-size and --endianness require -b and can't be "
+                    "used with -s, --compress, --incbin, --elf-object or "
+                    "--definition\n";
+    return ParseResult::k_failure;
+  }
+  if (minify && (options.binary_mode || options.binary_string_literal ||
+                 options.compress || options.directory ||
+                 !options.incbin_filename.empty() ||
+                 !options.elf_object_filename.empty() ||
+                 !options.definition_filename.empty())) {
+    error_stream << "--minify only applies to text and can't be used with "
+                    "-b, -s, --compress, --directory, --incbin, --elf-object "
+                    "or --definition\n";
+    return ParseResult::k_failure;
+  }
+  if (options.metadata &&
+      (options.compress || options.directory ||
+       !options.incbin_filename.empty() ||
+       !options.elf_object_filename.empty() ||
+       !options.definition_filename.empty())) {
+    error_stream << "--metadata can't be used with --compress, --directory, "
+                    "--incbin, --elf-object or --definition\n";
+    return ParseResult::k_failure;
+  }
+  if (options.runtime_load &&
+      (options.input_filename == "-" || options.compress ||
+       options.directory || !options.incbin_filename.empty() ||
+       !options.elf_object_filename.empty() ||
+       !options.definition_filename.empty() || word_size || endianness ||
+       minify || options.metadata)) {
+    error_stream << "--runtime-load requires an input file and can't be used "
+                    "with --compress, --directory, --incbin, --elf-object, "
+                    "--definition, --word-size, --endianness, --minify or "
+                    "--metadata\n";
+    return ParseResult::k_failure;
+  }
+  if (content_type && !options.metadata) {
+    error_stream << "--content-type requires --metadata\n";
+    return ParseResult::k_failure;
+  }
+  if (!options.manifest_filename.empty() &&
+      !options.depfile_filename.empty()) {
+    error_stream << "--depfile can't be used with --manifest\n";
+    return ParseResult::k_failure;
+  }
+  if (options.manifest_filename.empty() && options.deduplicate) {
+    error_stream << "--deduplicate requires --manifest\n";
+    return ParseResult::k_failure;
+  }
+  if (options.watch && options.manifest_filename.empty() &&
+      (options.input_filename == "-" || options.output_filename.empty())) {
+    error_stream << "--watch requires an input file and an output file (or "
+                    "a manifest)\n";
+    return ParseResult::k_failure;
+  }
+  return ParseResult::k_success;
+}
+
+/**
+ * @returns whether the entry's data could be shared with other entries
+ */
+bool CanBeDeduplicated(const Options &options) {
+  return options.input_filename != "-" && !options.directory &&
+         !options.runtime_load &&
+         options.incbin_filename.empty() &&
+         options.elf_object_filename.empty() &&
+         options.definition_filename.empty() &&
+         !options.output_filename.empty();
+}
+
+/**
+ * Points every entry whose input has the same contents as that of an earlier
+ * entry (and would be embedded in the same way) at the earlier entry's header
+ * rather than embedding another copy.
+ * @param parsed whether each entry's options were parsed successfully
+ * @param number_of_duplicates set to the number of entries that now refer to
+ * another entry's data
+ * @returns the number of bytes that no longer need to be embedded
+ */
+size_t DeduplicateManifestEntries(std::vector<Options> &entry_options,
+                                  const std::vector<char> &parsed,
+                                  const unsigned jobs,
+                                  size_t &number_of_duplicates) {
+  // Inputs that can't be mapped are simply never deduplicated
+  std::vector<std::unique_ptr<cpp11embed::MappedFile>> mapped_files(
+      entry_options.size());
+  std::vector<uint64_t> hashes(entry_options.size());
+  cpp11embed::ParallelFor(entry_options.size(), jobs, [&](const size_t i) {
+    if (!parsed[i] || !CanBeDeduplicated(entry_options[i])) {
+      return;
+    }
+    auto mapped_file = std::make_unique<cpp11embed::MappedFile>(
+        entry_options[i].input_filename);
+    if (!mapped_file->IsMapped() || mapped_file->GetBytes().size == 0) {
+      return;
+    }
+    const cpp11embed::ByteSpan input = mapped_file->GetBytes();
+    cpp11embed::Xxh64 xxh64;
+    xxh64.Update(input.data, input.size);
+    hashes[i] = xxh64.Digest();
+    mapped_files[i] = std::move(mapped_file);
+  });
+
+  const auto are_duplicates = [&](const size_t i, const size_t j) {
+    const Options &a = entry_options[i];
+    const Options &b = entry_options[j];
+    const cpp11embed::ByteSpan a_input = mapped_files[i]->GetBytes();
+    const cpp11embed::ByteSpan b_input = mapped_files[j]->GetBytes();
+    return a.binary_mode == b.binary_mode &&
+           a.binary_string_literal == b.binary_string_literal &&
+           a.compress == b.compress && a.alignment == b.alignment &&
+           a.word_size == b.word_size && a.big_endian == b.big_endian &&
+           a.minify_format == b.minify_format &&
+           a.metadata == b.metadata &&
+           GetDataMetadata(a).content_type ==
+               GetDataMetadata(b).content_type &&
+           a_input.size == b_input.size &&
+           std::memcmp(a_input.data, b_input.data, a_input.size) == 0;
+  };
+  // Earlier entries in the manifest are the ones that get embedded
+  std::unordered_map<uint64_t, std::vector<size_t>> canonical_by_hash;
+  size_t deduplicated_bytes = 0;
+  number_of_duplicates = 0;
+  for (size_t i = 0; i < entry_options.size(); i++) {
+    if (mapped_files[i] == nullptr) {
+      continue;
+    }
+    std::vector<size_t> &canonical_entries = canonical_by_hash[hashes[i]];
+    const auto canonical =
+        std::find_if(canonical_entries.begin(), canonical_entries.end(),
+                     [&](const size_t j) { return are_duplicates(i, j); });
+    if (canonical == canonical_entries.end()) {
+      canonical_entries.push_back(i);
+      continue;
+    }
+    entry_options[i].canonical_identifier_name =
+        entry_options[*canonical].identifier_name;
+    entry_options[i].canonical_output_filename =
+        entry_options[*canonical].output_filename;
+    deduplicated_bytes += mapped_files[i]->GetBytes().size;
+    number_of_duplicates++;
+  }
+  return deduplicated_bytes;
+}
+
+/**
+ * Generates every entry in the manifest, spread across several threads.
+ * Errors are reported in the order that the entries appear in the manifest.
+ * @param changed_inputs if not null, only the entries with one of these
+ * inputs are generated (or every entry with --deduplicate, as which entries
+ * are duplicates may have changed too)
+ * @param parsed_entries if not null, the entries that could be parsed are
+ * appended to this
+ */
+bool OutputManifestHeaders(
+    const Options &options,
+    const std::set<std::string> *const changed_inputs = nullptr,
+    std::vector<Options> *const parsed_entries = nullptr) {
+  std::ifstream manifest_stream{options.manifest_filename};
+  if (!manifest_stream) {
+    std::cerr << "Unable to read manifest\n";
+    return false;
+  }
+  std::vector<cpp11embed::ManifestEntry> entries;
+  try {
+    entries = cpp11embed::ReadManifest(manifest_stream);
+  } catch (const std::runtime_error &e) {
+    std::cerr << e.what() << "\n";
+    return false;
+  }
+
+  std::vector<std::string> errors(entries.size());
+  std::vector<Options> entry_options(entries.size());
+  std::vector<char> parsed(entries.size(), false);
+  std::vector<char> succeeded(entries.size(), false);
+  cpp11embed::ParallelFor(entries.size(), options.jobs, [&](const size_t i) {
+    std::ostringstream error_stream;
+    // Anything other than success (including --help) is an error
+    if (ParseOptions(entries[i].arguments, entry_options[i], error_stream,
+                     error_stream) == ParseResult::k_success) {
+      if (WantsStats(entry_options[i])) {
+        error_stream << "--stats and --stats-json apply to the whole "
+                        "manifest rather than its entries\n";
+      } else if (entry_options[i].watch) {
+        error_stream << "--watch applies to the whole manifest rather than "
+                        "its entries\n";
+      } else if (entry_options[i].manifest_filename.empty()) {
+        // Applies to every entry
+        entry_options[i].incremental |= options.incremental;
+        entry_options[i].watch = options.watch;
+        // The entries are already spread across the threads
+        entry_options[i].jobs = 1;
+        parsed[i] = true;
+      } else {
+        error_stream << "Manifests can't include other manifests\n";
+      }
+    }
+    errors[i] = error_stream.str();
+  });
+
+  if (options.deduplicate) {
+    size_t number_of_duplicates;
+    const size_t deduplicated_bytes = DeduplicateManifestEntries(
+        entry_options, parsed, options.jobs, number_of_duplicates);
+    std::cout << "Deduplicated " << number_of_duplicates << " of "
+              << entries.size() << " entries, saving " << deduplicated_bytes
+              << " bytes of embedded data\n";
+  }
+
+  std::vector<char> selected(entries.size(), false);
+  for (size_t i = 0; i < entries.size(); i++) {
+    selected[i] = changed_inputs == nullptr || options.deduplicate ||
+                  changed_inputs->count(entry_options[i].input_filename) != 0;
+    if (parsed[i] && parsed_entries != nullptr) {
+      parsed_entries->push_back(entry_options[i]);
+    }
+  }
+
+  std::vector<std::vector<cpp11embed::GenerationStats>> entry_stats(
+      entries.size());
+  cpp11embed::ParallelFor(entries.size(), options.jobs, [&](const size_t i) {
+    if (parsed[i] && selected[i]) {
+      std::ostringstream error_stream;
+      succeeded[i] =
+          OutputHeader(entry_options[i], error_stream,
+                       WantsStats(options) ? &entry_stats[i] : nullptr);
+      errors[i] = error_stream.str();
+    }
+  });
+
+  bool all_succeeded = true;
+  for (size_t i = 0; i < entries.size(); i++) {
+    if (selected[i] && !succeeded[i]) {
+      std::cerr << "Error in line " << entries[i].line_number
+                << " of the manifest:\n"
+                << errors[i];
+      all_succeeded = false;
+    }
+  }
+  // In the same order as the manifest
+  std::vector<cpp11embed::GenerationStats> stats;
+  for (const std::vector<cpp11embed::GenerationStats> &header_stats :
+       entry_stats) {
+    stats.insert(stats.end(), header_stats.begin(), header_stats.end());
+  }
+  return ReportStats(options, stats, std::cerr) && all_succeeded;
+}
+/**
+ * Generates the outputs for a single input and reports the stats if asked
+ * to
+ */
+bool OutputHeaderAndStats(const Options &options) {
+  std::vector<cpp11embed::GenerationStats> stats;
+  return OutputHeader(options, std::cerr,
+                      WantsStats(options) ? &stats : nullptr) &&
+         ReportStats(options, stats, std::cerr);
+}
+
+/**
+ * Starts watching the input of a single input or manifest entry
+ */
+bool WatchInput(cpp11embed::FileWatcher &watcher, const Options &options) {
+  const bool watching = options.directory
+                            ? watcher.AddDirectory(options.input_filename)
+                            : watcher.AddFile(options.input_filename);
+  if (!watching) {
+    std::cerr << "Unable to watch " << options.input_filename << "\n";
+  }
+  return watching;
+}
+
+/**
+ * Generates the outputs and then regenerates the ones whose inputs change
+ * until the process is stopped. Errors are reported but don't stop it.
+ * @returns false if the inputs couldn't be watched
+ */
+bool WatchInputs(const Options &options) {
+  const bool use_manifest = !options.manifest_filename.empty();
+  std::unique_ptr<cpp11embed::FileWatcher> watcher;
+  std::set<std::string> changed_paths;
+  while (true) {
+    const cpp11embed::Stopwatch stopwatch;
+    // Everything is generated at first and again whenever the manifest
+    // changes, as the inputs may have changed too. Inputs are watched before
+    // they are read so that no changes are missed.
+    if (watcher == nullptr ||
+        changed_paths.count(options.manifest_filename) != 0) {
+      watcher = std::make_unique<cpp11embed::FileWatcher>();
+      if (!watcher->IsValid()) {
+        std::cerr << "Unable to watch for changes (--watch is only "
+                     "available on Linux)\n";
+        return false;
+      }
+      if (!use_manifest) {
+        if (!WatchInput(*watcher, options)) {
+          return false;
+        }
+        OutputHeaderAndStats(options);
+      } else {
+        if (!watcher->AddFile(options.manifest_filename)) {
+          std::cerr << "Unable to watch " << options.manifest_filename
+                    << "\n";
+          return false;
+        }
+        std::vector<Options> entries;
+        OutputManifestHeaders(options, nullptr, &entries);
+        for (const Options &entry : entries) {
+          if (!WatchInput(*watcher, entry)) {
+            return false;
+          }
+        }
+      }
+    } else if (use_manifest) {
+      OutputManifestHeaders(options, &changed_paths);
+    } else {
+      OutputHeaderAndStats(options);
+    }
+    for (const std::string &path : changed_paths) {
+      std::cout << path << " changed\n";
+    }
+    std::cout << "Generated in " << std::fixed << std::setprecision(1)
+              << stopwatch.GetSeconds() * 1000 << " ms, watching for "
+              << "changes\n"
+              << std::flush;
+
+    changed_paths = watcher->WaitForChanges();
+    if (changed_paths.empty()) {
+      std::cerr << "Unable to watch for changes\n";
+      return false;
+    }
+  }
+}
+}  // namespace
+
+int main(const int argc, char *argv[]) {
+  Options options;
+  switch (ParseOptions(std::vector<std::string>(argv + 1, argv + argc),
+                       options, std::cout, std::cerr)) {
+    case ParseResult::k_help:
+      return EXIT_SUCCESS;
+    case ParseResult::k_failure:
+      return EXIT_FAILURE;
+    case ParseResult::k_success:
+      break;
+  }
+
+  if (options.watch) {
+    return WatchInputs(options) ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+  if (!options.manifest_filename.empty()) {
+    return OutputManifestHeaders(options) ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+  return OutputHeaderAndStats(options) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
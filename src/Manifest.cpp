@@ -0,0 +1,49 @@
+#include "Manifest.h"
+
+#include <stdexcept>
+
+namespace cpp11embed {
+std::vector<ManifestEntry> ReadManifest(std::istream &input_stream) {
+  std::vector<ManifestEntry> entries;
+  std::string line;
+  for (size_t line_number = 1; std::getline(input_stream, line);
+       line_number++) {
+    // Manifests written on Windows
+    if (!line.empty() && line.back() == '\r') {
+      line.pop_back();
+    }
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+
+    std::vector<std::string> fields;
+    size_t field_start = 0;
+    while (true) {
+      const size_t field_end = line.find('\t', field_start);
+      fields.push_back(line.substr(field_start, field_end - field_start));
+      if (field_end == std::string::npos) {
+        break;
+      }
+      field_start = field_end + 1;
+    }
+    // An empty output would be standard output, which every entry would
+    // write to at once
+    if (fields.size() < 3 || fields[0].empty() || fields[1].empty() ||
+        fields[2].empty()) {
+      throw std::runtime_error(
+          "Line " + std::to_string(line_number) +
+          " of the manifest needs an input, an identifier and an output");
+    }
+
+    ManifestEntry entry{line_number, {fields[0], fields[1], "-o", fields[2]}};
+    for (size_t i = 3; i < fields.size(); i++) {
+      // Allow trailing tabs
+      if (!fields[i].empty()) {
+        entry.arguments.push_back(fields[i]);
+      }
+    }
+    entries.push_back(std::move(entry));
+  }
+  return entries;
+}
+}  // namespace cpp11embed
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace cpp11embed {
+struct ManifestEntry {
+  // Line in the manifest that the entry came from (starting from 1)
+  size_t line_number;
+  // Command line arguments for generating this entry
+  std::vector<std::string> arguments;
+};
+
+/**
+ * Reads a manifest describing several headers to generate. Each line has tab
+ * separated fields: the input path, the identifier name, the output path and
+ * then any other command line arguments (one per field), e.g.
+ * "shader.glsl\tk_shader\tshader.h\t-g". Blank lines and lines starting with #
+ * are ignored.
+ * @returns the arguments to pass to Cpp11Embed for each entry, with the
+ * output path turned into -o <output path>
+ * @throws std::runtime_error if a line doesn't have enough fields
+ */
+std::vector<ManifestEntry> ReadManifest(std::istream &input_stream);
+}  // namespace cpp11embed
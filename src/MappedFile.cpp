@@ -0,0 +1,91 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace cpp11embed {
+#ifdef _WIN32
+MappedFile::MappedFile(const std::string &path) {
+  const HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                                  nullptr, OPEN_EXISTING,
+                                  FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return;
+  }
+  LARGE_INTEGER file_size;
+  if (GetFileType(file) == FILE_TYPE_DISK && GetFileSizeEx(file, &file_size)) {
+    size_ = static_cast<size_t>(file_size.QuadPart);
+    if (size_ == 0) {
+      is_mapped_ = true;
+    } else {
+      const HANDLE mapping =
+          CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+      if (mapping != nullptr) {
+        const void *const data =
+            MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        // The view keeps the mapping alive
+        CloseHandle(mapping);
+        if (data != nullptr) {
+          data_ = static_cast<const char *>(data);
+          is_mapped_ = true;
+        }
+      }
+    }
+  }
+  CloseHandle(file);
+}
+
+MappedFile::~MappedFile() {
+  if (data_ != nullptr) {
+    UnmapViewOfFile(data_);
+  }
+}
+#else
+MappedFile::MappedFile(const std::string &path) {
+  // Check before opening the file as opening some things (e.g. named pipes)
+  // has side effects
+  struct stat file_status;
+  if (stat(path.c_str(), &file_status) != 0 || !S_ISREG(file_status.st_mode)) {
+    return;
+  }
+  const int file_descriptor = open(path.c_str(), O_RDONLY);
+  if (file_descriptor < 0) {
+    return;
+  }
+  // The file may have been replaced since it was checked
+  if (fstat(file_descriptor, &file_status) == 0 &&
+      S_ISREG(file_status.st_mode)) {
+    size_ = static_cast<size_t>(file_status.st_size);
+    if (size_ == 0) {
+      is_mapped_ = true;
+    } else {
+      void *const data =
+          mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+      if (data != MAP_FAILED) {
+        // Every byte is read once from start to end so the kernel can read
+        // ahead aggressively and drop pages once they have been read
+        posix_madvise(data, size_, POSIX_MADV_SEQUENTIAL);
+        data_ = static_cast<const char *>(data);
+        is_mapped_ = true;
+      }
+    }
+  }
+  close(file_descriptor);
+}
+
+MappedFile::~MappedFile() {
+  if (data_ != nullptr) {
+    munmap(const_cast<char *>(data_), size_);
+  }
+}
+#endif
+}  // namespace cpp11embed
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string>
+
+#include "ByteSpan.h"
+
+namespace cpp11embed {
+/**
+ * Maps a whole file into memory (read only) so that it can be read without
+ * copying it through a stream. Only regular files can be mapped, anything
+ * else (e.g. a pipe) has to be read as a stream.
+ */
+class MappedFile {
+ public:
+  /**
+   * Maps the file if possible, use IsMapped to find out whether it was
+   */
+  explicit MappedFile(const std::string &path);
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  bool IsMapped() const { return is_mapped_; }
+
+  /**
+   * @returns the contents of the file, which are valid for as long as this
+   * object exists
+   */
+  ByteSpan GetBytes() const { return {data_, size_}; }
+
+ private:
+  // Null for empty files as they can't be mapped (nor do they need to be)
+  const char *data_ = nullptr;
+  size_t size_ = 0;
+  bool is_mapped_ = false;
+};
+}  // namespace cpp11embed
@@ -0,0 +1,526 @@
+#include "Minify.h"
+
+#include <cctype>
+#include <cstring>
+
+namespace cpp11embed {
+namespace {
+/**
+ * How whitespace between tokens is treated
+ */
+enum class WhitespacePolicy {
+  // None of it is needed
+  k_remove,
+  // Needed unless next to punctuation that separates things anyway
+  k_css,
+  // Needed between two words or two operators
+  k_code
+};
+
+/**
+ * What a code minifier needs to know about a language
+ */
+struct CodeSyntax {
+  // Characters that start and end string literals
+  const char *quotes;
+  bool backslash_escapes;
+  // Characters that start a comment running to the end of the line when
+  // doubled, "" if there are none. Every language has /* */ comments.
+  const char *line_comment;
+  // Whether lines starting with # are preprocessor directives
+  bool directives;
+  WhitespacePolicy whitespace_policy;
+  // Whether strings can be quoted with $$ or $tag$ as in PostgreSQL
+  bool dollar_quotes;
+};
+
+constexpr CodeSyntax k_json_syntax{"\"", true, "/", false,
+                                   WhitespacePolicy::k_remove, false};
+constexpr CodeSyntax k_glsl_syntax{"", false, "/", true,
+                                   WhitespacePolicy::k_code, false};
+constexpr CodeSyntax k_css_syntax{"\"'", true, "", false,
+                                  WhitespacePolicy::k_css, false};
+constexpr CodeSyntax k_sql_syntax{"'\"`", false, "-", false,
+                                  WhitespacePolicy::k_code, true};
+
+bool IsWhitespace(const char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' ||
+         c == '\v';
+}
+
+bool Contains(const char *const characters, const char c) {
+  return c != '\0' && std::strchr(characters, c) != nullptr;
+}
+
+/**
+ * Part of an identifier or number (anything non-ASCII is assumed to be part of
+ * a UTF-8 identifier)
+ */
+bool IsWordCharacter(const char c) {
+  return std::isalnum(static_cast<unsigned char>(c)) || c == '_' ||
+         c == '$' || c == '.' || static_cast<unsigned char>(c) >= 0x80;
+}
+
+bool IsOperatorCharacter(const char c) {
+  return Contains("+-*/%<>=!&|^~?:#@", c);
+}
+
+/**
+ * For JSON, GLSL, CSS and SQL which all tokenise much like C does
+ */
+class CodeMinifier : public Minifier {
+ public:
+  explicit CodeMinifier(const CodeSyntax &syntax) : syntax_(syntax) {}
+
+  void Write(const char *const data, const size_t size,
+             std::string &output) override {
+    for (size_t i = 0; i < size; i++) {
+      Process(data[i], output);
+    }
+  }
+
+  void Finish(std::string &output) override {
+    if (state_ == State::k_maybe_comment) {
+      OutputToken(maybe_comment_, output);
+    }
+    state_ = State::k_code;
+  }
+
+ private:
+  enum class State {
+    k_code,
+    // After a character that might start a comment
+    k_maybe_comment,
+    k_line_comment,
+    k_block_comment,
+    // After a * in a block comment
+    k_block_comment_star,
+    k_string,
+    // After a backslash in a string
+    k_string_escape,
+    // After a $ that might start a dollar quoted string
+    k_dollar_tag,
+    k_dollar_string
+  };
+
+  void Process(const char c, std::string &output) {
+    switch (state_) {
+      case State::k_code:
+        if (IsWhitespace(c)) {
+          ProcessWhitespace(c, output);
+        } else if (c == '/' || Contains(syntax_.line_comment, c)) {
+          maybe_comment_ = c;
+          state_ = State::k_maybe_comment;
+        } else if (c == '$' && syntax_.dollar_quotes &&
+                   (space_pending_ || !IsWordCharacter(last_))) {
+          // Rather than part of an identifier
+          OutputToken(c, output);
+          dollar_tag_ = "$";
+          state_ = State::k_dollar_tag;
+        } else {
+          OutputToken(c, output);
+        }
+        return;
+      case State::k_maybe_comment:
+        state_ = State::k_code;
+        if (maybe_comment_ == '/' && c == '*') {
+          state_ = State::k_block_comment;
+        } else if (c == maybe_comment_ &&
+                   Contains(syntax_.line_comment, c)) {
+          state_ = State::k_line_comment;
+        } else {
+          OutputToken(maybe_comment_, output);
+          Process(c, output);
+        }
+        return;
+      case State::k_line_comment:
+        if (c == '\n') {
+          state_ = State::k_code;
+          ProcessWhitespace(c, output);
+        }
+        return;
+      case State::k_block_comment:
+        if (c == '*') {
+          state_ = State::k_block_comment_star;
+        }
+        return;
+      case State::k_block_comment_star:
+        if (c == '/') {
+          // Like C, a comment separates tokens just as a space does
+          state_ = State::k_code;
+          space_pending_ = true;
+        } else if (c != '*') {
+          state_ = State::k_block_comment;
+        }
+        return;
+      case State::k_string:
+        output += c;
+        if (c == '\\' && syntax_.backslash_escapes) {
+          state_ = State::k_string_escape;
+        } else if (c == quote_) {
+          last_ = c;
+          state_ = State::k_code;
+        }
+        return;
+      case State::k_string_escape:
+        output += c;
+        state_ = State::k_string;
+        return;
+      case State::k_dollar_tag:
+        if (c == '$') {
+          dollar_tag_ += c;
+          output += c;
+          dollar_tag_matched_ = 0;
+          state_ = State::k_dollar_string;
+        } else if (std::isalpha(static_cast<unsigned char>(c)) || c == '_' ||
+                   static_cast<unsigned char>(c) >= 0x80 ||
+                   (std::isdigit(static_cast<unsigned char>(c)) &&
+                    dollar_tag_.size() > 1)) {
+          dollar_tag_ += c;
+          output += c;
+          last_ = c;
+        } else {
+          // Not a dollar quote after all (e.g. a parameter like $1)
+          state_ = State::k_code;
+          Process(c, output);
+        }
+        return;
+      case State::k_dollar_string:
+        output += c;
+        if (c == dollar_tag_[dollar_tag_matched_]) {
+          dollar_tag_matched_++;
+        } else {
+          dollar_tag_matched_ = (c == '$') ? 1 : 0;
+        }
+        if (dollar_tag_matched_ == dollar_tag_.size()) {
+          last_ = c;
+          state_ = State::k_code;
+        }
+        return;
+    }
+  }
+
+  void ProcessWhitespace(const char c, std::string &output) {
+    if (c != '\n') {
+      space_pending_ = true;
+      return;
+    }
+    if (in_directive_) {
+      // Directives end at the end of the line, unless it is escaped
+      if (last_ == '\\') {
+        output += '\n';
+        last_ = '\n';
+        space_pending_ = false;
+        return;
+      }
+      output += '\n';
+      last_ = '\n';
+      in_directive_ = false;
+      space_pending_ = false;
+    } else {
+      space_pending_ = true;
+    }
+    at_line_start_ = true;
+  }
+
+  void OutputToken(const char c, std::string &output) {
+    if (syntax_.directives && at_line_start_ && c == '#' && !in_directive_) {
+      if (last_ != '\0' && last_ != '\n') {
+        output += '\n';
+      }
+      in_directive_ = true;
+      space_pending_ = false;
+    } else if (space_pending_ && IsSpaceNeeded(c)) {
+      output += ' ';
+    }
+    space_pending_ = false;
+    at_line_start_ = false;
+    output += c;
+    last_ = c;
+    if (Contains(syntax_.quotes, c)) {
+      quote_ = c;
+      state_ = State::k_string;
+    }
+  }
+
+  /**
+   * @returns whether a space is needed between the last token and the next
+   * one, which starts with c
+   */
+  bool IsSpaceNeeded(const char c) const {
+    if (last_ == '\0' || last_ == '\n') {
+      return false;
+    }
+    if (in_directive_) {
+      // e.g. #define A (1) and #define A(1) mean different things
+      return true;
+    }
+    switch (syntax_.whitespace_policy) {
+      case WhitespacePolicy::k_remove:
+        return false;
+      case WhitespacePolicy::k_css:
+        return !Contains("{};,>~", last_) && !Contains("{};,>~", c) &&
+               last_ != ':';
+      case WhitespacePolicy::k_code: {
+        // Quotes are treated as words so that 'a' 'b' doesn't become 'a''b'
+        const auto is_word = [this](const char character) {
+          return IsWordCharacter(character) ||
+                 Contains(syntax_.quotes, character);
+        };
+        return (is_word(last_) && is_word(c)) ||
+               (IsOperatorCharacter(last_) && IsOperatorCharacter(c));
+      }
+    }
+    return true;
+  }
+
+  const CodeSyntax &syntax_;
+  State state_ = State::k_code;
+  char maybe_comment_ = '\0';
+  char quote_ = '\0';
+  // The $ and tag that start (and end) a dollar quoted string
+  std::string dollar_tag_;
+  size_t dollar_tag_matched_ = 0;
+  // The last character output, '\0' if there hasn't been one
+  char last_ = '\0';
+  bool space_pending_ = false;
+  bool at_line_start_ = true;
+  bool in_directive_ = false;
+};
+
+/**
+ * Elements whose contents are left as they are
+ */
+constexpr const char *k_raw_html_elements[]{"pre", "textarea", "script",
+                                            "style"};
+constexpr size_t k_max_html_tag_name_size = 8;
+
+/**
+ * Collapses whitespace in text and tags to a single space (it can't be removed
+ * entirely as it separates inline elements) and strips comments
+ */
+class HtmlMinifier : public Minifier {
+ public:
+  void Write(const char *const data, const size_t size,
+             std::string &output) override {
+    for (size_t i = 0; i < size; i++) {
+      Process(data[i], output);
+    }
+  }
+
+  void Finish(std::string &output) override {
+    if (state_ == State::k_maybe_comment) {
+      OutputPendingSpace(output);
+      output += comment_start_;
+    }
+    state_ = State::k_text;
+  }
+
+ private:
+  enum class State {
+    k_text,
+    // After a < that might start <!--
+    k_maybe_comment,
+    k_comment,
+    k_tag_name,
+    k_tag,
+    k_attribute_value,
+    k_raw_text
+  };
+
+  void Process(const char c, std::string &output) {
+    switch (state_) {
+      case State::k_text:
+        if (IsWhitespace(c)) {
+          // Leading whitespace isn't needed
+          space_pending_ = started_;
+          return;
+        }
+        started_ = true;
+        if (c == '<') {
+          // The space before it isn't output until it's clear that this
+          // isn't a comment, which is removed along with the space if there
+          // is another after it
+          comment_start_ = "<";
+          state_ = State::k_maybe_comment;
+        } else {
+          OutputPendingSpace(output);
+          output += c;
+        }
+        return;
+      case State::k_maybe_comment:
+        comment_start_ += c;
+        if (comment_start_ == "<!--") {
+          dashes_ = 0;
+          state_ = State::k_comment;
+        } else if (std::strncmp(comment_start_.c_str(), "<!--",
+                                comment_start_.size()) != 0) {
+          const char last = comment_start_.back();
+          comment_start_.pop_back();
+          OutputPendingSpace(output);
+          output += comment_start_;
+          if (comment_start_.size() == 1 &&
+              !std::isalpha(static_cast<unsigned char>(last)) && last != '/') {
+            // Just a < in the text (e.g. a < b)
+            state_ = State::k_text;
+          } else {
+            // Not a comment so it must be a tag
+            tag_name_.clear();
+            closing_tag_ = false;
+            state_ = State::k_tag_name;
+          }
+          Process(last, output);
+        }
+        return;
+      case State::k_comment:
+        if (c == '>' && dashes_ >= 2) {
+          state_ = State::k_text;
+        }
+        dashes_ = (c == '-') ? dashes_ + 1 : 0;
+        return;
+      case State::k_tag_name:
+        if (c == '/' && tag_name_.empty() && !closing_tag_) {
+          closing_tag_ = true;
+          output += c;
+          return;
+        }
+        if (IsWhitespace(c) || c == '>' || c == '/') {
+          state_ = State::k_tag;
+          Process(c, output);
+          return;
+        }
+        if (tag_name_.size() <= k_max_html_tag_name_size) {
+          tag_name_ += static_cast<char>(
+              std::tolower(static_cast<unsigned char>(c)));
+        }
+        output += c;
+        return;
+      case State::k_tag:
+        if (IsWhitespace(c)) {
+          space_pending_ = true;
+          return;
+        }
+        if (c == '>') {
+          space_pending_ = false;
+          output += c;
+          EndTag();
+          return;
+        }
+        OutputPendingSpace(output);
+        output += c;
+        if (c == '"' || c == '\'') {
+          quote_ = c;
+          state_ = State::k_attribute_value;
+        }
+        return;
+      case State::k_attribute_value:
+        output += c;
+        if (c == quote_) {
+          state_ = State::k_tag;
+        }
+        return;
+      case State::k_raw_text:
+        output += c;
+        MatchRawTextEnd(c);
+        return;
+    }
+  }
+
+  void OutputPendingSpace(std::string &output) {
+    if (space_pending_) {
+      output += ' ';
+      space_pending_ = false;
+    }
+  }
+
+  void EndTag() {
+    state_ = State::k_text;
+    if (closing_tag_) {
+      return;
+    }
+    for (const char *const element : k_raw_html_elements) {
+      if (tag_name_ == element) {
+        raw_text_end_ = std::string{"</"} + element;
+        raw_text_matched_ = 0;
+        state_ = State::k_raw_text;
+        return;
+      }
+    }
+  }
+
+  /**
+   * Keeps track of how much of the closing tag of a raw text element has been
+   * seen, switching back to minifying once all of it has
+   */
+  void MatchRawTextEnd(const char c) {
+    const char lower =
+        static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    if (lower == raw_text_end_[raw_text_matched_]) {
+      raw_text_matched_++;
+    } else {
+      raw_text_matched_ = (c == '<') ? 1 : 0;
+    }
+    if (raw_text_matched_ == raw_text_end_.size()) {
+      tag_name_ = raw_text_end_.substr(2);
+      closing_tag_ = true;
+      state_ = State::k_tag;
+    }
+  }
+
+  State state_ = State::k_text;
+  std::string comment_start_;
+  size_t dashes_ = 0;
+  std::string tag_name_;
+  bool closing_tag_ = false;
+  char quote_ = '\0';
+  std::string raw_text_end_;
+  size_t raw_text_matched_ = 0;
+  // Whether anything other than whitespace has been seen
+  bool started_ = false;
+  bool space_pending_ = false;
+};
+}  // namespace
+
+bool GetMinifyFormat(const std::string &name, MinifyFormat &format) {
+  if (name == "json") {
+    format = MinifyFormat::k_json;
+  } else if (name == "glsl") {
+    format = MinifyFormat::k_glsl;
+  } else if (name == "css") {
+    format = MinifyFormat::k_css;
+  } else if (name == "html") {
+    format = MinifyFormat::k_html;
+  } else if (name == "sql") {
+    format = MinifyFormat::k_sql;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+std::unique_ptr<Minifier> MakeMinifier(const MinifyFormat format) {
+  switch (format) {
+    case MinifyFormat::k_json:
+      return std::unique_ptr<Minifier>{new CodeMinifier{k_json_syntax}};
+    case MinifyFormat::k_glsl:
+      return std::unique_ptr<Minifier>{new CodeMinifier{k_glsl_syntax}};
+    case MinifyFormat::k_css:
+      return std::unique_ptr<Minifier>{new CodeMinifier{k_css_syntax}};
+    case MinifyFormat::k_sql:
+      return std::unique_ptr<Minifier>{new CodeMinifier{k_sql_syntax}};
+    case MinifyFormat::k_html:
+      return std::unique_ptr<Minifier>{new HtmlMinifier};
+    case MinifyFormat::k_none:
+      break;
+  }
+  return nullptr;
+}
+
+std::string Minify(const MinifyFormat format, const std::string &input) {
+  std::string output;
+  const std::unique_ptr<Minifier> minifier = MakeMinifier(format);
+  minifier->Write(input.data(), input.size(), output);
+  minifier->Finish(output);
+  return output;
+}
+}  // namespace cpp11embed
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace cpp11embed {
+/**
+ * Formats of text that can be minified before it is embedded
+ */
+enum class MinifyFormat { k_none, k_json, k_glsl, k_css, k_html, k_sql };
+
+/**
+ * @param name json, glsl, css, html or sql
+ * @returns false if the name isn't one of those
+ */
+bool GetMinifyFormat(const std::string &name, MinifyFormat &format);
+
+/**
+ * Strips comments and collapses whitespace that doesn't change the meaning
+ * of the text in a single pass. The text is given a piece at a time and only
+ * the last few characters are ever held back, so memory usage doesn't depend
+ * on the size of the input. String literals (and for HTML the contents of
+ * pre, textarea, script and style elements) are left as they are.
+ */
+class Minifier {
+ public:
+  virtual ~Minifier() = default;
+
+  /**
+   * Appends the minified form of the next piece of the text to output.
+   * Anything whose form depends on what comes next is held back until then.
+   */
+  virtual void Write(const char *data, size_t size, std::string &output) = 0;
+
+  /**
+   * Appends anything still held back once all of the text has been written
+   */
+  virtual void Finish(std::string &output) = 0;
+};
+
+/**
+ * @param format must not be MinifyFormat::k_none
+ */
+std::unique_ptr<Minifier> MakeMinifier(MinifyFormat format);
+
+/**
+ * @returns the whole of the input minified
+ */
+std::string Minify(MinifyFormat format, const std::string &input);
+}  // namespace cpp11embed
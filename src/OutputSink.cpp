@@ -0,0 +1,76 @@
+#include "OutputSink.h"
+
+#include <algorithm>
+#include <cerrno>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace cpp11embed {
+void OstreamSink::Write(const char *const data, const size_t size) {
+  output_stream_.write(data, static_cast<std::streamsize>(size));
+}
+
+void FileDescriptorSink::Write(const char *data, size_t size) {
+  while (size > 0 && !failed_) {
+#ifdef _WIN32
+    // Can't write more than an int's worth at once
+    const int written =
+        _write(file_descriptor_, data,
+               static_cast<unsigned>(std::min<size_t>(size, 1 << 30)));
+#else
+    const ssize_t written = write(file_descriptor_, data, size);
+#endif
+    if (written < 0) {
+      failed_ = errno != EINTR;
+      continue;
+    }
+    data += written;
+    size -= static_cast<size_t>(written);
+  }
+}
+
+void VectorSink::Write(const char *const data, const size_t size) {
+  output_.insert(output_.end(), data, data + size);
+}
+
+constexpr size_t BufferedOutput::k_default_buffer_size;
+
+BufferedOutput::BufferedOutput(OutputSink &sink, const size_t buffer_size)
+    : sink_(sink), buffer_(buffer_size) {}
+
+void BufferedOutput::Write(const char *const data, const size_t size) {
+  if (buffer_.size() - buffer_used_ < size) {
+    Flush();
+    // Not worth copying into the buffer
+    if (size >= buffer_.size()) {
+      sink_.Write(data, size);
+      return;
+    }
+  }
+  std::copy_n(data, size, buffer_.data() + buffer_used_);
+  buffer_used_ += size;
+}
+
+void BufferedOutput::WriteDecimal(uint64_t value) {
+  // Enough for the largest 64 bit value
+  char digits[20];
+  char *const end = digits + sizeof(digits);
+  char *start = end;
+  do {
+    *--start = static_cast<char>('0' + value % 10);
+    value /= 10;
+  } while (value != 0);
+  Write(start, static_cast<size_t>(end - start));
+}
+
+void BufferedOutput::Flush() {
+  if (buffer_used_ != 0) {
+    sink_.Write(buffer_.data(), buffer_used_);
+    buffer_used_ = 0;
+  }
+}
+}  // namespace cpp11embed
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace cpp11embed {
+/**
+ * Somewhere that generated output goes. Only ever given large blocks (by a
+ * BufferedOutput) so the cost of a virtual call per write doesn't matter.
+ */
+class OutputSink {
+ public:
+  virtual ~OutputSink() = default;
+
+  virtual void Write(const char *data, size_t size) = 0;
+
+  /**
+   * @returns true if anything could not be written
+   */
+  virtual bool HasFailed() const = 0;
+};
+
+class OstreamSink : public OutputSink {
+ public:
+  explicit OstreamSink(std::ostream &output_stream)
+      : output_stream_(output_stream) {}
+
+  void Write(const char *data, size_t size) override;
+  bool HasFailed() const override { return !output_stream_; }
+
+ private:
+  std::ostream &output_stream_;
+};
+
+/**
+ * Writes straight to a file descriptor (e.g. 1 for standard output) without
+ * any buffering of its own. The file descriptor is not closed.
+ */
+class FileDescriptorSink : public OutputSink {
+ public:
+  explicit FileDescriptorSink(int file_descriptor)
+      : file_descriptor_(file_descriptor) {}
+
+  void Write(const char *data, size_t size) override;
+  bool HasFailed() const override { return failed_; }
+
+ private:
+  int file_descriptor_;
+  bool failed_ = false;
+};
+
+/**
+ * Appends to a vector in memory
+ */
+class VectorSink : public OutputSink {
+ public:
+  explicit VectorSink(std::vector<char> &output) : output_(output) {}
+
+  void Write(const char *data, size_t size) override;
+  bool HasFailed() const override { return false; }
+
+ private:
+  std::vector<char> &output_;
+};
+
+/**
+ * Collects output in a large buffer that is passed on to the sink whenever
+ * it fills up, so that small pieces of output are cheap to write and memory
+ * usage does not depend on the size of the output. Anything still buffered
+ * is flushed when this is destroyed.
+ */
+class BufferedOutput {
+ public:
+  static constexpr size_t k_default_buffer_size = 64 * 1024;
+
+  explicit BufferedOutput(OutputSink &sink,
+                          size_t buffer_size = k_default_buffer_size);
+  ~BufferedOutput() { Flush(); }
+
+  BufferedOutput(const BufferedOutput &) = delete;
+  BufferedOutput &operator=(const BufferedOutput &) = delete;
+
+  /**
+   * @returns somewhere that at least size characters (no more than the size
+   * of the buffer) can be written to. Call Commit with the number actually
+   * written.
+   */
+  char *Reserve(const size_t size) {
+    if (buffer_.size() - buffer_used_ < size) {
+      Flush();
+    }
+    return buffer_.data() + buffer_used_;
+  }
+
+  void Commit(const size_t size) { buffer_used_ += size; }
+
+  void Write(const char *data, size_t size);
+  void Write(const std::string &text) { Write(text.data(), text.size()); }
+  void Write(const char c) {
+    *Reserve(1) = c;
+    Commit(1);
+  }
+  void WriteDecimal(uint64_t value);
+
+  void Flush();
+
+ private:
+  OutputSink &sink_;
+  std::vector<char> buffer_;
+  size_t buffer_used_ = 0;
+};
+}  // namespace cpp11embed
@@ -0,0 +1,36 @@
+#include "Parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace cpp11embed {
+unsigned GetDefaultNumberOfJobs() {
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void ParallelFor(const size_t count, unsigned number_of_jobs,
+                 const std::function<void(size_t)> &task) {
+  if (number_of_jobs == 0) {
+    number_of_jobs = GetDefaultNumberOfJobs();
+  }
+  std::atomic<size_t> next_index{0};
+  const auto worker = [&]() {
+    for (size_t i = next_index++; i < count; i = next_index++) {
+      task(i);
+    }
+  };
+
+  const size_t number_of_threads =
+      std::min(static_cast<size_t>(number_of_jobs), count);
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < number_of_threads; i++) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+}  // namespace cpp11embed
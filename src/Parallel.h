@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+namespace cpp11embed {
+/**
+ * @returns the number of threads that can usefully run at the same time
+ */
+unsigned GetDefaultNumberOfJobs();
+
+/**
+ * Calls task(i) for every i in [0, count) spread across up to
+ * number_of_jobs threads (including the calling one). Threads claim the next
+ * unclaimed index whenever they finish a task so that a few slow tasks don't
+ * hold up the rest.
+ * @param number_of_jobs 0 to use GetDefaultNumberOfJobs()
+ */
+void ParallelFor(size_t count, unsigned number_of_jobs,
+                 const std::function<void(size_t)> &task);
+}  // namespace cpp11embed
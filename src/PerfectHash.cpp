@@ -0,0 +1,91 @@
+#include "PerfectHash.h"
+
+#include <algorithm>
+
+namespace cpp11embed {
+namespace {
+// Buckets that can't be placed after this many seeds almost certainly never
+// will be (in practice a few thousand is plenty)
+constexpr uint32_t k_max_seed = 1U << 24;
+
+size_t GetSlot(const uint32_t seed, const std::string &key,
+               const size_t number_of_keys) {
+  return HashKey(seed, key.data(), key.size()) % number_of_keys;
+}
+}  // namespace
+
+uint32_t HashKey(const uint32_t seed, const char *key, const size_t size) {
+  uint32_t hash = 2166136261U ^ seed;
+  for (size_t i = 0; i < size; i++) {
+    hash ^= static_cast<unsigned char>(key[i]);
+    hash *= 16777619U;
+  }
+  // FNV-1a barely mixes its low bits, which are all that is left after
+  // taking the remainder for small tables, so finish off with the
+  // MurmurHash3 finaliser
+  hash ^= hash >> 16;
+  hash *= 0x85EBCA6BU;
+  hash ^= hash >> 13;
+  hash *= 0xC2B2AE35U;
+  hash ^= hash >> 16;
+  return hash;
+}
+
+bool BuildPerfectHash(const std::vector<std::string> &keys,
+                      PerfectHash &perfect_hash) {
+  const size_t number_of_keys = keys.size();
+  perfect_hash.seeds.assign(number_of_keys, 0);
+  perfect_hash.slots.assign(number_of_keys, 0);
+
+  std::vector<std::vector<size_t>> buckets(number_of_keys);
+  for (size_t i = 0; i < number_of_keys; i++) {
+    buckets[GetSlot(0, keys[i], number_of_keys)].push_back(i);
+  }
+  // The biggest buckets are the hardest to place so do them while there are
+  // still plenty of free slots
+  std::vector<size_t> bucket_order(number_of_keys);
+  for (size_t i = 0; i < number_of_keys; i++) {
+    bucket_order[i] = i;
+  }
+  std::stable_sort(bucket_order.begin(), bucket_order.end(),
+                   [&buckets](const size_t a, const size_t b) {
+                     return buckets[a].size() > buckets[b].size();
+                   });
+
+  std::vector<bool> slot_used(number_of_keys, false);
+  std::vector<size_t> bucket_slots;
+  for (const size_t bucket_index : bucket_order) {
+    const std::vector<size_t> &bucket = buckets[bucket_index];
+    if (bucket.empty()) {
+      break;
+    }
+    uint32_t seed = 0;
+    for (;; seed++) {
+      if (seed == k_max_seed) {
+        return false;
+      }
+      bucket_slots.clear();
+      bool fits = true;
+      for (const size_t key_index : bucket) {
+        const size_t slot = GetSlot(seed, keys[key_index], number_of_keys);
+        if (slot_used[slot] || std::find(bucket_slots.begin(),
+                                         bucket_slots.end(),
+                                         slot) != bucket_slots.end()) {
+          fits = false;
+          break;
+        }
+        bucket_slots.push_back(slot);
+      }
+      if (fits) {
+        break;
+      }
+    }
+    perfect_hash.seeds[bucket_index] = seed;
+    for (size_t i = 0; i < bucket.size(); i++) {
+      perfect_hash.slots[bucket[i]] = bucket_slots[i];
+      slot_used[bucket_slots[i]] = true;
+    }
+  }
+  return true;
+}
+}  // namespace cpp11embed
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace cpp11embed {
+/**
+ * 32 bit FNV-1a with the seed mixed into the offset basis, followed by the
+ * MurmurHash3 finaliser. Generated headers contain the same function to look
+ * keys up.
+ */
+uint32_t HashKey(uint32_t seed, const char *key, size_t size);
+
+struct PerfectHash {
+  // Indexed by HashKey(0, key) % number of keys
+  std::vector<uint32_t> seeds;
+  // The slot of each key, in the same order as the keys
+  std::vector<size_t> slots;
+};
+
+/**
+ * Finds a minimal perfect hash for the keys using hash and displace: each
+ * key falls into a bucket and each bucket gets a seed that sends all of its
+ * keys to free slots. The slot of a key is then
+ * HashKey(seeds[HashKey(0, key) % n], key) % n where n is the number of keys.
+ * @param keys must not contain duplicates
+ * @returns false if no seed could be found for some bucket
+ */
+bool BuildPerfectHash(const std::vector<std::string> &keys,
+                      PerfectHash &perfect_hash);
+}  // namespace cpp11embed
@@ -0,0 +1,155 @@
+#include "Stats.h"
+
+#include <iomanip>
+#include <sstream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+// After windows.h, which it depends on
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace cpp11embed {
+namespace {
+constexpr size_t k_streambuf_size = 64 * 1024;
+
+void OutputJsonString(const std::string &value, std::ostream &output_stream) {
+  output_stream << '"';
+  for (const char c : value) {
+    if (c == '"' || c == '\\') {
+      output_stream << '\\' << c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      output_stream << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+                    << static_cast<int>(c) << std::dec;
+    } else {
+      output_stream << c;
+    }
+  }
+  output_stream << '"';
+}
+}  // namespace
+
+void TimedOutputSink::Write(const char *const data, const size_t size) {
+  const Stopwatch stopwatch;
+  sink_.Write(data, size);
+  seconds_ += stopwatch.GetSeconds();
+  bytes_written_ += size;
+}
+
+TimedStreambuf::TimedStreambuf(std::streambuf &source)
+    : source_(source), buffer_(k_streambuf_size) {}
+
+uint64_t TimedStreambuf::GetBytesRead() const {
+  return bytes_read_ - static_cast<uint64_t>(egptr() - gptr());
+}
+
+TimedStreambuf::int_type TimedStreambuf::underflow() {
+  const Stopwatch stopwatch;
+  const std::streamsize bytes_read = source_.sgetn(
+      buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+  seconds_ += stopwatch.GetSeconds();
+  if (bytes_read <= 0) {
+    return traits_type::eof();
+  }
+  bytes_read_ += static_cast<uint64_t>(bytes_read);
+  setg(buffer_.data(), buffer_.data(), buffer_.data() + bytes_read);
+  return traits_type::to_int_type(buffer_[0]);
+}
+
+TimedStreambuf::pos_type TimedStreambuf::seekoff(
+    off_type offset, const std::ios_base::seekdir direction,
+    const std::ios_base::openmode which) {
+  if (direction == std::ios_base::cur) {
+    // The source is ahead by however much is left in the buffer
+    offset -= egptr() - gptr();
+  }
+  DiscardBuffer();
+  return source_.pubseekoff(offset, direction, which);
+}
+
+TimedStreambuf::pos_type TimedStreambuf::seekpos(
+    const pos_type position, const std::ios_base::openmode which) {
+  DiscardBuffer();
+  return source_.pubseekpos(position, which);
+}
+
+void TimedStreambuf::DiscardBuffer() {
+  bytes_read_ -= static_cast<uint64_t>(egptr() - gptr());
+  setg(nullptr, nullptr, nullptr);
+}
+
+uint64_t GetPeakRss() {
+#ifdef _WIN32
+  PROCESS_MEMORY_COUNTERS counters;
+  if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters,
+                            sizeof(counters))) {
+    return 0;
+  }
+  return counters.PeakWorkingSetSize;
+#else
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+#ifdef __APPLE__
+  // Already in bytes
+  return static_cast<uint64_t>(usage.ru_maxrss);
+#else
+  // In kilobytes
+  return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+double GetExpansionRatio(const GenerationStats &stats) {
+  return (stats.input_bytes == 0) ? 0
+                                  : static_cast<double>(stats.output_bytes) /
+                                        static_cast<double>(stats.input_bytes);
+}
+
+void OutputStats(const GenerationStats &stats, std::ostream &output_stream) {
+  // Formatted separately so that the stream's flags are left alone
+  std::ostringstream line;
+  line << std::fixed << std::setprecision(3)
+       << (stats.output_filename.empty() ? "standard output"
+                                         : stats.output_filename)
+       << ": " << stats.mode << ", " << stats.input_bytes << " bytes in, "
+       << stats.output_bytes << " bytes out (" << std::setprecision(2)
+       << GetExpansionRatio(stats) << "x), read " << std::setprecision(3)
+       << stats.read_seconds << "s, format " << stats.format_seconds
+       << "s, write " << stats.write_seconds << "s, peak RSS "
+       << std::setprecision(1)
+       << static_cast<double>(stats.peak_rss_bytes) / (1024 * 1024)
+       << " MiB\n";
+  output_stream << line.str();
+}
+
+void OutputStatsJson(const std::vector<GenerationStats> &stats,
+                     std::ostream &output_stream) {
+  std::ostringstream json;
+  json << std::fixed << std::setprecision(6) << '[';
+  for (size_t i = 0; i < stats.size(); i++) {
+    const GenerationStats &header_stats = stats[i];
+    json << ((i == 0) ? "\n  {" : ",\n  {") << "\"output_filename\": ";
+    OutputJsonString(header_stats.output_filename, json);
+    json << ", \"identifier_name\": ";
+    OutputJsonString(header_stats.identifier_name, json);
+    json << ", \"mode\": ";
+    OutputJsonString(header_stats.mode, json);
+    json << ", \"input_bytes\": " << header_stats.input_bytes
+         << ", \"output_bytes\": " << header_stats.output_bytes
+         << ", \"expansion_ratio\": " << GetExpansionRatio(header_stats)
+         << ", \"read_seconds\": " << header_stats.read_seconds
+         << ", \"format_seconds\": " << header_stats.format_seconds
+         << ", \"write_seconds\": " << header_stats.write_seconds
+         << ", \"peak_rss_bytes\": " << header_stats.peak_rss_bytes << '}';
+  }
+  json << "\n]\n";
+  output_stream << json.str();
+}
+}  // namespace cpp11embed
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include "OutputSink.h"
+
+namespace cpp11embed {
+/**
+ * Measures the time since it was created
+ */
+class Stopwatch {
+ public:
+  Stopwatch() : start_(std::chrono::steady_clock::now()) {}
+
+  double GetSeconds() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         start_)
+        .count();
+  }
+
+ private:
+  std::chrono::steady_clock::time_point start_;
+};
+
+/**
+ * Passes everything on to another sink, keeping track of how much was
+ * written and how long it took
+ */
+class TimedOutputSink : public OutputSink {
+ public:
+  explicit TimedOutputSink(OutputSink &sink) : sink_(sink) {}
+
+  void Write(const char *data, size_t size) override;
+  bool HasFailed() const override { return sink_.HasFailed(); }
+
+  uint64_t GetBytesWritten() const { return bytes_written_; }
+  double GetSeconds() const { return seconds_; }
+
+ private:
+  OutputSink &sink_;
+  uint64_t bytes_written_ = 0;
+  double seconds_ = 0;
+};
+
+/**
+ * Reads from another stream buffer in blocks, keeping track of how much was
+ * read and how long it took. Seeking is passed on to the other buffer (so
+ * GetRemainingStreamSize still works).
+ */
+class TimedStreambuf : public std::streambuf {
+ public:
+  explicit TimedStreambuf(std::streambuf &source);
+
+  /**
+   * @returns the number of bytes that have been read through this buffer
+   */
+  uint64_t GetBytesRead() const;
+  double GetSeconds() const { return seconds_; }
+
+ protected:
+  int_type underflow() override;
+  pos_type seekoff(off_type offset, std::ios_base::seekdir direction,
+                   std::ios_base::openmode which) override;
+  pos_type seekpos(pos_type position, std::ios_base::openmode which) override;
+
+ private:
+  /**
+   * Forgets anything that has been read from the source but not from this
+   */
+  void DiscardBuffer();
+
+  std::streambuf &source_;
+  std::vector<char> buffer_;
+  // Including anything still in the buffer
+  uint64_t bytes_read_ = 0;
+  double seconds_ = 0;
+};
+
+/**
+ * What it took to generate a header (and anything generated alongside it)
+ */
+struct GenerationStats {
+  // Where the header was written, empty for standard output
+  std::string output_filename;
+  std::string identifier_name;
+  // How the data was embedded e.g. text or compressed-binary
+  std::string mode;
+  uint64_t input_bytes = 0;
+  // Including any files generated alongside the header
+  uint64_t output_bytes = 0;
+  // Opening or mapping the input and reading any of it that is streamed.
+  // Mapped inputs are paged in as they are formatted.
+  double read_seconds = 0;
+  // Everything apart from reading and writing
+  double format_seconds = 0;
+  // Writing the header (other files are written while formatting)
+  double write_seconds = 0;
+  // Of the whole process, so it covers everything generated so far
+  uint64_t peak_rss_bytes = 0;
+};
+
+/**
+ * @returns the most memory that the process has had resident at once, or 0
+ * if that can't be found out
+ */
+uint64_t GetPeakRss();
+
+/**
+ * @returns output bytes per input byte, or 0 when there was no input
+ */
+double GetExpansionRatio(const GenerationStats &stats);
+
+/**
+ * Writes the stats on one line for people to read
+ */
+void OutputStats(const GenerationStats &stats, std::ostream &output_stream);
+
+/**
+ * Writes the stats as a JSON array of objects (one per header) that have the
+ * same names as the fields of GenerationStats, along with expansion_ratio
+ */
+void OutputStatsJson(const std::vector<GenerationStats> &stats,
+                     std::ostream &output_stream);
+}  // namespace cpp11embed
@@ -0,0 +1,201 @@
+#include "Watch.h"
+
+#ifdef __linux__
+#include <dirent.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#endif
+
+namespace cpp11embed {
+#ifndef __linux__
+FileWatcher::FileWatcher() : inotify_file_descriptor_(-1) {}
+
+FileWatcher::~FileWatcher() = default;
+
+bool FileWatcher::AddFile(const std::string &) { return false; }
+
+bool FileWatcher::AddDirectory(const std::string &) { return false; }
+
+std::set<std::string> FileWatcher::WaitForChanges() { return {}; }
+#else
+namespace {
+// Every way that the contents of a directory (or the directory itself) can
+// change
+constexpr uint32_t k_watch_mask = IN_CLOSE_WRITE | IN_MODIFY | IN_ATTRIB |
+                                  IN_CREATE | IN_DELETE | IN_MOVED_FROM |
+                                  IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF |
+                                  IN_ONLYDIR;
+// Long enough for the writes of a single save to count as one change but
+// short enough not to be noticed
+constexpr int k_quiet_period_milliseconds = 20;
+
+/**
+ * @returns false if waiting failed
+ */
+bool WaitForEvents(const int inotify_file_descriptor,
+                   const int timeout_milliseconds, bool &ready) {
+  pollfd inotify_poll{inotify_file_descriptor, POLLIN, 0};
+  int result;
+  do {
+    result = poll(&inotify_poll, 1, timeout_milliseconds);
+  } while (result < 0 && errno == EINTR);
+  ready = result > 0;
+  return result >= 0;
+}
+}  // namespace
+
+FileWatcher::FileWatcher()
+    : inotify_file_descriptor_(inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) {}
+
+FileWatcher::~FileWatcher() {
+  if (inotify_file_descriptor_ >= 0) {
+    close(inotify_file_descriptor_);
+  }
+}
+
+bool FileWatcher::AddFile(const std::string &path) {
+  const size_t separator = path.find_last_of('/');
+  const std::string directory =
+      (separator == std::string::npos)
+          ? "."
+          : (separator == 0) ? "/" : path.substr(0, separator);
+  const std::string name =
+      (separator == std::string::npos) ? path : path.substr(separator + 1);
+  const int watch_descriptor = WatchDirectory(directory);
+  if (name.empty() || watch_descriptor < 0) {
+    return false;
+  }
+  directories_[watch_descriptor].files[name] = path;
+  return true;
+}
+
+bool FileWatcher::AddDirectory(const std::string &path) {
+  return AddDirectory(path, path);
+}
+
+int FileWatcher::WatchDirectory(const std::string &path) {
+  if (!IsValid()) {
+    return -1;
+  }
+  return inotify_add_watch(inotify_file_descriptor_, path.c_str(),
+                           k_watch_mask);
+}
+
+bool FileWatcher::AddDirectory(const std::string &path,
+                               const std::string &reported_path) {
+  const int watch_descriptor = WatchDirectory(path);
+  if (watch_descriptor < 0) {
+    return false;
+  }
+  WatchedDirectory &directory = directories_[watch_descriptor];
+  directory.path = path;
+  directory.reported_path = reported_path;
+
+  DIR *const directory_stream = opendir(path.c_str());
+  if (directory_stream == nullptr) {
+    return false;
+  }
+  bool succeeded = true;
+  while (const dirent *const entry = readdir(directory_stream)) {
+    const std::string name = entry->d_name;
+    if (name == "." || name == "..") {
+      continue;
+    }
+    const std::string subdirectory_path = path + "/" + name;
+    struct stat status;
+    // Symbolic links to directories aren't followed, just as when listing
+    // the files in the directory
+    if (lstat(subdirectory_path.c_str(), &status) == 0 &&
+        S_ISDIR(status.st_mode)) {
+      succeeded &= AddDirectory(subdirectory_path, reported_path);
+    }
+  }
+  closedir(directory_stream);
+  return succeeded;
+}
+
+bool FileWatcher::ReadEvents(std::set<std::string> &changed_paths) {
+  alignas(inotify_event) char buffer[64 * 1024];
+  while (true) {
+    const ssize_t size =
+        read(inotify_file_descriptor_, buffer, sizeof(buffer));
+    if (size < 0 && errno == EINTR) {
+      continue;
+    }
+    if (size < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      return true;
+    }
+    if (size <= 0) {
+      return false;
+    }
+    for (const char *next = buffer; next < buffer + size;) {
+      const inotify_event &event =
+          *reinterpret_cast<const inotify_event *>(next);
+      next += sizeof(inotify_event) + event.len;
+      if ((event.mask & IN_Q_OVERFLOW) != 0) {
+        // Some events were lost so anything could have changed
+        for (const auto &watched : directories_) {
+          if (!watched.second.reported_path.empty()) {
+            changed_paths.insert(watched.second.reported_path);
+          }
+          for (const auto &file : watched.second.files) {
+            changed_paths.insert(file.second);
+          }
+        }
+        continue;
+      }
+      const auto directory = directories_.find(event.wd);
+      if (directory == directories_.end()) {
+        continue;
+      }
+      // Copied as adding a subdirectory can invalidate the iterator
+      const std::string directory_path = directory->second.path;
+      const std::string reported_path = directory->second.reported_path;
+      const std::string name = (event.len > 0) ? event.name : "";
+      const auto file = directory->second.files.find(name);
+      if (file != directory->second.files.end()) {
+        changed_paths.insert(file->second);
+      } else if ((event.mask & (IN_DELETE_SELF | IN_MOVE_SELF)) != 0) {
+        // Every file in the directory has gone
+        for (const auto &watched_file : directory->second.files) {
+          changed_paths.insert(watched_file.second);
+        }
+      }
+      if (!reported_path.empty()) {
+        changed_paths.insert(reported_path);
+        if ((event.mask & IN_ISDIR) != 0 &&
+            (event.mask & (IN_CREATE | IN_MOVED_TO)) != 0) {
+          AddDirectory(directory_path + "/" + name, reported_path);
+        }
+      }
+      if ((event.mask & IN_IGNORED) != 0) {
+        // The directory has gone so the watch has been removed
+        directories_.erase(event.wd);
+      }
+    }
+  }
+}
+
+std::set<std::string> FileWatcher::WaitForChanges() {
+  std::set<std::string> changed_paths;
+  bool ready;
+  while (changed_paths.empty()) {
+    if (!WaitForEvents(inotify_file_descriptor_, -1, ready) ||
+        !ReadEvents(changed_paths)) {
+      return {};
+    }
+  }
+  // Until it has been quiet for a moment
+  while (WaitForEvents(inotify_file_descriptor_, k_quiet_period_milliseconds,
+                       ready) &&
+         ready && ReadEvents(changed_paths)) {
+  }
+  return changed_paths;
+}
+#endif
+}  // namespace cpp11embed
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <set>
+#include <string>
+#include <unordered_map>
+
+namespace cpp11embed {
+/**
+ * Waits for files and directories to change (with inotify, so only on
+ * Linux). Files are watched through the directory that they are in so that
+ * files replaced by renaming another file over them (as many editors save
+ * them) are still noticed.
+ */
+class FileWatcher {
+ public:
+  FileWatcher();
+  ~FileWatcher();
+
+  FileWatcher(const FileWatcher &) = delete;
+  FileWatcher &operator=(const FileWatcher &) = delete;
+
+  /**
+   * @returns false if files can't be watched on this system
+   */
+  bool IsValid() const { return inotify_file_descriptor_ >= 0; }
+
+  /**
+   * @returns false if the file's directory can't be watched
+   */
+  bool AddFile(const std::string &path);
+
+  /**
+   * Watches every file in the directory and its subdirectories, including
+   * ones that are added later
+   * @returns false if the directory (or any subdirectory) can't be watched
+   */
+  bool AddDirectory(const std::string &path);
+
+  /**
+   * Blocks until something that is being watched changes and then until
+   * nothing has changed for a few milliseconds, so that a burst of changes
+   * (e.g. a file being truncated and then written) is only reported once
+   * @returns the paths (as they were added) of the files and directories
+   * that changed, which is only empty if waiting failed
+   */
+  std::set<std::string> WaitForChanges();
+
+ private:
+  struct WatchedDirectory {
+    std::string path;
+    // Where changes to files in the directory are reported (as their path)
+    // if they are being watched
+    std::unordered_map<std::string, std::string> files;
+    // Changes to anything in the directory are reported as this path unless
+    // it is empty
+    std::string reported_path;
+  };
+
+  /**
+   * @returns the watch descriptor or -1 if the directory can't be watched
+   */
+  int WatchDirectory(const std::string &path);
+
+  bool AddDirectory(const std::string &path, const std::string &reported_path);
+
+  /**
+   * Reads the events that are ready (without blocking), adding the paths
+   * that changed
+   * @returns false if reading failed
+   */
+  bool ReadEvents(std::set<std::string> &changed_paths);
+
+  int inotify_file_descriptor_;
+  std::unordered_map<int, WatchedDirectory> directories_;
+};
+}  // namespace cpp11embed
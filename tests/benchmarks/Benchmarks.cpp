@@ -0,0 +1,585 @@
+// Measures how quickly each output mode is generated, how much memory the
+// tool needs to do it and how long the host compiler takes to compile the
+// results, for synthetic inputs of various kinds and sizes.
+
+// Standard library
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+// Platform (running child processes and measuring their memory use)
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+// 3rd party
+#include <args.hxx>
+
+// Project
+#include "ByteSpan.h"
+#include "ElfObject.h"
+#include "Lib.h"
+#include "OutputSink.h"
+
+namespace {
+enum class InputKind { k_random_bytes, k_printable_text, k_escape_heavy_text };
+enum class OutputMode {
+  k_text,
+  k_binary,
+  k_binary_string_literal,
+  k_elf_object
+};
+enum class OutputFormat { k_json, k_csv };
+
+struct Options {
+  size_t max_size = 1024 * 1024 * 1024;
+  // Compiling large headers takes minutes (or runs out of memory), so only
+  // the smaller ones are compiled unless asked otherwise
+  size_t max_compile_size = 1024 * 1024;
+  double min_seconds = 0.25;
+  OutputFormat format = OutputFormat::k_json;
+  // Empty for standard output
+  std::string output_filename;
+  std::string work_directory = ".";
+  std::string executable_path = CPP11_EMBED_BENCH_EXECUTABLE_PATH;
+  std::string compiler = CPP11_EMBED_BENCH_CXX_COMPILER;
+};
+
+// Negative values were not measured
+struct Result {
+  OutputMode mode;
+  InputKind input_kind;
+  size_t size;
+  double megabytes_per_second;
+  double tool_seconds = -1;
+  long long tool_peak_rss_bytes = -1;
+  double compile_seconds = -1;
+  long long compile_peak_rss_bytes = -1;
+};
+
+struct ProcessResult {
+  bool succeeded = false;
+  double seconds = 0;
+  // -1 if it can't be measured on this platform
+  long long peak_rss_bytes = -1;
+};
+
+constexpr size_t k_input_sizes[] = {1024, 32 * 1024, 1024 * 1024,
+                                    32 * 1024 * 1024, 1024 * 1024 * 1024};
+constexpr InputKind k_input_kinds[] = {InputKind::k_random_bytes,
+                                       InputKind::k_printable_text,
+                                       InputKind::k_escape_heavy_text};
+constexpr OutputMode k_output_modes[] = {
+    OutputMode::k_text, OutputMode::k_binary,
+    OutputMode::k_binary_string_literal, OutputMode::k_elf_object};
+
+constexpr char k_identifier_name[] = "bench_data";
+// None of these need escaping in a string literal
+constexpr char k_printable_characters[] =
+    "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789 .,;:!()";
+constexpr char k_characters_to_escape[] = "\n\t\r\"'?\\";
+
+const char *GetName(const InputKind input_kind) {
+  switch (input_kind) {
+    case InputKind::k_random_bytes:
+      return "random-bytes";
+    case InputKind::k_printable_text:
+      return "printable-text";
+    case InputKind::k_escape_heavy_text:
+      return "escape-heavy-text";
+  }
+  return "";
+}
+
+const char *GetName(const OutputMode mode) {
+  switch (mode) {
+    case OutputMode::k_text:
+      return "text";
+    case OutputMode::k_binary:
+      return "binary";
+    case OutputMode::k_binary_string_literal:
+      return "binary-string-literal";
+    case OutputMode::k_elf_object:
+      return "elf-object";
+  }
+  return "";
+}
+
+/**
+ * The same input is generated for the same kind and size every run so that
+ * results are comparable.
+ */
+std::vector<char> GenerateInput(const InputKind input_kind, const size_t size) {
+  std::mt19937_64 generator(size);
+  std::vector<char> input(size);
+  const size_t number_of_printable_characters =
+      sizeof(k_printable_characters) - 1;
+  const size_t number_of_characters_to_escape =
+      sizeof(k_characters_to_escape) - 1;
+  for (size_t i = 0; i < size;) {
+    uint64_t random_bits = generator();
+    switch (input_kind) {
+      case InputKind::k_random_bytes: {
+        const size_t bytes = std::min(sizeof(random_bits), size - i);
+        std::memcpy(input.data() + i, &random_bits, bytes);
+        i += bytes;
+        break;
+      }
+      case InputKind::k_printable_text:
+        input[i++] = k_printable_characters[random_bits %
+                                            number_of_printable_characters];
+        break;
+      case InputKind::k_escape_heavy_text: {
+        // Roughly half of the characters need escaping
+        const bool escape = random_bits & 1;
+        random_bits >>= 1;
+        input[i++] =
+            escape ? k_characters_to_escape[random_bits %
+                                            number_of_characters_to_escape]
+                   : k_printable_characters[random_bits %
+                                            number_of_printable_characters];
+        break;
+      }
+    }
+  }
+  return input;
+}
+
+/**
+ * Throws away everything written to it, only keeping count, so that the
+ * cost of writing the output doesn't hide the cost of generating it.
+ */
+class CountingSink : public cpp11embed::OutputSink {
+ public:
+  void Write(const char *, size_t size) override { bytes_written_ += size; }
+  bool HasFailed() const override { return false; }
+
+  uint64_t GetBytesWritten() const { return bytes_written_; }
+
+ private:
+  uint64_t bytes_written_ = 0;
+};
+
+class NullStreamBuffer : public std::streambuf {
+ protected:
+  int_type overflow(int_type c) override { return traits_type::not_eof(c); }
+  std::streamsize xsputn(const char *, std::streamsize size) override {
+    return size;
+  }
+};
+
+void GenerateOutput(const OutputMode mode, const cpp11embed::ByteSpan input,
+                    cpp11embed::OutputSink &sink,
+                    std::ostream &elf_object_stream) {
+  switch (mode) {
+    case OutputMode::k_text:
+      cpp11embed::OutputEscapedStringLiteralHeader(k_identifier_name, false,
+                                                   input, sink);
+      break;
+    case OutputMode::k_binary:
+      cpp11embed::OutputBinaryDataHeader(k_identifier_name, false, input,
+                                         sink);
+      break;
+    case OutputMode::k_binary_string_literal:
+      cpp11embed::OutputBinaryStringLiteralHeader(k_identifier_name, false,
+                                                  input, sink);
+      break;
+    case OutputMode::k_elf_object:
+      cpp11embed::OutputExternBinaryDataHeader(k_identifier_name, false,
+                                               input.size, sink);
+      cpp11embed::OutputElfObject(k_identifier_name,
+                                  cpp11embed::GetHostElfMachine(), 16, input,
+                                  elf_object_stream);
+      break;
+  }
+}
+
+/**
+ * Generates the output in process as many times as fits in min_seconds (and
+ * at least once).
+ * @returns the number of megabytes (10^6 bytes) of input handled per second
+ */
+double MeasureThroughput(const OutputMode mode,
+                         const cpp11embed::ByteSpan input,
+                         const double min_seconds) {
+  NullStreamBuffer null_stream_buffer;
+  std::ostream null_stream(&null_stream_buffer);
+  CountingSink sink;
+
+  const auto start = std::chrono::steady_clock::now();
+  size_t iterations = 0;
+  double seconds = 0;
+  do {
+    GenerateOutput(mode, input, sink, null_stream);
+    iterations++;
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                            start)
+                  .count();
+  } while (seconds < min_seconds);
+  return static_cast<double>(input.size) * iterations / seconds / 1e6;
+}
+
+/**
+ * Runs a program to completion with its output discarded.
+ * @param arguments the program followed by its arguments
+ */
+ProcessResult RunProcess(const std::vector<std::string> &arguments) {
+  ProcessResult result;
+  const auto start = std::chrono::steady_clock::now();
+#ifdef _WIN32
+  std::string command;
+  for (const std::string &argument : arguments) {
+    command += '"' + argument + "\" ";
+  }
+  // cmd.exe strips the outer quotes
+  const int exit_code =
+      std::system(('"' + command + "> NUL 2>&1\"").c_str());
+  result.succeeded = exit_code == 0;
+#else
+  std::vector<char *> argv;
+  for (const std::string &argument : arguments) {
+    argv.push_back(const_cast<char *>(argument.c_str()));
+  }
+  argv.push_back(nullptr);
+
+  const pid_t pid = fork();
+  if (pid == -1) {
+    return result;
+  }
+  if (pid == 0) {
+    const int null_file_descriptor = open("/dev/null", O_WRONLY);
+    if (null_file_descriptor != -1) {
+      dup2(null_file_descriptor, 1);
+      dup2(null_file_descriptor, 2);
+    }
+    execvp(argv[0], argv.data());
+    _exit(127);
+  }
+
+  int status = 0;
+  struct rusage usage;
+  if (wait4(pid, &status, 0, &usage) == -1) {
+    return result;
+  }
+  result.succeeded = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+#ifdef __APPLE__
+  result.peak_rss_bytes = usage.ru_maxrss;
+#else
+  // Kilobytes everywhere else
+  result.peak_rss_bytes = static_cast<long long>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+  result.seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+          .count();
+  return result;
+}
+
+std::vector<std::string> GetToolArguments(const Options &options,
+                                          const OutputMode mode,
+                                          const std::string &input_filename,
+                                          const std::string &header_filename,
+                                          const std::string &object_filename) {
+  std::vector<std::string> arguments = {options.executable_path,
+                                        input_filename, k_identifier_name,
+                                        "-o", header_filename};
+  switch (mode) {
+    case OutputMode::k_text:
+      break;
+    case OutputMode::k_binary:
+      arguments.push_back("-b");
+      break;
+    case OutputMode::k_binary_string_literal:
+      arguments.push_back("-s");
+      break;
+    case OutputMode::k_elf_object:
+      arguments.push_back("--elf-object");
+      arguments.push_back(object_filename);
+      break;
+  }
+  return arguments;
+}
+
+std::vector<std::string> GetCompileArguments(
+    const Options &options, const std::string &source_filename,
+    const std::string &object_filename) {
+#if CPP11_EMBED_BENCH_COMPILER_IS_MSVC
+  return {options.compiler, "/nologo", "/c", source_filename,
+          "/Fo" + object_filename};
+#else
+  return {options.compiler, "-std=c++11", "-c", source_filename, "-o",
+          object_filename};
+#endif
+}
+
+bool WriteFile(const std::string &filename, const cpp11embed::ByteSpan data) {
+  std::ofstream file(filename, std::ios::binary);
+  file.write(data.data, data.size);
+  return static_cast<bool>(file);
+}
+
+/**
+ * Runs the tool on the input (measuring its peak memory use) and then
+ * compiles the header it generated, if the input is small enough.
+ * @returns false if either failed
+ */
+bool MeasureTool(const Options &options, const std::vector<char> &input,
+                 Result &result) {
+  const std::string prefix = options.work_directory + "/Cpp11EmbedBench";
+  const std::string input_filename = prefix + "Input.bin";
+  const std::string header_filename = prefix + ".h";
+  const std::string object_filename = prefix + "Data.o";
+  const std::string source_filename = prefix + ".cpp";
+  const std::string compiled_filename = prefix + ".o";
+
+  if (!WriteFile(input_filename, {input.data(), input.size()})) {
+    std::cerr << "Unable to write " << input_filename << "\n";
+    return false;
+  }
+  const ProcessResult tool_result =
+      RunProcess(GetToolArguments(options, result.mode, input_filename,
+                                  header_filename, object_filename));
+  bool succeeded = tool_result.succeeded;
+  if (!tool_result.succeeded) {
+    std::cerr << "Running " << options.executable_path << " failed for "
+              << GetName(result.mode) << " " << GetName(result.input_kind)
+              << " " << result.size << "\n";
+  } else {
+    result.tool_seconds = tool_result.seconds;
+    result.tool_peak_rss_bytes = tool_result.peak_rss_bytes;
+
+    if (result.size <= options.max_compile_size) {
+      const std::string source =
+          "#include \"Cpp11EmbedBench.h\"\n"
+          "const void *Cpp11EmbedBenchData() { return &" +
+          std::string(k_identifier_name) + "; }\n";
+      WriteFile(source_filename, {source.data(), source.size()});
+      const ProcessResult compile_result = RunProcess(
+          GetCompileArguments(options, source_filename, compiled_filename));
+      if (compile_result.succeeded) {
+        result.compile_seconds = compile_result.seconds;
+        result.compile_peak_rss_bytes = compile_result.peak_rss_bytes;
+      } else {
+        succeeded = false;
+        std::cerr << "Compiling the " << GetName(result.mode)
+                  << " header failed for " << GetName(result.input_kind)
+                  << " " << result.size << "\n";
+      }
+    }
+  }
+
+  for (const std::string &filename :
+       {input_filename, header_filename, object_filename, source_filename,
+        compiled_filename}) {
+    std::remove(filename.c_str());
+  }
+  return succeeded;
+}
+
+template <typename Number>
+void OutputValue(const Number value, const char *missing_value,
+                 std::ostream &output_stream) {
+  if (value < 0) {
+    output_stream << missing_value;
+  } else {
+    output_stream << value;
+  }
+}
+
+void OutputCsv(const std::vector<Result> &results,
+               std::ostream &output_stream) {
+  output_stream << "mode,input,size_bytes,megabytes_per_second,tool_seconds,"
+                   "tool_peak_rss_bytes,compile_seconds,"
+                   "compile_peak_rss_bytes\n";
+  for (const Result &result : results) {
+    output_stream << GetName(result.mode) << ','
+                  << GetName(result.input_kind) << ',' << result.size << ','
+                  << result.megabytes_per_second << ',';
+    OutputValue(result.tool_seconds, "", output_stream);
+    output_stream << ',';
+    OutputValue(result.tool_peak_rss_bytes, "", output_stream);
+    output_stream << ',';
+    OutputValue(result.compile_seconds, "", output_stream);
+    output_stream << ',';
+    OutputValue(result.compile_peak_rss_bytes, "", output_stream);
+    output_stream << '\n';
+  }
+}
+
+void OutputJson(const std::vector<Result> &results,
+                std::ostream &output_stream) {
+  output_stream << "[\n";
+  for (size_t i = 0; i < results.size(); i++) {
+    const Result &result = results[i];
+    output_stream << "  {\"mode\": \"" << GetName(result.mode)
+                  << "\", \"input\": \"" << GetName(result.input_kind)
+                  << "\", \"size_bytes\": " << result.size
+                  << ", \"megabytes_per_second\": "
+                  << result.megabytes_per_second << ", \"tool_seconds\": ";
+    OutputValue(result.tool_seconds, "null", output_stream);
+    output_stream << ", \"tool_peak_rss_bytes\": ";
+    OutputValue(result.tool_peak_rss_bytes, "null", output_stream);
+    output_stream << ", \"compile_seconds\": ";
+    OutputValue(result.compile_seconds, "null", output_stream);
+    output_stream << ", \"compile_peak_rss_bytes\": ";
+    OutputValue(result.compile_peak_rss_bytes, "null", output_stream);
+    output_stream << (i + 1 < results.size() ? "},\n" : "}\n");
+  }
+  output_stream << "]\n";
+}
+
+enum class ParseResult { k_success, k_help, k_failure };
+
+ParseResult ParseOptions(const int argc, const char *const argv[],
+                         Options &options) {
+  args::ArgumentParser parser(
+      "CPP11 Embed benchmarks",
+      "Reports the throughput of each output mode, the peak memory use of "
+      "the tool and how long the generated headers take to compile");
+  args::HelpFlag help(parser, "help", "Display this help menu", {'h', "help"});
+  args::ValueFlag<size_t> max_size(
+      parser, "max_size",
+      "The largest input size in bytes (inputs go from 1 KiB up to 1 GiB, "
+      "the default)",
+      {"max-size"});
+  args::ValueFlag<size_t> max_compile_size(
+      parser, "max_compile_size",
+      "Only compile headers for inputs up to this size in bytes (defaults to "
+      "1 MiB)",
+      {"max-compile-size"});
+  args::ValueFlag<double> min_seconds(
+      parser, "min_seconds",
+      "Repeat each throughput measurement for at least this long (defaults "
+      "to 0.25)",
+      {"min-seconds"});
+  args::ValueFlag<std::string> format(
+      parser, "format", "The format of the results: json (default) or csv",
+      {"format"});
+  args::ValueFlag<std::string> output_filename(
+      parser, "output",
+      "Write the results to a file instead of standard output",
+      {'o', "output"});
+  args::ValueFlag<std::string> work_directory(
+      parser, "work_directory",
+      "Where to write the temporary files (defaults to the current directory)",
+      {"work-directory"});
+  args::ValueFlag<std::string> executable_path(
+      parser, "cpp11_embed_path", "The Cpp11Embed executable to measure",
+      {"cpp11-embed-path"});
+  args::ValueFlag<std::string> compiler(
+      parser, "compiler", "The compiler to compile the generated headers with",
+      {"compiler"});
+
+  try {
+    parser.ParseCLI(argc, argv);
+  } catch (args::Help &) {
+    std::cout << parser;
+    return ParseResult::k_help;
+  } catch (args::ParseError &e) {
+    std::cerr << e.what() << std::endl;
+    std::cerr << parser;
+    return ParseResult::k_failure;
+  } catch (args::ValidationError &e) {
+    std::cerr << e.what() << std::endl;
+    std::cerr << parser;
+    return ParseResult::k_failure;
+  }
+
+  if (max_size) {
+    options.max_size = args::get(max_size);
+  }
+  if (max_compile_size) {
+    options.max_compile_size = args::get(max_compile_size);
+  }
+  if (min_seconds) {
+    options.min_seconds = args::get(min_seconds);
+  }
+  if (format) {
+    if (args::get(format) == "json") {
+      options.format = OutputFormat::k_json;
+    } else if (args::get(format) == "csv") {
+      options.format = OutputFormat::k_csv;
+    } else {
+      std::cerr << "Unsupported format: " << args::get(format) << "\n";
+      return ParseResult::k_failure;
+    }
+  }
+  options.output_filename = args::get(output_filename);
+  if (work_directory) {
+    options.work_directory = args::get(work_directory);
+  }
+  if (executable_path) {
+    options.executable_path = args::get(executable_path);
+  }
+  if (compiler) {
+    options.compiler = args::get(compiler);
+  }
+  return ParseResult::k_success;
+}
+}  // namespace
+
+int main(const int argc, char *argv[]) {
+  Options options;
+  switch (ParseOptions(argc, argv, options)) {
+    case ParseResult::k_help:
+      return EXIT_SUCCESS;
+    case ParseResult::k_failure:
+      return EXIT_FAILURE;
+    case ParseResult::k_success:
+      break;
+  }
+
+  std::vector<Result> results;
+  bool all_succeeded = true;
+  for (const size_t size : k_input_sizes) {
+    if (size > options.max_size) {
+      break;
+    }
+    for (const InputKind input_kind : k_input_kinds) {
+      const std::vector<char> input = GenerateInput(input_kind, size);
+      for (const OutputMode mode : k_output_modes) {
+        // Text mode is only meant for text
+        if (mode == OutputMode::k_text &&
+            input_kind == InputKind::k_random_bytes) {
+          continue;
+        }
+        Result result{mode, input_kind, size,
+                      MeasureThroughput(mode, {input.data(), input.size()},
+                                        options.min_seconds)};
+        all_succeeded &= MeasureTool(options, input, result);
+        results.push_back(result);
+      }
+    }
+  }
+
+  std::ofstream output_file;
+  if (!options.output_filename.empty()) {
+    output_file.open(options.output_filename);
+  }
+  std::ostream &output_stream =
+      options.output_filename.empty() ? std::cout : output_file;
+  if (options.format == OutputFormat::k_json) {
+    OutputJson(results, output_stream);
+  } else {
+    OutputCsv(results, output_stream);
+  }
+  if (!output_stream) {
+    std::cerr << "Unable to write the results\n";
+    return EXIT_FAILURE;
+  }
+  return all_succeeded ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -140,3 +140,86 @@ def test_successful_binary_stdin_output_to_file(
     ), "Correct header written to file"
     assert result.stderr == "", "No errors reported"
     assert result.returncode == 0, "No errors reported"
+
+
+@pytest.mark.parametrize("from_stdin", (True, False))
+@pytest.mark.parametrize(
+    "layout_arguments,expected_declaration",
+    (
+        (
+            ("--word-size", "4"),
+            "// Little endian 4 byte words, the last padded with zeros\n"
+            "constexpr std::array<uint32_t, 2> id{0x64636261, 0x00006665};",
+        ),
+        (
+            ("--word-size", "2", "--endianness", "big", "--alignment", "64"),
+            "// Big endian 2 byte words, the last padded with zeros\n"
+            "alignas(64) constexpr std::array<uint16_t, 3> id{0x6162, 0x6364, "
+            "0x6566};",
+        ),
+        (
+            ("--word-size", "8", "--endianness", "little"),
+            "// Little endian 8 byte words, the last padded with zeros\n"
+            "constexpr std::array<uint64_t, 1> id{0x0000666564636261};",
+        ),
+    ),
+)
+def test_word_layouts(from_stdin: bool, layout_arguments, expected_declaration: str):
+    """Test that binary data can be packed into wider words, with the size of
+    the data in bytes alongside them"""
+    input_path = TEST_FILES_DIR / "one_line.txt"
+    result = run_cpp11_embed(
+        "-" if from_stdin else input_path,
+        "id",
+        False,
+        other_arguments=("-b",) + layout_arguments,
+        standard_input=input_path.read_text() if from_stdin else None,
+    )
+    assert result.stdout == (
+        "#pragma once\n\n#include <array>\n#include <cstddef>\n#include <cstdint>\n\n"
+        f"{expected_declaration}\nconstexpr std::size_t id_size = 6;\n"
+    )
+    assert result.stderr == "", "No errors reported"
+    assert result.returncode == 0, "No errors reported"
+
+
+def test_alignment():
+    """Test that binary data can be given more than byte alignment"""
+    result = run_cpp11_embed(
+        TEST_FILES_DIR / "one_line.txt",
+        "id",
+        False,
+        other_arguments=("-b", "--alignment", "32"),
+    )
+    assert result.stdout == _get_expected_binary_data_header(
+        "id", False, "{97, 98, 99, 100, 101, 102}", 6
+    ).replace("constexpr", "alignas(32) constexpr")
+    assert result.stderr == "", "No errors reported"
+    assert result.returncode == 0, "No errors reported"
+
+
+@pytest.mark.parametrize(
+    "arguments,expected_error",
+    (
+        (("-b", "--word-size", "3"), "Word size must be 1, 2, 4 or 8\n"),
+        (("-b", "--endianness", "middle"), "Unsupported endianness: middle\n"),
+        (
+            ("--word-size", "4"),
+            "--word-size and --endianness require -b and can't be used with -s, "
+            "--compress, --incbin, --elf-object or --definition\n",
+        ),
+        (
+            ("-b", "--compress", "--endianness", "big"),
+            "--word-size and --endianness require -b and can't be used with -s, "
+            "--compress, --incbin, --elf-object or --definition\n",
+        ),
+    ),
+)
+def test_invalid_word_layouts(arguments, expected_error: str):
+    """Test that layouts that can't be used are rejected"""
+    result = run_cpp11_embed(
+        TEST_FILES_DIR / "one_line.txt", "id", False, other_arguments=arguments
+    )
+    assert result.stdout == "", "Nothing written to standard output"
+    assert result.stderr == expected_error
+    assert result.returncode != 0, "Error reported"
@@ -0,0 +1,73 @@
+"""Tests to ensure that a valid header file can be generated from binary data
+stored in a string literal"""
+
+from pathlib import Path
+
+import pytest
+
+from .utilities import OUTPUT_TO_FILE_FLAGS, run_cpp11_embed, TEST_FILES_DIR
+
+
+def _get_expected_binary_string_literal_header(
+    identifier_name: str, use_header_guard: bool, expected_data: str
+) -> str:
+    contents = (
+        f"#include <cstddef>\n\nconstexpr unsigned char {identifier_name}[] =\n"
+        f"    {expected_data};\nconstexpr std::size_t {identifier_name}_size = "
+        f"sizeof({identifier_name}) - 1;\n"
+    )
+    if use_header_guard:
+        header_guard = identifier_name.upper()
+        return f"#ifndef {header_guard}\n#define {header_guard}\n\n{contents}\n#endif\n"
+    return f"#pragma once\n\n{contents}"
+
+
+@pytest.mark.parametrize("identifier_name", ("test_name", "other_name"))
+@pytest.mark.parametrize("use_header_guard", (True, False))
+@pytest.mark.parametrize(
+    "binary_string_literal_flag", ("--binary-string-literal", "-s")
+)
+def test_successful_binary_string_literal_file_input_output_to_stdout(
+    identifier_name: str, use_header_guard: bool, binary_string_literal_flag: str
+):
+    """Test that a binary file can be read successfully and the correct header
+    is generated and printed to standard output.
+
+    Also makes sure that the return code is 0 and nothing is written to
+    standard error.
+    """
+    result = run_cpp11_embed(
+        TEST_FILES_DIR / "tabs.txt",
+        identifier_name,
+        use_header_guard,
+        other_arguments=(binary_string_literal_flag,),
+    )
+    assert result.stdout == _get_expected_binary_string_literal_header(
+        identifier_name, use_header_guard, '"a\\tb\\tcde\\tfg"'
+    )
+    assert result.stderr == "", "No errors reported"
+    assert result.returncode == 0, "No errors reported"
+
+
+@pytest.mark.parametrize("output_to_file_flag", OUTPUT_TO_FILE_FLAGS)
+def test_successful_binary_string_literal_stdin_output_to_file(
+    output_to_file_flag: str, tmp_path: Path
+):
+    """Test that binary data containing nulls and bytes that are not valid
+    characters can be read from standard input and the correct header is
+    written to a file.
+    """
+    output_file_path = tmp_path / "out.h"
+    result = run_cpp11_embed(
+        "-",
+        "identifier",
+        False,
+        other_arguments=("-s", output_to_file_flag, output_file_path),
+        standard_input="a\0b\x1b",
+    )
+    assert result.stdout == "", "Nothing written to standard output"
+    assert output_file_path.read_text() == _get_expected_binary_string_literal_header(
+        "identifier", False, '"a\\000b\\033"'
+    ), "Correct header written to file"
+    assert result.stderr == "", "No errors reported"
+    assert result.returncode == 0, "No errors reported"
@@ -0,0 +1,64 @@
+"""Tests to ensure that compressed headers with a decompressor can be
+generated"""
+
+from pathlib import Path
+
+import pytest
+
+from .utilities import run_cpp11_embed, TEST_FILES_DIR
+
+
+@pytest.mark.parametrize(
+    "mode_flags, element_type",
+    ((tuple(), "char"), (("-b",), "unsigned char"), (("-s",), "unsigned char")),
+)
+def test_successful_compress(mode_flags, element_type):
+    """The header should hold the original size, the compressed data and the
+    accessors, whose type depends on whether the input is text.
+
+    Also makes sure that the return code is 0 and nothing is written to
+    standard error.
+    """
+    result = run_cpp11_embed(
+        TEST_FILES_DIR / "repetitive.txt",
+        "identifier",
+        False,
+        other_arguments=("--compress",) + mode_flags,
+    )
+    input_size = (TEST_FILES_DIR / "repetitive.txt").stat().st_size
+    assert result.stdout.startswith("#pragma once\n")
+    assert f"constexpr std::size_t identifier_size = {input_size};\n" in result.stdout
+    assert "constexpr unsigned char identifier_compressed[] =" in result.stdout
+    assert "inline bool identifier_decompress(void *buffer) {" in result.stdout
+    assert f"inline const {element_type} *identifier() {{" in result.stdout
+    assert len(result.stdout) < input_size, "Output is smaller than the input"
+    assert result.stderr == "", "No errors reported"
+    assert result.returncode == 0, "No errors reported"
+
+
+def test_compress_from_standard_input():
+    """The whole of standard input is read before compressing it"""
+    result = run_cpp11_embed(
+        "-",
+        "identifier",
+        False,
+        other_arguments=("--compress",),
+        standard_input="abc" * 100,
+    )
+    assert "constexpr std::size_t identifier_size = 300;\n" in result.stdout
+    assert result.stderr == "", "No errors reported"
+    assert result.returncode == 0, "No errors reported"
+
+
+@pytest.mark.parametrize("output_flag", ("--incbin", "--elf-object"))
+def test_compress_with_external_data_not_allowed(output_flag: str, tmp_path: Path):
+    """Data defined outside of the header can't be compressed"""
+    result = run_cpp11_embed(
+        TEST_FILES_DIR / "one_line.txt",
+        "identifier",
+        False,
+        other_arguments=("--compress", output_flag, tmp_path / "out"),
+    )
+    assert result.stdout == ""
+    assert result.stderr != "", "Error reported"
+    assert result.returncode != 0, "Error reported"
@@ -0,0 +1,113 @@
+"""Tests to ensure that the data can be defined in C++ source files with a
+header that only declares it"""
+
+from pathlib import Path
+
+import pytest
+
+from .utilities import run_cpp11_embed, TEST_FILES_DIR
+
+
+def test_successful_definition(tmp_path: Path):
+    """The source file should include the header and define the data that
+    it declares.
+
+    Also makes sure that the return code is 0 and nothing is written to
+    standard error.
+    """
+    (tmp_path / "src").mkdir()
+    header_path = tmp_path / "out.h"
+    definition_path = tmp_path / "src" / "out.cpp"
+    result = run_cpp11_embed(
+        TEST_FILES_DIR / "one_line.txt",
+        "identifier",
+        False,
+        other_arguments=("-o", header_path, "--definition", definition_path),
+    )
+    assert header_path.read_text() == (
+        "#pragma once\n\n#include <cstddef>\n\n"
+        "constexpr std::size_t identifier_size = 6;\n"
+        "extern const char identifier[7];\n"
+    )
+    assert definition_path.read_text() == (
+        '#include "../out.h"\n\nconst char identifier[7] = "abcdef";\n'
+    )
+    assert result.stderr == "", "No errors reported"
+    assert result.returncode == 0, "No errors reported"
+
+
+def test_successful_sharded_definition(tmp_path: Path):
+    """Each shard should be written to its own source file"""
+    header_path = tmp_path / "out.h"
+    result = run_cpp11_embed(
+        TEST_FILES_DIR / "one_line.txt",
+        "identifier",
+        False,
+        other_arguments=(
+            "-o",
+            header_path,
+            "--definition",
+            tmp_path / "out.cpp",
+            "--shards",
+            "4",
+            "-s",
+        ),
+    )
+    assert "constexpr std::size_t identifier_shard_size = 2;\n" in (
+        header_path.read_text()
+    )
+    for shard, contents in enumerate(("ab", "cd", "ef", "")):
+        assert (tmp_path / f"out_{shard}.cpp").read_text() == (
+            '#include "out.h"\n\n'
+            f"const unsigned char identifier_shard_{shard}[{len(contents) + 1}]"
+            f' =\n    "{contents}";\n'
+        )
+    assert not (tmp_path / "out.cpp").exists()
+    assert result.stderr == "", "No errors reported"
+    assert result.returncode == 0, "No errors reported"
+
+
+@pytest.mark.parametrize(
+    "other_arguments",
+    (
+        ("--compress",),
+        ("--incbin", "out.S"),
+        ("--shards", "0"),
+    ),
+)
+def test_definition_incompatible_options(tmp_path: Path, other_arguments):
+    """The data can only be defined in one place"""
+    result = run_cpp11_embed(
+        TEST_FILES_DIR / "one_line.txt",
+        "identifier",
+        False,
+        other_arguments=(
+            "-o",
+            tmp_path / "out.h",
+            "--definition",
+            tmp_path / "out.cpp",
+        )
+        + other_arguments,
+    )
+    assert result.stderr != "", "Error reported"
+    assert result.returncode != 0, "Error reported"
+
+
+@pytest.mark.parametrize("other_arguments", (tuple(), ("--shards", "2")))
+def test_definition_requirements(tmp_path: Path, other_arguments):
+    """--definition needs an output file to include and --shards needs
+    --definition"""
+    arguments = (
+        ("--definition", tmp_path / "out.cpp")
+        if not other_arguments
+        else ("-o", tmp_path / "out.h") + other_arguments
+    )
+    result = run_cpp11_embed(
+        TEST_FILES_DIR / "one_line.txt",
+        "identifier",
+        False,
+        other_arguments=arguments,
+    )
+    assert result.stdout == ""
+    assert result.stderr != "", "Error reported"
+    assert result.returncode != 0, "Error reported"
@@ -0,0 +1,81 @@
+"""Tests to ensure that every file in a directory can be embedded in one
+header with an index to look them up"""
+
+from pathlib import Path
+
+import pytest
+
+from .utilities import run_cpp11_embed, TEST_FILES_DIR
+
+
+def test_successful_directory():
+    """Every file should be listed with its path relative to the directory.
+
+    Also makes sure that the return code is 0 and nothing is written to
+    standard error.
+    """
+    result = run_cpp11_embed(
+        TEST_FILES_DIR / "directory",
+        "assets",
+        False,
+        other_arguments=("--directory",),
+    )
+    assert result.stdout.startswith("#pragma once\n")
+    assert "namespace assets {\n" in result.stdout
+    assert "alignas(16) constexpr unsigned char blob[] =" in result.stdout
+    assert "constexpr std::size_t number_of_entries = 5;\n" in result.stdout
+    # nested/hello_copy.txt has the same contents as hello.txt
+    assert "constexpr std::size_t deduplicated_bytes = 5;\n" in result.stdout
+    for path, size in (
+        ("hello.txt", 5),
+        ("nested/deeper/empty.bin", 0),
+        ("nested/file with spaces.txt", 11),
+        ("nested/hello_copy.txt", 5),
+        ("nested/world.txt", 6),
+    ):
+        assert f'{{"{path}", {len(path)}, blob + ' in result.stdout
+        assert f", {size}}},\n" in result.stdout
+    assert "inline const Entry *find(const char *path) {" in result.stdout
+    assert result.stdout.endswith("}  // namespace assets\n")
+    assert result.stderr == "", "No errors reported"
+    assert result.returncode == 0, "No errors reported"
+
+
+def test_directory_depfile(tmp_path: Path):
+    """The depfile should list every file in the directory"""
+    output_path = tmp_path / "out.h"
+    depfile_path = tmp_path / "out.d"
+    result = run_cpp11_embed(
+        TEST_FILES_DIR / "directory",
+        "assets",
+        False,
+        other_arguments=("--directory", "-o", output_path, "--depfile", depfile_path),
+    )
+    assert result.returncode == 0, "No errors reported"
+    depfile = depfile_path.read_text()
+    assert "nested/world.txt" in depfile
+    assert "nested/deeper/empty.bin" in depfile
+
+
+def test_empty_directory(tmp_path: Path):
+    """There has to be at least one file to embed"""
+    result = run_cpp11_embed(tmp_path, "assets", False, other_arguments=("--directory",))
+    assert result.stdout == ""
+    assert result.stderr != "", "Error reported"
+    assert result.returncode != 0, "Error reported"
+
+
+@pytest.mark.parametrize(
+    "other_arguments", (("-b",), ("-s",), ("--compress",), ("--incbin", "out.S"))
+)
+def test_directory_incompatible_options(other_arguments):
+    """Options for a single file can't be used with a directory"""
+    result = run_cpp11_embed(
+        TEST_FILES_DIR / "directory",
+        "assets",
+        False,
+        other_arguments=("--directory",) + other_arguments,
+    )
+    assert result.stdout == ""
+    assert result.stderr != "", "Error reported"
+    assert result.returncode != 0, "Error reported"
@@ -0,0 +1,116 @@
+"""Tests to ensure that an ELF object file and a header that declares the
+data in it can be generated"""
+
+from pathlib import Path
+
+import pytest
+
+from .utilities import run_cpp11_embed, TEST_FILES_DIR
+
+_EXPECTED_HEADER = (
+    "#pragma once\n\n#include <cstddef>\n#include <cstdint>\n\n"
+    'extern "C" const uint8_t identifier[6];\n'
+    'extern "C" const std::size_t identifier_size;\n'
+)
+
+
+@pytest.mark.parametrize(
+    "elf_machine, expected_machine_code",
+    (("x86-64", b"\x3e\x00"), ("aarch64", b"\xb7\x00")),
+)
+def test_successful_elf_object(
+    elf_machine: str, expected_machine_code: bytes, tmp_path: Path
+):
+    """Test that an object file for the requested machine containing the data
+    is written and that the header declares the data.
+
+    Also makes sure that the return code is 0 and nothing is written to
+    standard error.
+    """
+    object_file_path = tmp_path / "out.o"
+    result = run_cpp11_embed(
+        TEST_FILES_DIR / "one_line.txt",
+        "identifier",
+        False,
+        other_arguments=(
+            "--elf-object",
+            object_file_path,
+            "--elf-machine",
+            elf_machine,
+        ),
+    )
+    assert result.stdout == _EXPECTED_HEADER
+    elf_object = object_file_path.read_bytes()
+    assert elf_object[:4] == b"\x7fELF"
+    assert elf_object[0x12:0x14] == expected_machine_code
+    assert b"abcdef" in elf_object
+    assert result.stderr == "", "No errors reported"
+    assert result.returncode == 0, "No errors reported"
+
+
+def test_elf_object_from_standard_input(tmp_path: Path):
+    """Standard input can't be seeked so has to be buffered to find its size"""
+    object_file_path = tmp_path / "out.o"
+    result = run_cpp11_embed(
+        "-",
+        "identifier",
+        False,
+        other_arguments=("--elf-object", object_file_path),
+        standard_input="abcdef",
+    )
+    assert result.stdout == _EXPECTED_HEADER
+    assert b"abcdef" in object_file_path.read_bytes()
+    assert result.returncode == 0, "No errors reported"
+
+
+@pytest.mark.parametrize("alignment", ("0", "3", "24"))
+def test_elf_object_alignment_must_be_power_of_two(alignment: str, tmp_path: Path):
+    """Invalid alignments are rejected"""
+    result = run_cpp11_embed(
+        TEST_FILES_DIR / "one_line.txt",
+        "identifier",
+        False,
+        other_arguments=(
+            "--elf-object",
+            tmp_path / "out.o",
+            "--alignment",
+            alignment,
+        ),
+    )
+    assert result.stderr != "", "Error reported"
+    assert result.returncode != 0, "Error reported"
+
+
+def test_elf_object_with_incbin(tmp_path: Path):
+    """The data can only be defined in one place"""
+    result = run_cpp11_embed(
+        TEST_FILES_DIR / "one_line.txt",
+        "identifier",
+        False,
+        other_arguments=(
+            "--elf-object",
+            tmp_path / "out.o",
+            "--incbin",
+            tmp_path / "out.s",
+        ),
+    )
+    assert "--incbin can't be used with --elf-object" in result.stderr
+    assert result.returncode != 0, "Error reported"
+    assert not (tmp_path / "out.o").exists()
+    assert not (tmp_path / "out.s").exists()
+
+
+@pytest.mark.skipif(not Path("/dev/full").exists(), reason="Needs /dev/full")
+@pytest.mark.parametrize("standard_input", (None, "abcdef"))
+def test_elf_object_write_failure(standard_input):
+    """An object file that couldn't be written is an error rather than being
+    left incomplete"""
+    result = run_cpp11_embed(
+        "-" if standard_input else TEST_FILES_DIR / "one_line.txt",
+        "identifier",
+        False,
+        other_arguments=("--elf-object", "/dev/full"),
+        standard_input=standard_input,
+    )
+    assert "Unable to write object output file" in result.stderr
+    assert result.returncode != 0, "Error reported"
@@ -0,0 +1,62 @@
+"""Tests to ensure that an assembly file and a header that declares the data
+in it can be generated"""
+
+from pathlib import Path
+
+import pytest
+
+from .utilities import run_cpp11_embed, TEST_FILES_DIR
+
+
+def test_successful_incbin(tmp_path: Path):
+    """Test that the assembly file embeds the absolute path of the input and
+    that the header declares the data.
+
+    Also makes sure that the return code is 0 and nothing is written to
+    standard error.
+    """
+    assembly_file_path = tmp_path / "out.S"
+    result = run_cpp11_embed(
+        TEST_FILES_DIR / "one_line.txt",
+        "identifier",
+        False,
+        other_arguments=("--incbin", assembly_file_path),
+    )
+    assert result.stdout == (
+        "#pragma once\n\n#include <cstddef>\n#include <cstdint>\n\n"
+        'extern "C" const uint8_t identifier[6];\n'
+        'extern "C" const std::size_t identifier_size;\n'
+    )
+    input_path = (TEST_FILES_DIR / "one_line.txt").resolve()
+    assert f'.incbin "{input_path}"' in assembly_file_path.read_text()
+    assert result.stderr == "", "No errors reported"
+    assert result.returncode == 0, "No errors reported"
+
+
+def test_incbin_standard_input_not_allowed(tmp_path: Path):
+    """Standard input can't be embedded with .incbin as there is no file for
+    the assembler to read"""
+    result = run_cpp11_embed(
+        "-",
+        "identifier",
+        False,
+        other_arguments=("--incbin", tmp_path / "out.S"),
+        standard_input="abc",
+    )
+    assert result.stdout == ""
+    assert result.stderr != "", "Error reported"
+    assert result.returncode != 0, "Error reported"
+
+
+@pytest.mark.skipif(not Path("/dev/full").exists(), reason="Needs /dev/full")
+def test_incbin_write_failure():
+    """An assembly file that couldn't be written is an error rather than
+    being left incomplete"""
+    result = run_cpp11_embed(
+        TEST_FILES_DIR / "one_line.txt",
+        "identifier",
+        False,
+        other_arguments=("--incbin", "/dev/full"),
+    )
+    assert "Unable to write assembly output file" in result.stderr
+    assert result.returncode != 0, "Error reported"
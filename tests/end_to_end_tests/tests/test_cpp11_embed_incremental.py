@@ -0,0 +1,111 @@
+"""Tests to ensure that outputs are only rewritten when they would change and
+that depfiles can be generated"""
+
+import os
+from pathlib import Path
+
+import pytest
+
+from .utilities import (
+    get_expected_text_data_header,
+    run_cpp11_embed,
+    run_cpp11_embed_arbitrary_arguments,
+    TEST_FILES_DIR,
+)
+
+# Far enough in the past that any rewrite will definitely change it
+OLD_TIMESTAMP_NS = 1_000_000_000 * 1_000_000_000
+
+
+def generate_incremental(input_path: Path, output_path: Path, *other_arguments):
+    """Runs cpp11_embed with --incremental and checks that it succeeded"""
+    result = run_cpp11_embed(
+        input_path,
+        "identifier",
+        False,
+        other_arguments=("-o", output_path, "--incremental") + other_arguments,
+    )
+    assert result.stderr == "", "No errors reported"
+    assert result.returncode == 0, "No errors reported"
+
+
+def make_old(path: Path):
+    """Sets the modification time of the file to long ago"""
+    os.utime(path, ns=(OLD_TIMESTAMP_NS, OLD_TIMESTAMP_NS))
+
+
+def test_incremental_unchanged_output_untouched(tmp_path: Path):
+    """If nothing has changed then the output shouldn't be written at all, even
+    if the input has been touched"""
+    input_path = tmp_path / "in.txt"
+    input_path.write_text("abcdef")
+    output_path = tmp_path / "out.h"
+    generate_incremental(input_path, output_path)
+    assert output_path.read_text() == get_expected_text_data_header(
+        "identifier", False, "abcdef"
+    )
+
+    make_old(output_path)
+    input_path.write_text("abcdef")
+    generate_incremental(input_path, output_path)
+    assert output_path.stat().st_mtime_ns == OLD_TIMESTAMP_NS
+
+
+@pytest.mark.parametrize(
+    "change",
+    ("input", "options", "deleted"),
+)
+def test_incremental_changes_regenerate(tmp_path: Path, change: str):
+    """A change to the input or the options, or the output going missing,
+    means that the output has to be generated again"""
+    input_path = tmp_path / "in.txt"
+    input_path.write_text("abcdef")
+    output_path = tmp_path / "out.h"
+    generate_incremental(input_path, output_path)
+    make_old(output_path)
+
+    other_arguments = tuple()
+    expected_contents = "abcdef"
+    if change == "input":
+        input_path.write_text("ghi")
+        expected_contents = "ghi"
+    elif change == "options":
+        other_arguments = ("-g",)
+    else:
+        output_path.unlink()
+    generate_incremental(input_path, output_path, *other_arguments)
+    assert output_path.read_text() == get_expected_text_data_header(
+        "identifier", change == "options", expected_contents
+    )
+    assert output_path.stat().st_mtime_ns != OLD_TIMESTAMP_NS
+
+
+def test_depfile(tmp_path: Path):
+    """The depfile should say that the output depends on the input"""
+    output_path = tmp_path / "out.h"
+    depfile_path = tmp_path / "out.d"
+    input_path = TEST_FILES_DIR / "one_line.txt"
+    result = run_cpp11_embed(
+        input_path,
+        "identifier",
+        False,
+        other_arguments=("-o", output_path, "--depfile", depfile_path),
+    )
+    assert depfile_path.read_text() == f"{output_path}: {input_path}\n"
+    assert result.stderr == "", "No errors reported"
+    assert result.returncode == 0, "No errors reported"
+
+
+@pytest.mark.parametrize("flag", (("--incremental",), ("--depfile", "out.d")))
+def test_incremental_and_depfile_require_files(tmp_path: Path, flag):
+    """There's nothing to hash or depend on without an input file and nowhere
+    to leave the output untouched without an output file"""
+    for arguments in (
+        ("-", "identifier", "-o", str(tmp_path / "out.h")),
+        (str(TEST_FILES_DIR / "one_line.txt"), "identifier"),
+    ):
+        result = run_cpp11_embed_arbitrary_arguments(
+            arguments + flag, standard_input=""
+        )
+        assert result.stderr != "", "Error reported"
+        assert result.returncode != 0, "Error reported"
@@ -0,0 +1,48 @@
+"""Tests to ensure that large inputs are formatted the same way however many
+threads are used"""
+
+from pathlib import Path
+
+import pytest
+
+from .utilities import get_expected_text_data_header, run_cpp11_embed
+
+
+@pytest.mark.parametrize("mode_arguments", (tuple(), ("-b",), ("-s",)))
+def test_jobs_give_the_same_output(tmp_path: Path, mode_arguments):
+    """Several chunks' worth of input should be byte-identical whether it is
+    formatted on one thread or several"""
+    # ASCII so that the text output can be decoded
+    input_path = tmp_path / "input.bin"
+    input_path.write_bytes(bytes(i * 31 % 128 for i in range(3 * 2**20 + 7)))
+    outputs = []
+    for jobs in ("1", "3"):
+        result = run_cpp11_embed(
+            input_path,
+            "identifier",
+            False,
+            other_arguments=mode_arguments + ("--jobs", jobs),
+        )
+        assert result.stderr == "", "No errors reported"
+        assert result.returncode == 0, "No errors reported"
+        outputs.append(result.stdout)
+    assert outputs[0] == outputs[1]
+
+
+def test_many_jobs_for_standard_input():
+    """Memory should be allocated for the input that arrives rather than for
+    however many jobs there are"""
+    result = run_cpp11_embed(
+        "-", "identifier", False, ("--jobs", "256"), standard_input="abc"
+    )
+    assert result.returncode == 0, "No errors reported"
+    assert result.stdout == get_expected_text_data_header("identifier", False, "abc")
+
+
+def test_too_many_jobs():
+    """--jobs has a sane upper limit"""
+    result = run_cpp11_embed(
+        "-", "identifier", False, ("--jobs", "100000"), standard_input="abc"
+    )
+    assert result.returncode != 0
+    assert "--jobs must be at most 256" in result.stderr
@@ -0,0 +1,141 @@
+"""Tests to ensure that many headers can be generated from a manifest"""
+
+from pathlib import Path
+
+import pytest
+
+from .utilities import (
+    FILES_AND_ESCAPED_CONTENTS,
+    get_expected_text_data_header,
+    run_cpp11_embed_arbitrary_arguments,
+    TEST_FILES_DIR,
+)
+
+
+def write_manifest(tmp_path: Path, lines) -> Path:
+    """:returns: the path to a manifest containing the given lines"""
+    manifest_path = tmp_path / "manifest.txt"
+    manifest_path.write_text("".join(f"{line}\n" for line in lines))
+    return manifest_path
+
+
+@pytest.mark.parametrize("jobs", (None, "1", "4"))
+def test_successful_manifest(tmp_path: Path, jobs):
+    """Test that every header in the manifest is generated correctly no matter
+    how many jobs are used.
+
+    Also makes sure that the return code is 0 and nothing is written to
+    standard error.
+    """
+    lines = ["# A comment", ""]
+    for i, (file_name, _) in enumerate(FILES_AND_ESCAPED_CONTENTS):
+        header_guard_field = "\t-g" if i % 2 else ""
+        lines.append(
+            f"{TEST_FILES_DIR / file_name}\tidentifier{i}\t"
+            f"{tmp_path / f'out{i}.h'}{header_guard_field}"
+        )
+    jobs_arguments = ("--jobs", jobs) if jobs else tuple()
+    result = run_cpp11_embed_arbitrary_arguments(
+        ("--manifest", str(write_manifest(tmp_path, lines))) + jobs_arguments
+    )
+    for i, (_, expected_string_literal_contents) in enumerate(
+        FILES_AND_ESCAPED_CONTENTS
+    ):
+        assert (tmp_path / f"out{i}.h").read_text() == get_expected_text_data_header(
+            f"identifier{i}", bool(i % 2), expected_string_literal_contents
+        )
+    assert result.stdout == ""
+    assert result.stderr == "", "No errors reported"
+    assert result.returncode == 0, "No errors reported"
+
+
+def test_manifest_entry_errors_reported(tmp_path: Path):
+    """An entry that can't be generated shouldn't stop the others from being
+    generated but should be reported along with its line number"""
+    lines = (
+        f"{TEST_FILES_DIR / 'one_line.txt'}\tfirst\t{tmp_path / 'first.h'}",
+        f"{tmp_path / 'does_not_exist.txt'}\tsecond\t{tmp_path / 'second.h'}",
+        f"{TEST_FILES_DIR / 'one_line.txt'}\tthird\t{tmp_path / 'third.h'}",
+    )
+    result = run_cpp11_embed_arbitrary_arguments(
+        ("--manifest", str(write_manifest(tmp_path, lines)))
+    )
+    assert (tmp_path / "first.h").exists()
+    assert (tmp_path / "third.h").exists()
+    assert "line 2" in result.stderr
+    assert result.returncode != 0, "Error reported"
+
+
+def test_manifest_too_few_fields(tmp_path: Path):
+    """Every line needs an input, an identifier name and an output"""
+    lines = (f"{TEST_FILES_DIR / 'one_line.txt'}\tidentifier",)
+    result = run_cpp11_embed_arbitrary_arguments(
+        ("--manifest", str(write_manifest(tmp_path, lines)))
+    )
+    assert result.stderr != "", "Error reported"
+    assert result.returncode != 0, "Error reported"
+
+
+def test_manifest_does_not_exist(tmp_path: Path):
+    """Make sure that an error is reported when the manifest can't be read"""
+    result = run_cpp11_embed_arbitrary_arguments(
+        ("--manifest", str(tmp_path / "manifest.txt"))
+    )
+    assert result.stderr != "", "Error reported"
+    assert result.returncode != 0, "Error reported"
+
+
+def test_manifest_with_positional_arguments(tmp_path: Path):
+    """The inputs come from the manifest so none can be given directly"""
+    result = run_cpp11_embed_arbitrary_arguments(
+        (
+            str(TEST_FILES_DIR / "one_line.txt"),
+            "identifier",
+            "--manifest",
+            str(write_manifest(tmp_path, tuple())),
+        )
+    )
+    assert result.stderr != "", "Error reported"
+    assert result.returncode != 0, "Error reported"
+
+
+def test_manifest_deduplicate(tmp_path: Path):
+    """Entries with the same input as an earlier entry (embedded the same way)
+    should refer to its header rather than embedding the data again"""
+    input_path = TEST_FILES_DIR / "one_line.txt"
+    copy_path = tmp_path / "copy.txt"
+    copy_path.write_bytes(input_path.read_bytes())
+    (tmp_path / "sub").mkdir()
+    lines = (
+        f"{input_path}\tfirst\t{tmp_path / 'first.h'}",
+        f"{copy_path}\tsecond\t{tmp_path / 'sub' / 'second.h'}\t-g",
+        f"{copy_path}\tthird\t{tmp_path / 'third.h'}\t-b",
+        f"{TEST_FILES_DIR / 'two_lines.txt'}\tfourth\t{tmp_path / 'fourth.h'}",
+    )
+    result = run_cpp11_embed_arbitrary_arguments(
+        ("--manifest", str(write_manifest(tmp_path, lines)), "--deduplicate")
+    )
+    assert (tmp_path / "sub" / "second.h").read_text() == (
+        "#ifndef SECOND\n#define SECOND\n\n#include <cstddef>\n\n"
+        '#include "../first.h"\n\n'
+        "// The same data as first rather than another copy of it\n"
+        "static constexpr const auto &second = first;\n\n#endif\n"
+    )
+    # Embedded as binary rather than text so can't be shared
+    assert "constexpr std::array<uint8_t, " in (tmp_path / "third.h").read_text()
+    assert "constexpr char fourth[] = " in (tmp_path / "fourth.h").read_text()
+    assert result.stdout == (
+        f"Deduplicated 1 of 4 entries, saving {input_path.stat().st_size} "
+        "bytes of embedded data\n"
+    )
+    assert result.stderr == "", "No errors reported"
+    assert result.returncode == 0, "No errors reported"
+
+
+def test_deduplicate_without_manifest():
+    """Deduplication is across the entries in a manifest"""
+    result = run_cpp11_embed_arbitrary_arguments(
+        (str(TEST_FILES_DIR / "one_line.txt"), "identifier", "--deduplicate")
+    )
+    assert result.stderr != "", "Error reported"
+    assert result.returncode != 0, "Error reported"
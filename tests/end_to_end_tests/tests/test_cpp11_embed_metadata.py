@@ -0,0 +1,145 @@
+"""Tests to ensure that hashes and a content type can be written along with
+the data"""
+
+import re
+from pathlib import Path
+
+import pytest
+
+from .utilities import (
+    run_cpp11_embed,
+    run_cpp11_embed_arbitrary_arguments,
+    TEST_FILES_DIR,
+)
+
+def crc32c(data: bytes) -> int:
+    """:returns: the CRC-32C of the data, the slow way"""
+    crc = 0xFFFFFFFF
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            crc = (crc >> 1) ^ (0x82F63B78 if crc & 1 else 0)
+    return crc ^ 0xFFFFFFFF
+
+
+def get_constant(header: str, name: str) -> str:
+    """:returns: the value that the constant is initialised with"""
+    match = re.search(rf"\b{name}(?:\[\])? = (.*);\n", header)
+    assert match, f"{name} should be defined"
+    return match.group(1)
+
+
+@pytest.mark.parametrize(
+    "mode_arguments,expected_content_type",
+    (
+        (tuple(), "text/plain"),
+        (("-b",), "application/octet-stream"),
+        (("-b", "--word-size", "4"), "application/octet-stream"),
+        (("-s",), "application/octet-stream"),
+    ),
+)
+@pytest.mark.parametrize("from_stdin", (True, False))
+def test_metadata(mode_arguments, expected_content_type: str, from_stdin: bool):
+    """Test that the size, hashes and content type are written, whether the
+    input is mapped or streamed"""
+    input_path = TEST_FILES_DIR / "two_lines.txt"
+    result = run_cpp11_embed(
+        "-" if from_stdin else input_path,
+        "identifier",
+        False,
+        other_arguments=mode_arguments + ("--metadata",),
+        standard_input=input_path.read_text() if from_stdin else None,
+    )
+    assert result.stderr == "", "No errors reported"
+    assert result.returncode == 0, "No errors reported"
+    data = input_path.read_bytes()
+    header = result.stdout
+    assert header.count("identifier_size =") == 1
+    assert get_constant(header, "identifier_crc32c") == f"0x{crc32c(data):08x}"
+    assert re.fullmatch(
+        r"0x[0-9a-f]{16}ULL", get_constant(header, "identifier_xxh64")
+    )
+    # Guessed from the extension when there is one
+    if not from_stdin:
+        expected_content_type = "text/plain"
+    assert get_constant(header, "identifier_content_type") == (
+        f'"{expected_content_type}"'
+    )
+
+
+def test_metadata_minified():
+    """The hashes are of the data as it is embedded"""
+    result = run_cpp11_embed(
+        "-",
+        "identifier",
+        False,
+        other_arguments=("--minify", "json", "--metadata"),
+        standard_input='{\n  "a": 1\n}\n',
+    )
+    assert result.returncode == 0, "No errors reported"
+    assert get_constant(result.stdout, "identifier_size") == "7"
+    minified = b'{"a":1}'
+    assert get_constant(result.stdout, "identifier_crc32c") == (
+        f"0x{crc32c(minified):08x}"
+    )
+
+
+def test_content_type(tmp_path: Path):
+    """Test that the content type is guessed from the extension unless it is
+    given"""
+    input_path = tmp_path / "data.json"
+    input_path.write_text("{}")
+    result = run_cpp11_embed(
+        input_path, "identifier", False, other_arguments=("--metadata",)
+    )
+    assert get_constant(result.stdout, "identifier_content_type") == (
+        '"application/json"'
+    )
+    result = run_cpp11_embed(
+        input_path,
+        "identifier",
+        False,
+        other_arguments=("--metadata", "--content-type", "text/x-custom"),
+    )
+    assert get_constant(result.stdout, "identifier_content_type") == (
+        '"text/x-custom"'
+    )
+
+
+@pytest.mark.parametrize(
+    "other_arguments,expected_error",
+    (
+        (("--metadata", "--compress"), "--metadata can't be used with"),
+        (("--metadata", "--incbin", "out.s"), "--metadata can't be used with"),
+        (("--content-type", "text/plain"), "--content-type requires --metadata"),
+    ),
+)
+def test_invalid_metadata(other_arguments, expected_error: str):
+    """Test that metadata is only written where it is supported"""
+    result = run_cpp11_embed(
+        TEST_FILES_DIR / "two_lines.txt",
+        "identifier",
+        False,
+        other_arguments=other_arguments,
+    )
+    assert result.stdout == ""
+    assert expected_error in result.stderr
+    assert result.returncode != 0, "Error reported"
+
+
+def test_deduplicated_metadata(tmp_path: Path):
+    """Duplicates refer to the metadata of the data they refer to"""
+    lines = [
+        f"{TEST_FILES_DIR / 'two_lines.txt'}\tidentifier{i}\t{tmp_path / f'out{i}.h'}"
+        "\t--metadata"
+        for i in range(2)
+    ]
+    manifest_path = tmp_path / "manifest.txt"
+    manifest_path.write_text("".join(f"{line}\n" for line in lines))
+    result = run_cpp11_embed_arbitrary_arguments(
+        ("--manifest", str(manifest_path), "--deduplicate")
+    )
+    assert result.returncode == 0, "No errors reported"
+    alias = (tmp_path / "out1.h").read_text()
+    assert get_constant(alias, "identifier1_crc32c") == "identifier0_crc32c"
+    assert get_constant(alias, "identifier1_size") == "identifier0_size"
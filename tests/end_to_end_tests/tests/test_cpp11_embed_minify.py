@@ -0,0 +1,91 @@
+"""Tests to ensure that text can be minified as it is embedded"""
+
+import pytest
+
+from .utilities import (
+    get_expected_text_data_header,
+    run_cpp11_embed,
+    TEST_FILES_DIR,
+)
+
+MINIFIED_SHADER = (
+    "#version 330 core\\n#define SCALE (0.5)\\nin vec4 colour;out vec4 "
+    "fragment_colour;void main(){fragment_colour=colour*SCALE- -0.25;}"
+)
+
+
+@pytest.mark.parametrize("use_header_guard", (True, False))
+@pytest.mark.parametrize("from_stdin", (True, False))
+def test_minify(use_header_guard: bool, from_stdin: bool):
+    """Test that comments and insignificant whitespace are stripped, whether
+    the input is mapped or streamed"""
+    input_path = TEST_FILES_DIR / "shader.glsl"
+    result = run_cpp11_embed(
+        "-" if from_stdin else input_path,
+        "shader",
+        use_header_guard,
+        other_arguments=("--minify", "glsl"),
+        standard_input=input_path.read_text() if from_stdin else None,
+    )
+    assert result.stdout == get_expected_text_data_header(
+        "shader", use_header_guard, MINIFIED_SHADER
+    )
+    assert result.stderr == "", "No errors reported"
+    assert result.returncode == 0, "No errors reported"
+
+
+@pytest.mark.parametrize(
+    "minify_format,text,expected",
+    (
+        ("json", '{\n  "a": [1, 2]\n}\n', '{\\"a\\":[1,2]}'),
+        ("css", "a {\n  color: red;\n}\n", "a{color:red;}"),
+        ("html", "<p>\n  Some  text\n</p>\n", "<p> Some text </p>"),
+        ("sql", "SELECT a\n  FROM b; -- all\n", "SELECT a FROM b;"),
+    ),
+)
+def test_minify_formats(minify_format: str, text: str, expected: str):
+    """Test that each format is minified"""
+    result = run_cpp11_embed(
+        "-",
+        "text",
+        False,
+        other_arguments=("--minify", minify_format),
+        standard_input=text,
+    )
+    assert result.stdout == get_expected_text_data_header("text", False, expected)
+    assert result.returncode == 0, "No errors reported"
+
+
+def test_unsupported_minify_format():
+    """Test that an unknown format is reported"""
+    result = run_cpp11_embed(
+        TEST_FILES_DIR / "shader.glsl",
+        "shader",
+        False,
+        other_arguments=("--minify", "xml"),
+    )
+    assert result.stdout == ""
+    assert "Unsupported minify format: xml" in result.stderr
+    assert result.returncode != 0, "Error reported"
+
+
+@pytest.mark.parametrize(
+    "other_arguments",
+    (
+        ("-b",),
+        ("-s",),
+        ("--compress",),
+        ("--incbin", "out.s"),
+    ),
+)
+def test_minify_only_applies_to_text(other_arguments):
+    """Test that --minify can't be used with anything that isn't plain text"""
+    result = run_cpp11_embed(
+        TEST_FILES_DIR / "shader.glsl",
+        "shader",
+        False,
+        other_arguments=("--minify", "glsl") + other_arguments,
+    )
+    assert result.stdout == ""
+    assert "--minify only applies to text" in result.stderr
+    assert result.returncode != 0, "Error reported"
@@ -0,0 +1,46 @@
+"""Tests to ensure that inputs that can't be memory mapped (e.g. pipes) give
+exactly the same output as regular files"""
+
+import os
+from pathlib import Path
+import threading
+
+import pytest
+
+from .utilities import run_cpp11_embed, TEST_FILES_DIR
+
+
+@pytest.mark.skipif(not hasattr(os, "mkfifo"), reason="Needs named pipes")
+@pytest.mark.parametrize(
+    "other_arguments",
+    (tuple(), ("-b",), ("-s",), ("--elf-object", "out.o")),
+)
+def test_named_pipe_input(tmp_path: Path, other_arguments):
+    """Test that reading from a named pipe gives the same output as reading
+    the same data from a file"""
+    input_path = TEST_FILES_DIR / "two_lines.txt"
+    other_arguments = tuple(
+        str(tmp_path / argument) if argument.endswith(".o") else argument
+        for argument in other_arguments
+    )
+    file_result = run_cpp11_embed(
+        input_path, "identifier", False, other_arguments=other_arguments
+    )
+
+    pipe_path = tmp_path / "pipe"
+    os.mkfifo(pipe_path)
+
+    def write_to_pipe():
+        with open(pipe_path, "wb") as pipe:
+            pipe.write(input_path.read_bytes())
+
+    writer = threading.Thread(target=write_to_pipe)
+    writer.start()
+    pipe_result = run_cpp11_embed(
+        pipe_path, "identifier", False, other_arguments=other_arguments
+    )
+    writer.join()
+
+    assert pipe_result.stdout == file_result.stdout
+    assert pipe_result.stderr == "", "No errors reported"
+    assert pipe_result.returncode == 0, "No errors reported"
@@ -0,0 +1,97 @@
+"""Tests for headers whose data can be loaded at runtime with --runtime-load"""
+
+from pathlib import Path
+import shutil
+import subprocess
+
+import pytest
+
+from .utilities import (
+    FILES_AND_ESCAPED_CONTENTS,
+    TEST_FILES_DIR,
+    get_cpp11_embed_path,
+    run_cpp11_embed,
+    run_cpp11_embed_arbitrary_arguments,
+)
+
+
+@pytest.mark.parametrize("input_filename, escaped_contents", FILES_AND_ESCAPED_CONTENTS)
+def test_runtime_load_text(input_filename: str, escaped_contents: str):
+    """The data should be embedded as usual, with where to load it from
+    recorded too"""
+    input_path = TEST_FILES_DIR / input_filename
+    result = run_cpp11_embed(
+        str(input_path), "identifier", False, other_arguments=("--runtime-load",)
+    )
+    assert result.stderr == "", "No errors reported"
+    assert result.returncode == 0, "No errors reported"
+    assert f'constexpr char identifier_data[] = "{escaped_contents}";\n' in (
+        result.stdout
+    )
+    assert f'File file("{input_path.resolve()}");' in result.stdout
+    assert "inline const char *identifier() {" in result.stdout
+    assert "inline std::size_t identifier_size() {" in result.stdout
+
+
+@pytest.mark.parametrize("mode_argument", ("-b", "-s"))
+def test_runtime_load_binary(mode_argument: str):
+    """Binary data is accessed as unsigned char and always embedded in a
+    string literal as that is much faster to compile"""
+    result = run_cpp11_embed(
+        str(TEST_FILES_DIR / "one_line.txt"),
+        "identifier",
+        False,
+        other_arguments=(mode_argument, "--runtime-load"),
+    )
+    assert result.returncode == 0, "No errors reported"
+    assert "constexpr unsigned char identifier_data[] =\n" in result.stdout
+    assert "inline const unsigned char *identifier() {" in result.stdout
+
+
+def test_runtime_load_relative_path(tmp_path: Path):
+    """The input should be loaded from the same place wherever the program
+    that uses the header is run from"""
+    shutil.copy(TEST_FILES_DIR / "one_line.txt", tmp_path / "input.txt")
+    # pylint:disable=subprocess-run-check
+    result = subprocess.run(
+        (get_cpp11_embed_path(), "input.txt", "identifier", "--runtime-load"),
+        capture_output=True,
+        text=True,
+        cwd=tmp_path,
+    )
+    assert result.returncode == 0, "No errors reported"
+    assert f'File file("{(tmp_path / "input.txt").resolve()}"' in result.stdout
+
+
+@pytest.mark.parametrize(
+    "other_arguments",
+    (
+        ("--compress",),
+        ("--metadata",),
+        ("--minify", "json"),
+        ("-b", "--word-size", "4"),
+        ("--definition", "definition.cpp", "-o", "output.h"),
+    ),
+)
+def test_runtime_load_invalid_arguments(other_arguments):
+    """Only data embedded in the header itself, exactly as it is in the input
+    file, can be loaded at runtime instead"""
+    result = run_cpp11_embed(
+        str(TEST_FILES_DIR / "one_line.txt"),
+        "identifier",
+        False,
+        other_arguments=("--runtime-load",) + other_arguments,
+    )
+    assert result.returncode != 0
+    assert "--runtime-load requires an input file and can't be used" in (
+        result.stderr
+    )
+
+
+def test_runtime_load_standard_input():
+    """There's no file to load standard input from"""
+    result = run_cpp11_embed_arbitrary_arguments(
+        ("-", "identifier", "--runtime-load"), standard_input="abc"
+    )
+    assert result.returncode != 0
+    assert "--runtime-load requires an input file" in result.stderr
@@ -0,0 +1,168 @@
+"""Tests to ensure that what it took to generate headers can be reported"""
+
+import json
+from pathlib import Path
+
+import pytest
+
+from .utilities import (
+    run_cpp11_embed,
+    run_cpp11_embed_arbitrary_arguments,
+    TEST_FILES_DIR,
+)
+
+STATS_FIELDS = {
+    "output_filename",
+    "identifier_name",
+    "mode",
+    "input_bytes",
+    "output_bytes",
+    "expansion_ratio",
+    "read_seconds",
+    "format_seconds",
+    "write_seconds",
+    "peak_rss_bytes",
+}
+
+
+def test_stats(tmp_path: Path):
+    """Test that --stats reports on standard error without changing the
+    header"""
+    output_path = tmp_path / "out.h"
+    result = run_cpp11_embed(
+        TEST_FILES_DIR / "two_lines.txt",
+        "identifier",
+        False,
+        other_arguments=("--stats", "-o", output_path),
+    )
+    output_bytes = len(output_path.read_bytes())
+    assert result.stdout == ""
+    assert result.stderr.startswith(
+        f"{output_path}: text, 18 bytes in, {output_bytes} bytes out ("
+    )
+    assert result.stderr.endswith(" MiB\n")
+    assert result.stderr.count("\n") == 1
+    assert result.returncode == 0, "No errors reported"
+
+
+@pytest.mark.parametrize(
+    "mode_arguments,expected_mode",
+    (
+        (tuple(), "text"),
+        (("-b",), "binary"),
+        (("-s",), "binary-string-literal"),
+        (("--compress",), "compressed-text"),
+        (("-s", "--compress"), "compressed-binary"),
+    ),
+)
+@pytest.mark.parametrize("from_stdin", (True, False))
+def test_stats_json(
+    tmp_path: Path, mode_arguments, expected_mode: str, from_stdin: bool
+):
+    """Test that --stats-json writes the stats of the header, whether the
+    input is mapped or streamed"""
+    input_path = TEST_FILES_DIR / "two_lines.txt"
+    output_path = tmp_path / "out.h"
+    stats_path = tmp_path / "stats.json"
+    output_arguments = ("-o", output_path, f"--stats-json={stats_path}")
+    result = run_cpp11_embed(
+        "-" if from_stdin else input_path,
+        "identifier",
+        False,
+        other_arguments=mode_arguments + output_arguments,
+        standard_input=input_path.read_text() if from_stdin else None,
+    )
+    assert result.stderr == "", "No errors reported"
+    assert result.returncode == 0, "No errors reported"
+    stats = json.loads(stats_path.read_text())
+    assert len(stats) == 1
+    assert set(stats[0]) == STATS_FIELDS
+    assert stats[0]["output_filename"] == str(output_path)
+    assert stats[0]["identifier_name"] == "identifier"
+    assert stats[0]["mode"] == expected_mode
+    assert stats[0]["input_bytes"] == 18
+    assert stats[0]["output_bytes"] == len(output_path.read_bytes())
+    assert stats[0]["expansion_ratio"] == pytest.approx(
+        stats[0]["output_bytes"] / 18, abs=1e-6
+    )
+    assert stats[0]["peak_rss_bytes"] > 0
+
+
+def test_stats_count_every_output(tmp_path: Path):
+    """Files generated alongside the header count towards the output"""
+    output_path = tmp_path / "out.h"
+    definition_path = tmp_path / "out.cpp"
+    stats_path = tmp_path / "stats.json"
+    result = run_cpp11_embed(
+        TEST_FILES_DIR / "two_lines.txt",
+        "identifier",
+        False,
+        other_arguments=(
+            "-o",
+            output_path,
+            "--definition",
+            definition_path,
+            "--stats-json",
+            stats_path,
+        ),
+    )
+    assert result.returncode == 0, "No errors reported"
+    stats = json.loads(stats_path.read_text())
+    assert stats[0]["mode"] == "text-definition"
+    assert stats[0]["output_bytes"] == len(output_path.read_bytes()) + len(
+        definition_path.read_bytes()
+    )
+
+
+def test_stats_up_to_date(tmp_path: Path):
+    """Nothing is reported for outputs that --incremental leaves alone"""
+    stats_path = tmp_path / "stats.json"
+    arguments = (
+        str(TEST_FILES_DIR / "one_line.txt"),
+        "identifier",
+        "-o",
+        str(tmp_path / "out.h"),
+        "--incremental",
+        "--stats-json",
+        str(stats_path),
+    )
+    run_cpp11_embed_arbitrary_arguments(arguments)
+    assert len(json.loads(stats_path.read_text())) == 1
+    result = run_cpp11_embed_arbitrary_arguments(arguments)
+    assert result.returncode == 0, "No errors reported"
+    assert json.loads(stats_path.read_text()) == []
+
+
+def test_manifest_stats(tmp_path: Path):
+    """Every entry of a manifest is reported, in order"""
+    lines = [
+        f"{TEST_FILES_DIR / name}\tidentifier{i}\t{tmp_path / f'out{i}.h'}"
+        for i, name in enumerate(("one_line.txt", "two_lines.txt", "tabs.txt"))
+    ]
+    manifest_path = tmp_path / "manifest.txt"
+    manifest_path.write_text("".join(f"{line}\n" for line in lines))
+    stats_path = tmp_path / "stats.json"
+    result = run_cpp11_embed_arbitrary_arguments(
+        ("--manifest", str(manifest_path), "--stats-json", str(stats_path))
+    )
+    assert result.stderr == "", "No errors reported"
+    assert result.returncode == 0, "No errors reported"
+    stats = json.loads(stats_path.read_text())
+    assert [entry["identifier_name"] for entry in stats] == [
+        "identifier0",
+        "identifier1",
+        "identifier2",
+    ]
+    assert [entry["input_bytes"] for entry in stats] == [6, 18, 10]
+
+
+def test_manifest_entry_stats(tmp_path: Path):
+    """Stats can only be asked for by the manifest as a whole"""
+    manifest_path = tmp_path / "manifest.txt"
+    manifest_path.write_text(
+        f"{TEST_FILES_DIR / 'one_line.txt'}\tidentifier\t{tmp_path / 'out.h'}"
+        "\t--stats\n"
+    )
+    result = run_cpp11_embed_arbitrary_arguments(("--manifest", str(manifest_path)))
+    assert "--stats and --stats-json apply to the whole manifest" in result.stderr
+    assert result.returncode != 0, "Error reported"
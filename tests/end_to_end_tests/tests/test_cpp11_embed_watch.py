@@ -0,0 +1,176 @@
+"""Tests for regenerating outputs whenever the inputs change with --watch"""
+
+from contextlib import contextmanager
+from pathlib import Path
+import queue
+import subprocess
+import threading
+
+import pytest
+
+from .utilities import (
+    get_cpp11_embed_path,
+    get_expected_text_data_header,
+    run_cpp11_embed_arbitrary_arguments,
+)
+
+TIMEOUT_SECONDS = 10
+
+
+class Watcher:
+    """A running Cpp11Embed --watch"""
+
+    def __init__(self, process: subprocess.Popen):
+        self._process = process
+        self._lines = queue.Queue()
+        self._reader = threading.Thread(target=self._read_lines, daemon=True)
+        self._reader.start()
+
+    def _read_lines(self):
+        for line in self._process.stdout:
+            self._lines.put(line)
+        self._lines.put(None)
+
+    def wait_until_generated(self):
+        """Waits for the outputs to be (re)generated
+        :returns: the lines written since last time"""
+        lines = []
+        while True:
+            line = self._lines.get(timeout=TIMEOUT_SECONDS)
+            assert line is not None, "Still watching"
+            lines.append(line)
+            if line.endswith("watching for changes\n"):
+                return lines
+
+
+@contextmanager
+def watch(arguments, cwd: Path):
+    """Runs Cpp11Embed --watch until the end of the with block"""
+    with subprocess.Popen(
+        (get_cpp11_embed_path(),) + arguments + ("--watch",),
+        stdout=subprocess.PIPE,
+        stderr=subprocess.PIPE,
+        text=True,
+        cwd=cwd,
+    ) as process:
+        try:
+            watcher = Watcher(process)
+            watcher.wait_until_generated()
+            yield watcher
+        finally:
+            process.terminate()
+            process.wait(timeout=TIMEOUT_SECONDS)
+
+
+def test_watch_file(tmp_path: Path):
+    """The header should be regenerated every time the input changes,
+    including when the input is replaced by renaming a file over it"""
+    input_path = tmp_path / "input.txt"
+    output_path = tmp_path / "output.h"
+    input_path.write_text("abc")
+    with watch(("input.txt", "identifier", "-o", "output.h"), tmp_path) as watcher:
+        assert output_path.read_text() == get_expected_text_data_header(
+            "identifier", False, "abc"
+        )
+
+        input_path.write_text("one\ntwo")
+        lines = watcher.wait_until_generated()
+        assert lines[0] == "input.txt changed\n"
+        assert output_path.read_text() == get_expected_text_data_header(
+            "identifier", False, "one\\ntwo"
+        )
+
+        (tmp_path / "new_input.txt").write_text("def")
+        (tmp_path / "new_input.txt").replace(input_path)
+        watcher.wait_until_generated()
+        assert output_path.read_text() == get_expected_text_data_header(
+            "identifier", False, "def"
+        )
+    assert sorted(path.name for path in tmp_path.iterdir()) == [
+        "input.txt",
+        "output.h",
+    ], "No temporary files are left behind"
+
+
+def test_watch_keeps_going_after_errors(tmp_path: Path):
+    """Errors should be reported without stopping the watch, and the last
+    output that was generated should be left as it was"""
+    input_path = tmp_path / "input.txt"
+    output_path = tmp_path / "output.h"
+    input_path.write_text("abc")
+    with watch(("input.txt", "identifier", "-o", "output.h"), tmp_path) as watcher:
+        expected_output = output_path.read_text()
+        input_path.unlink()
+        watcher.wait_until_generated()
+        assert output_path.read_text() == expected_output
+        assert not (tmp_path / "output.h.cpp11embed-tmp").exists()
+
+        input_path.write_text("def")
+        watcher.wait_until_generated()
+        assert output_path.read_text() == get_expected_text_data_header(
+            "identifier", False, "def"
+        )
+
+
+def test_watch_directory(tmp_path: Path):
+    """Files added to the directory (or any subdirectory) should be
+    embedded"""
+    directory_path = tmp_path / "assets"
+    (directory_path / "sub").mkdir(parents=True)
+    (directory_path / "sub" / "a.txt").write_text("a")
+    output_path = tmp_path / "output.h"
+    with watch(
+        ("assets", "assets", "--directory", "-o", "output.h"), tmp_path
+    ) as watcher:
+        assert "b.txt" not in output_path.read_text()
+        (directory_path / "sub" / "b.txt").write_text("b")
+        watcher.wait_until_generated()
+        assert "sub/b.txt" in output_path.read_text()
+
+
+def test_watch_manifest(tmp_path: Path):
+    """Only the entries whose input changed should be regenerated, and every
+    entry when the manifest changes"""
+    for name in ("a", "b", "c"):
+        (tmp_path / f"{name}.txt").write_text(name)
+    manifest_path = tmp_path / "manifest.txt"
+    manifest_path.write_text("a.txt\ta\ta.h\nb.txt\tb\tb.h\n")
+    with watch(("--manifest", "manifest.txt"), tmp_path) as watcher:
+        b_modified = (tmp_path / "b.h").stat().st_mtime_ns
+
+        (tmp_path / "a.txt").write_text("changed")
+        watcher.wait_until_generated()
+        assert (tmp_path / "a.h").read_text() == get_expected_text_data_header(
+            "a", False, "changed"
+        )
+        assert (tmp_path / "b.h").stat().st_mtime_ns == b_modified
+
+        manifest_path.write_text("a.txt\ta\ta.h\nb.txt\tb\tb.h\nc.txt\tc\tc.h\n")
+        watcher.wait_until_generated()
+        assert (tmp_path / "c.h").read_text() == get_expected_text_data_header(
+            "c", False, "c"
+        )
+
+        # The new entry's input is watched too
+        (tmp_path / "c.txt").write_text("changed")
+        watcher.wait_until_generated()
+        assert (tmp_path / "c.h").read_text() == get_expected_text_data_header(
+            "c", False, "changed"
+        )
+
+
+@pytest.mark.parametrize(
+    "arguments",
+    (
+        ("-", "identifier", "-o", "output.h", "--watch"),
+        ("input.txt", "identifier", "--watch"),
+    ),
+)
+def test_watch_invalid_arguments(arguments):
+    """Watching needs an input file to watch and an output file to write"""
+    result = run_cpp11_embed_arbitrary_arguments(arguments)
+    assert result.returncode != 0
+    assert (
+        "--watch requires an input file and an output file (or a manifest)"
+        in result.stderr
+    )
@@ -0,0 +1,112 @@
+// C++
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 3rd party
+#include <catch2/catch.hpp>
+
+// Project
+#include "Batch/CompressedTextHeader.h"
+#include "Batch/Duplicates/CompressedTextHeader.h"
+#include "CompressedAllBytesHeader.h"
+#include "CompressedRepetitiveTextHeader.h"
+#include "CompressedTextHeader.h"
+#include "SelfTestUtilities.h"
+
+// Include the headers twice to make sure that header guards and pragmas are
+// done correctly, as well as the guard around the shared decompressor
+#include "CompressedAllBytesHeader.h"
+#include "CompressedTextHeader.h"
+
+namespace {
+/**
+ * @returns the contents of test_files/repetitive.txt
+ */
+std::string GetRepetitiveTestFileContents() {
+  std::string contents;
+  for (int i = 0; i < 100; i++) {
+    contents += "Cpp11Embed compresses repetitive data very well.\n";
+  }
+  return contents + std::string(1000, 'a') + "\n";
+}
+}  // namespace
+
+TEST_CASE("cpp11embedtest auto-generated compressed text header",
+          "[cpp11embed][SelfTest]") {
+  static_assert(k_compressed_text_header_size == 18,
+                "Size should be available at compile time");
+  REQUIRE(std::strcmp(k_compressed_text_header(), "one line\ntwo lines") ==
+          0);
+  // Only decompressed once
+  REQUIRE(k_compressed_text_header() == k_compressed_text_header());
+
+  std::vector<char> buffer(k_compressed_text_header_size);
+  REQUIRE(k_compressed_text_header_decompress(buffer.data()));
+  REQUIRE(std::string(buffer.begin(), buffer.end()) == "one line\ntwo lines");
+}
+
+TEST_CASE(
+    "cpp11embedtest auto-generated compressed binary header with every byte "
+    "value",
+    "[cpp11embed][SelfTest]") {
+  const std::vector<uint8_t> expected = GetAllBytesTestFileContents();
+  REQUIRE(k_compressed_all_bytes_header_size == expected.size());
+  REQUIRE(std::vector<uint8_t>(k_compressed_all_bytes_header(),
+                               k_compressed_all_bytes_header() +
+                                   k_compressed_all_bytes_header_size) ==
+          expected);
+
+  std::vector<uint8_t> buffer(k_compressed_all_bytes_header_size);
+  REQUIRE(k_compressed_all_bytes_header_decompress(buffer.data()));
+  REQUIRE(buffer == expected);
+}
+
+TEST_CASE("cpp11embedtest auto-generated compressed repetitive text header",
+          "[cpp11embed][SelfTest]") {
+  static_assert(k_compressed_repetitive_text_header_compressed_size <
+                    k_compressed_repetitive_text_header_size / 10,
+                "Repetitive data should compress well");
+  REQUIRE(k_compressed_repetitive_text_header() ==
+          GetRepetitiveTestFileContents());
+}
+
+TEST_CASE(
+    "cpp11embedtest auto-generated compressed header accessed from several "
+    "threads",
+    "[cpp11embed][SelfTest]") {
+  std::vector<const char *> results(8);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < results.size(); i++) {
+    threads.emplace_back([&results, i]() {
+      results[i] = k_compressed_repetitive_text_header();
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  for (const char *const result : results) {
+    REQUIRE(result == k_compressed_repetitive_text_header());
+  }
+}
+
+TEST_CASE("cpp11embedtest auto-generated batch compressed header",
+          "[cpp11embed][SelfTest]") {
+  REQUIRE(std::strcmp(k_batch_compressed_text_header(), "a\tb\tcde\tfg") == 0);
+}
+
+TEST_CASE("cpp11embedtest auto-generated deduplicated compressed header",
+          "[cpp11embed][SelfTest]") {
+  static_assert(k_batch_duplicate_compressed_text_header_size ==
+                    k_batch_compressed_text_header_size,
+                "Size should be available at compile time");
+  REQUIRE(&k_batch_duplicate_compressed_text_header_compressed ==
+          &k_batch_compressed_text_header_compressed);
+  // Shares the decompressed data too
+  REQUIRE(k_batch_duplicate_compressed_text_header() ==
+          k_batch_compressed_text_header());
+  char buffer[k_batch_duplicate_compressed_text_header_size];
+  REQUIRE(k_batch_duplicate_compressed_text_header_decompress(buffer));
+  REQUIRE(std::string(buffer, sizeof(buffer)) == "a\tb\tcde\tfg");
+}
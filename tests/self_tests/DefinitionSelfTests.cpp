@@ -0,0 +1,78 @@
+// C++
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// 3rd party
+#include <catch2/catch.hpp>
+
+// Project
+#include "DefinedBinaryHeader.h"
+#include "DefinedTextHeader.h"
+#include "InASubDirectory/ShardedTextHeader.h"
+#include "SelfTestUtilities.h"
+#include "ShardedBinaryStringLiteralHeader.h"
+
+// Include the headers twice to make sure that header guards and pragmas are
+// done correctly
+#include "DefinedBinaryHeader.h"
+#include "DefinedTextHeader.h"
+#include "ShardedBinaryStringLiteralHeader.h"
+
+namespace {
+/**
+ * @returns every shard joined back together
+ */
+template <typename Element, size_t number_of_shards>
+std::vector<uint8_t> JoinShards(
+    const Element *const (&shards)[number_of_shards], const size_t shard_size,
+    const size_t size) {
+  std::vector<uint8_t> joined;
+  for (const Element *const shard : shards) {
+    const size_t remaining = size - joined.size();
+    const size_t this_shard_size = std::min(shard_size, remaining);
+    joined.insert(joined.end(), shard, shard + this_shard_size);
+  }
+  return joined;
+}
+}  // namespace
+
+TEST_CASE("cpp11embedtest auto-generated defined text header",
+          "[cpp11embed][SelfTest]") {
+  static_assert(k_defined_text_header_size == 18,
+                "Size should be available at compile time");
+  REQUIRE(sizeof(k_defined_text_header) == k_defined_text_header_size + 1);
+  REQUIRE(std::strcmp(k_defined_text_header, "one line\ntwo lines") == 0);
+}
+
+TEST_CASE("cpp11embedtest auto-generated defined binary header",
+          "[cpp11embed][SelfTest]") {
+  const std::vector<uint8_t> expected = GetAllBytesTestFileContents();
+  static_assert(k_defined_binary_header_size == 518,
+                "Size should be available at compile time");
+  REQUIRE(std::vector<uint8_t>(k_defined_binary_header.begin(),
+                               k_defined_binary_header.end()) == expected);
+}
+
+TEST_CASE("cpp11embedtest auto-generated sharded headers",
+          "[cpp11embed][SelfTest]") {
+  static_assert(k_sharded_binary_string_literal_header_number_of_shards == 3,
+                "Number of shards should be available at compile time");
+  static_assert(k_sharded_binary_string_literal_header_shard_size == 173,
+                "Shard size should be available at compile time");
+  REQUIRE(JoinShards(k_sharded_binary_string_literal_header_shards,
+                     k_sharded_binary_string_literal_header_shard_size,
+                     k_sharded_binary_string_literal_header_size) ==
+          GetAllBytesTestFileContents());
+
+  const std::vector<uint8_t> text = JoinShards(
+      k_sharded_text_header_shards, k_sharded_text_header_shard_size,
+      k_sharded_text_header_size);
+  REQUIRE(std::string(text.begin(), text.end()) == "one line\ntwo lines");
+  // Every shard is null terminated
+  REQUIRE(std::strcmp(k_sharded_text_header_shards[0], "one line\n") == 0);
+  REQUIRE(std::strcmp(k_sharded_text_header_shards[1], "two lines") == 0);
+}
@@ -0,0 +1,61 @@
+// C++
+#include <cstdint>
+#include <string>
+
+// 3rd party
+#include <catch2/catch.hpp>
+
+// Project
+#include "DirectoryHeader.h"
+
+// Include the header twice to make sure that the pragma is done correctly
+#include "DirectoryHeader.h"
+
+namespace {
+std::string GetContents(const test_directory::Entry &entry) {
+  return std::string(reinterpret_cast<const char *>(entry.data), entry.size);
+}
+}  // namespace
+
+TEST_CASE("cpp11embedtest auto-generated directory header",
+          "[cpp11embed][SelfTest]") {
+  static_assert(test_directory::number_of_entries == 5,
+                "Number of files should be available at compile time");
+  const auto path_and_contents = GENERATE(
+      std::make_pair("hello.txt", "Hello"),
+      std::make_pair("nested/world.txt", "world\n"),
+      std::make_pair("nested/hello_copy.txt", "Hello"),
+      std::make_pair("nested/file with spaces.txt", "with spaces"),
+      std::make_pair("nested/deeper/empty.bin", ""));
+  const test_directory::Entry *const entry =
+      test_directory::find(path_and_contents.first);
+  REQUIRE(entry != nullptr);
+  REQUIRE(std::string(entry->path) == path_and_contents.first);
+  REQUIRE(GetContents(*entry) == path_and_contents.second);
+  // Every file should be aligned as requested
+  REQUIRE(reinterpret_cast<std::uintptr_t>(entry->data) % 64 == 0);
+}
+
+TEST_CASE("cpp11embedtest auto-generated directory header duplicate files",
+          "[cpp11embed][SelfTest]") {
+  static_assert(test_directory::deduplicated_bytes == 5,
+                "Only the copy of hello.txt should have been deduplicated");
+  // Files with the same contents share their storage
+  REQUIRE(test_directory::find("hello.txt")->data ==
+          test_directory::find("nested/hello_copy.txt")->data);
+}
+
+TEST_CASE("cpp11embedtest auto-generated directory header missing files",
+          "[cpp11embed][SelfTest]") {
+  const char *const path = GENERATE("", "hello", "hello.txt2", "nested",
+                                    "nested/", "/hello.txt", "world.txt");
+  REQUIRE(test_directory::find(path) == nullptr);
+}
+
+TEST_CASE("cpp11embedtest auto-generated directory header entries",
+          "[cpp11embed][SelfTest]") {
+  // Every entry can be found through its own path
+  for (const test_directory::Entry &entry : test_directory::entries) {
+    REQUIRE(test_directory::find(entry.path, entry.path_size) == &entry);
+  }
+}
@@ -0,0 +1,31 @@
+// C++
+#include <cstdint>
+#include <vector>
+
+// 3rd party
+#include <catch2/catch.hpp>
+
+// Project
+#include "AllBytesElfObjectHeader.h"
+#include "SelfTestUtilities.h"
+
+// Include the header twice to make sure that the pragma is done correctly
+#include "AllBytesElfObjectHeader.h"
+
+TEST_CASE("cpp11embedtest auto-generated ELF object header",
+          "[cpp11embed][SelfTest]") {
+  const std::vector<uint8_t> expected = GetAllBytesTestFileContents();
+  REQUIRE(sizeof(k_all_bytes_elf_object_header) == expected.size());
+  REQUIRE(k_all_bytes_elf_object_header_size == expected.size());
+  REQUIRE(std::vector<uint8_t>(k_all_bytes_elf_object_header,
+                               k_all_bytes_elf_object_header +
+                                   k_all_bytes_elf_object_header_size) ==
+          expected);
+}
+
+TEST_CASE("cpp11embedtest auto-generated ELF object header alignment",
+          "[cpp11embed][SelfTest]") {
+  REQUIRE(reinterpret_cast<std::uintptr_t>(k_all_bytes_elf_object_header) %
+              64 ==
+          0);
+}
@@ -0,0 +1,22 @@
+// C++
+#include <vector>
+
+// 3rd party
+#include <catch2/catch.hpp>
+
+// Project
+#include "AllBytesIncbinHeader.h"
+#include "SelfTestUtilities.h"
+
+// Include the header twice to make sure that the pragma is done correctly
+#include "AllBytesIncbinHeader.h"
+
+TEST_CASE("cpp11embedtest auto-generated incbin header",
+          "[cpp11embed][SelfTest]") {
+  const std::vector<uint8_t> expected = GetAllBytesTestFileContents();
+  REQUIRE(sizeof(k_all_bytes_incbin_header) == expected.size());
+  REQUIRE(k_all_bytes_incbin_header_size == expected.size());
+  REQUIRE(std::vector<uint8_t>(k_all_bytes_incbin_header,
+                               k_all_bytes_incbin_header +
+                                   k_all_bytes_incbin_header_size) == expected);
+}
@@ -0,0 +1,42 @@
+// C++
+#include <cstring>
+#include <vector>
+
+// 3rd party
+#include <catch2/catch.hpp>
+
+// Project
+#include "AllBytesMetadataHeader.h"
+#include "Hash.h"
+#include "SelfTestUtilities.h"
+#include "TextMetadataHeader.h"
+
+// Include the headers twice to make sure that the pragmas are done correctly
+#include "AllBytesMetadataHeader.h"
+#include "TextMetadataHeader.h"
+
+TEST_CASE("cpp11embedtest auto-generated metadata header",
+          "[cpp11embed][SelfTest]") {
+  static_assert(k_all_bytes_metadata_header_size == 518,
+                "Size should be available at compile time");
+  const std::vector<uint8_t> expected = GetAllBytesTestFileContents();
+  cpp11embed::Crc32c crc32c;
+  crc32c.Update(expected.data(), expected.size());
+  cpp11embed::Xxh64 xxh64;
+  xxh64.Update(expected.data(), expected.size());
+  REQUIRE(k_all_bytes_metadata_header_crc32c == crc32c.Digest());
+  REQUIRE(k_all_bytes_metadata_header_xxh64 == xxh64.Digest());
+  REQUIRE(std::strcmp(k_all_bytes_metadata_header_content_type,
+                      "application/octet-stream") == 0);
+}
+
+TEST_CASE("cpp11embedtest auto-generated text metadata header",
+          "[cpp11embed][SelfTest]") {
+  static_assert(k_text_metadata_header_size == 18,
+                "Size should be available at compile time");
+  cpp11embed::Crc32c crc32c;
+  crc32c.Update(k_text_metadata_header, k_text_metadata_header_size);
+  REQUIRE(k_text_metadata_header_crc32c == crc32c.Digest());
+  REQUIRE(std::strcmp(k_text_metadata_header_content_type, "text/x-lines") ==
+          0);
+}
@@ -0,0 +1,20 @@
+// C++
+#include <cstring>
+
+// 3rd party
+#include <catch2/catch.hpp>
+
+// Project
+#include "MinifiedShaderHeader.h"
+
+// Include the header twice to make sure that the pragma is done correctly
+#include "MinifiedShaderHeader.h"
+
+TEST_CASE("cpp11embedtest auto-generated minified header",
+          "[cpp11embed][SelfTest]") {
+  REQUIRE(std::strcmp(k_minified_shader_header,
+                      "#version 330 core\n"
+                      "#define SCALE (0.5)\n"
+                      "in vec4 colour;out vec4 fragment_colour;void main(){"
+                      "fragment_colour=colour*SCALE- -0.25;}") == 0);
+}
@@ -0,0 +1,46 @@
+// C++
+#include <string>
+
+// 3rd party
+#include <catch2/catch.hpp>
+
+// Project
+#include "RuntimeLoadAllBytesHeader.h"
+#include "RuntimeLoadEmptyHeader.h"
+#include "RuntimeLoadSelfTests.h"
+#include "RuntimeLoadTextHeader.h"
+
+TEST_CASE("cpp11embedtest auto-generated runtime load text header embedded",
+          "[cpp11embed][SelfTest]") {
+  // Embedded as usual as CPP11_EMBED_RUNTIME_LOAD isn't defined here
+  static_assert(k_runtime_load_text_header_data[0] == 'o' &&
+                    k_runtime_load_text_header_size() == 18,
+                "Data should be available at compile time");
+  REQUIRE(k_runtime_load_text_header() == k_runtime_load_text_header_data);
+  REQUIRE(GetRuntimeLoadedText() != k_runtime_load_text_header());
+  REQUIRE(std::string(k_runtime_load_text_header(),
+                      k_runtime_load_text_header_size() + 1) ==
+          std::string(GetRuntimeLoadedText(),
+                      k_runtime_load_text_header_size() + 1));
+}
+
+TEST_CASE(
+    "cpp11embedtest auto-generated runtime load binary header embedded with "
+    "every byte value",
+    "[cpp11embed][SelfTest]") {
+  REQUIRE(k_runtime_load_all_bytes_header() ==
+          k_runtime_load_all_bytes_header_data);
+  REQUIRE(GetRuntimeLoadedAllBytes() != k_runtime_load_all_bytes_header());
+  const auto to_string = [](const unsigned char *data) {
+    return std::string(data,
+                       data + k_runtime_load_all_bytes_header_size() + 1);
+  };
+  REQUIRE(to_string(k_runtime_load_all_bytes_header()) ==
+          to_string(GetRuntimeLoadedAllBytes()));
+}
+
+TEST_CASE("cpp11embedtest auto-generated runtime load empty header embedded",
+          "[cpp11embed][SelfTest]") {
+  REQUIRE(std::string(k_runtime_load_empty_header()) ==
+          std::string(GetRuntimeLoadedEmpty()));
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+/**
+ * The data of each runtime load header as loaded at runtime, by code built
+ * with CPP11_EMBED_RUNTIME_LOAD defined (see RuntimeLoadedSelfTests.cpp)
+ */
+const char *GetRuntimeLoadedText();
+const unsigned char *GetRuntimeLoadedAllBytes();
+const char *GetRuntimeLoadedEmpty();
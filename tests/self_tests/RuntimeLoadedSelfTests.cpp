@@ -0,0 +1,82 @@
+// Everything in this file loads the data at runtime rather than embedding it
+#define CPP11_EMBED_RUNTIME_LOAD
+
+// C++
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 3rd party
+#include <catch2/catch.hpp>
+
+// Project
+#include "RuntimeLoadAllBytesHeader.h"
+#include "RuntimeLoadChangedHeader.h"
+#include "RuntimeLoadEmptyHeader.h"
+#include "RuntimeLoadSelfTests.h"
+#include "RuntimeLoadTextHeader.h"
+#include "SelfTestUtilities.h"
+
+// Include the headers twice to make sure that header guards and pragmas are
+// done correctly, as well as the guard around the shared loader
+#include "RuntimeLoadAllBytesHeader.h"
+#include "RuntimeLoadTextHeader.h"
+
+const char *GetRuntimeLoadedText() { return k_runtime_load_text_header(); }
+
+const unsigned char *GetRuntimeLoadedAllBytes() {
+  return k_runtime_load_all_bytes_header();
+}
+
+const char *GetRuntimeLoadedEmpty() { return k_runtime_load_empty_header(); }
+
+TEST_CASE("cpp11embedtest auto-generated runtime loaded text header",
+          "[cpp11embed][SelfTest]") {
+  REQUIRE(k_runtime_load_text_header_size() == 18);
+  REQUIRE(std::strcmp(k_runtime_load_text_header(), "one line\ntwo lines") ==
+          0);
+  // Only loaded once, however many threads ask for it at the same time
+  std::vector<const char *> data(8);
+  std::vector<std::thread> threads;
+  for (const char *&thread_data : data) {
+    threads.emplace_back(
+        [&thread_data]() { thread_data = k_runtime_load_text_header(); });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  for (const char *const thread_data : data) {
+    REQUIRE(thread_data == k_runtime_load_text_header());
+  }
+}
+
+TEST_CASE(
+    "cpp11embedtest auto-generated runtime loaded binary header with every "
+    "byte value",
+    "[cpp11embed][SelfTest]") {
+  const std::vector<uint8_t> expected = GetAllBytesTestFileContents();
+  REQUIRE(k_runtime_load_all_bytes_header_size() == expected.size());
+  REQUIRE(std::vector<uint8_t>(k_runtime_load_all_bytes_header(),
+                               k_runtime_load_all_bytes_header() +
+                                   k_runtime_load_all_bytes_header_size()) ==
+          expected);
+  REQUIRE(k_runtime_load_all_bytes_header()
+              [k_runtime_load_all_bytes_header_size()] == 0);
+}
+
+TEST_CASE("cpp11embedtest auto-generated runtime loaded empty header",
+          "[cpp11embed][SelfTest]") {
+  REQUIRE(k_runtime_load_empty_header_size() == 0);
+  REQUIRE(k_runtime_load_empty_header()[0] == '\0');
+}
+
+TEST_CASE("cpp11embedtest auto-generated runtime loaded header after changes",
+          "[cpp11embed][SelfTest]") {
+  // Longer than it was when the header was generated
+  const std::string contents = "changed since the header was generated";
+  std::ofstream{RUNTIME_LOAD_CHANGED_FILE, std::ofstream::binary} << contents;
+  REQUIRE(k_runtime_load_changed_header_size() == contents.size());
+  REQUIRE(std::string(k_runtime_load_changed_header()) == contents);
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @returns the contents of test_files/all_bytes.bin
+ */
+inline std::vector<uint8_t> GetAllBytesTestFileContents() {
+  std::vector<uint8_t> contents;
+  for (int i = 0; i < 256; i++) {
+    contents.push_back(static_cast<uint8_t>(i));
+  }
+  for (const char c : {'\0', '\0', 'a', 'b', 'c', '\0'}) {
+    contents.push_back(c);
+  }
+  for (int i = 255; i >= 0; i--) {
+    contents.push_back(static_cast<uint8_t>(i));
+  }
+  return contents;
+}
@@ -1,21 +1,36 @@
 // C++
+#include <algorithm>
 #include <cstring>
+#include <vector>
 
 // 3rd party
 #include <catch2/catch.hpp>
 
 // Project
+#include "AllBytesBinaryHeader.h"
+#include "AllBytesStringLiteralHeader.h"
+#include "Batch/BinaryHeader.h"
+#include "Batch/BinaryStringLiteralHeader.h"
+#include "Batch/Duplicates/BinaryStringLiteralHeader.h"
+#include "Batch/Duplicates/TextHeader.h"
+#include "Batch/TextHeader.h"
 #include "BinaryHeader.h"
 #include "BinaryHeaderWithHeaderGuard.h"
+#include "BinaryStringLiteralHeader.h"
 #include "InASubDirectory/TextHeader2.h"
+#include "SelfTestUtilities.h"
 #include "TextHeader.h"
 #include "TextHeaderWithHeaderGuard.h"
 
 // Include the headers twice to make sure that header guards and pragmas are
 // done correctly. If they aren't compilation will fail due to multiple
 // definitions of the same constants
+#include "AllBytesStringLiteralHeader.h"
 #include "BinaryHeader.h"
 #include "BinaryHeaderWithHeaderGuard.h"
+#include "Batch/Duplicates/BinaryStringLiteralHeader.h"
+#include "Batch/Duplicates/TextHeader.h"
+#include "BinaryStringLiteralHeader.h"
 #include "TextHeader.h"
 #include "TextHeaderWithHeaderGuard.h"
 
@@ -60,3 +75,64 @@ TEST_CASE("cpp11embedtest auto-generated text header in a subdirectory",
   constexpr auto string_length = sizeof(k_text_header_in_a_subdirectory) - 1;
   REQUIRE(std::strlen(k_text_header_in_a_subdirectory) == string_length);
 }
+
+TEST_CASE("cpp11embedtest auto-generated binary string literal header",
+          "[cpp11embed][SelfTest]") {
+  static_assert(k_binary_string_literal_header_size == 18,
+                "Size should be available at compile time");
+  REQUIRE(std::equal(k_binary_header.begin(), k_binary_header.end(),
+                     k_binary_string_literal_header));
+}
+
+TEST_CASE("cpp11embedtest auto-generated binary header with every byte value",
+          "[cpp11embed][SelfTest]") {
+  const std::vector<uint8_t> expected = GetAllBytesTestFileContents();
+  REQUIRE(std::vector<uint8_t>(k_all_bytes_binary_header.begin(),
+                               k_all_bytes_binary_header.end()) == expected);
+}
+
+TEST_CASE(
+    "cpp11embedtest auto-generated binary string literal header with every "
+    "byte value",
+    "[cpp11embed][SelfTest]") {
+  const std::vector<uint8_t> expected = GetAllBytesTestFileContents();
+  REQUIRE(k_all_bytes_string_literal_header_size == expected.size());
+  REQUIRE(std::vector<uint8_t>(k_all_bytes_string_literal_header,
+                               k_all_bytes_string_literal_header +
+                                   k_all_bytes_string_literal_header_size) ==
+          expected);
+}
+
+TEST_CASE("cpp11embedtest auto-generated batch headers",
+          "[cpp11embed][SelfTest]") {
+  REQUIRE(std::strcmp(k_batch_text_header, "a\tb\tcde\tfg") == 0);
+  const std::vector<uint8_t> expected = GetAllBytesTestFileContents();
+  REQUIRE(std::vector<uint8_t>(k_batch_binary_header.begin(),
+                               k_batch_binary_header.end()) == expected);
+  REQUIRE(std::vector<uint8_t>(k_batch_binary_string_literal_header,
+                               k_batch_binary_string_literal_header +
+                                   k_batch_binary_string_literal_header_size) ==
+          expected);
+}
+
+TEST_CASE("cpp11embedtest auto-generated deduplicated batch headers",
+          "[cpp11embed][SelfTest]") {
+  // Refer to the data of the earlier headers with the same input rather
+  // than copies of it
+  static_assert(sizeof(k_batch_duplicate_text_header) ==
+                    sizeof(k_batch_text_header),
+                "Should be the same array");
+  REQUIRE(&k_batch_duplicate_text_header == &k_batch_text_header);
+  REQUIRE(std::strcmp(k_batch_duplicate_text_header, "a\tb\tcde\tfg") == 0);
+
+  static_assert(k_batch_duplicate_binary_string_literal_header_size ==
+                    k_batch_binary_string_literal_header_size,
+                "Size should be available at compile time");
+  REQUIRE(&k_batch_duplicate_binary_string_literal_header ==
+          &k_batch_binary_string_literal_header);
+  REQUIRE(std::vector<uint8_t>(
+              k_batch_duplicate_binary_string_literal_header,
+              k_batch_duplicate_binary_string_literal_header +
+                  k_batch_duplicate_binary_string_literal_header_size) ==
+          GetAllBytesTestFileContents());
+}
@@ -0,0 +1,65 @@
+// C++
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 3rd party
+#include <catch2/catch.hpp>
+
+// Project
+#include "AllBytesBigEndianWordHeader.h"
+#include "AllBytesLittleEndianWordHeader.h"
+#include "SelfTestUtilities.h"
+
+// Include the headers twice to make sure that header guards and pragmas are
+// done correctly
+#include "AllBytesBigEndianWordHeader.h"
+#include "AllBytesLittleEndianWordHeader.h"
+
+namespace {
+/**
+ * @returns the bytes packed into the words in the given order (including
+ * any padding)
+ */
+template <typename Word, size_t number_of_words>
+std::vector<uint8_t> UnpackWords(
+    const std::array<Word, number_of_words> &words, const bool big_endian) {
+  std::vector<uint8_t> bytes;
+  for (const Word word : words) {
+    for (size_t i = 0; i < sizeof(Word); i++) {
+      const size_t shift = 8 * (big_endian ? sizeof(Word) - 1 - i : i);
+      bytes.push_back(static_cast<uint8_t>(word >> shift));
+    }
+  }
+  return bytes;
+}
+}  // namespace
+
+TEST_CASE("cpp11embedtest auto-generated little endian word header",
+          "[cpp11embed][SelfTest]") {
+  static_assert(k_all_bytes_little_endian_word_header_size == 518,
+                "Size should be available at compile time");
+  static_assert(k_all_bytes_little_endian_word_header.size() == 130,
+                "The last word should be padded");
+  REQUIRE(reinterpret_cast<std::uintptr_t>(
+              k_all_bytes_little_endian_word_header.data()) %
+              32 ==
+          0);
+
+  std::vector<uint8_t> expected = GetAllBytesTestFileContents();
+  expected.resize(130 * 4, 0);
+  REQUIRE(UnpackWords(k_all_bytes_little_endian_word_header, false) ==
+          expected);
+}
+
+TEST_CASE("cpp11embedtest auto-generated big endian word header",
+          "[cpp11embed][SelfTest]") {
+  static_assert(k_all_bytes_big_endian_word_header_size == 518,
+                "Size should be available at compile time");
+  static_assert(k_all_bytes_big_endian_word_header.size() == 65,
+                "The last word should be padded");
+  std::vector<uint8_t> expected = GetAllBytesTestFileContents();
+  expected.resize(65 * 8, 0);
+  REQUIRE(UnpackWords(k_all_bytes_big_endian_word_header, true) == expected);
+}
@@ -0,0 +1,12 @@
+#version 330 core
+// Passes the colour straight through
+#define SCALE (0.5)
+
+in vec4 colour;
+out vec4 fragment_colour;
+
+/* The output is
+   dimmed */
+void main() {
+    fragment_colour = colour * SCALE - -0.25;
+}
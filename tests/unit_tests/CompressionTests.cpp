@@ -0,0 +1,136 @@
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Compression.h"
+#include "Lib.h"
+
+namespace {
+std::vector<char> Compress(const std::string &data) {
+  return cpp11embed::CompressLz4Block({data.data(), data.size()});
+}
+
+bool Decompress(const std::vector<char> &compressed, std::string &data) {
+  return cpp11embed::DecompressLz4Block(
+      {compressed.data(), compressed.size()}, &data[0], data.size());
+}
+
+std::string GetRandomBytes(const size_t size) {
+  std::mt19937 generator{1234};
+  std::string data;
+  for (size_t i = 0; i < size; i++) {
+    data.push_back(static_cast<char>(generator() & 0xFF));
+  }
+  return data;
+}
+
+std::string GetRepetitiveText() {
+  std::string data;
+  for (int i = 0; i < 1000; i++) {
+    data += "line " + std::to_string(i % 37) + " of some repetitive text\n";
+  }
+  return data;
+}
+}  // namespace
+
+TEST_CASE("cpp11embed::CompressLz4Block round trip",
+          "[cpp11embed][Compression]") {
+  const std::string data = GENERATE(
+      as<std::string>{}, "", "a", "abcdefghijklm", std::string(100000, 'x'),
+      std::string{"\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0", 20},
+      GetRandomBytes(100000), GetRepetitiveText(),
+      // Longer than the window that matches can refer back into
+      GetRandomBytes(70000) + GetRandomBytes(70000));
+  const std::vector<char> compressed = Compress(data);
+  std::string decompressed(data.size(), '\0');
+  REQUIRE(Decompress(compressed, decompressed));
+  REQUIRE(decompressed == data);
+}
+
+TEST_CASE("cpp11embed::CompressLz4Block compresses repetitive data",
+          "[cpp11embed][Compression]") {
+  const std::string data = GetRepetitiveText();
+  REQUIRE(Compress(data).size() < data.size() / 10);
+}
+
+TEST_CASE("cpp11embed::CompressLz4Block incompressible data",
+          "[cpp11embed][Compression]") {
+  const std::string data = GetRandomBytes(100000);
+  REQUIRE(Compress(data).size() <= data.size() + data.size() / 255 + 16);
+}
+
+TEST_CASE("cpp11embed::DecompressLz4Block literals only",
+          "[cpp11embed][Compression]") {
+  // A token for 3 literals followed by them
+  const std::vector<char> compressed{0x30, 'a', 'b', 'c'};
+  std::string decompressed(3, '\0');
+  REQUIRE(Decompress(compressed, decompressed));
+  REQUIRE(decompressed == "abc");
+}
+
+TEST_CASE("cpp11embed::DecompressLz4Block overlapping match",
+          "[cpp11embed][Compression]") {
+  // "ab" then a match of 6 bytes 2 back, then a final empty sequence
+  const std::vector<char> compressed{0x22, 'a', 'b', 2, 0, 0x00};
+  std::string decompressed(8, '\0');
+  REQUIRE(Decompress(compressed, decompressed));
+  REQUIRE(decompressed == "abababab");
+}
+
+TEST_CASE("cpp11embed::DecompressLz4Block corrupt input",
+          "[cpp11embed][Compression]") {
+  const std::vector<char> compressed = GENERATE(
+      // Not enough literals
+      std::vector<char>{0x30, 'a', 'b'},
+      // Match offset before the start of the output
+      std::vector<char>{0x10, 'a', 5, 0, 0x00},
+      // Zero match offset
+      std::vector<char>{0x10, 'a', 0, 0, 0x00},
+      // Missing match offset
+      std::vector<char>{0x10, 'a', 1},
+      // Missing length continuation
+      std::vector<char>{static_cast<char>(0xF0)});
+  std::string decompressed(8, '\0');
+  REQUIRE_FALSE(Decompress(compressed, decompressed));
+}
+
+TEST_CASE("cpp11embed::DecompressLz4Block wrong output size",
+          "[cpp11embed][Compression]") {
+  const std::vector<char> compressed = Compress("abcdefghijklmnop");
+  std::string too_small(15, '\0');
+  REQUIRE_FALSE(Decompress(compressed, too_small));
+  std::string too_big(17, '\0');
+  REQUIRE_FALSE(Decompress(compressed, too_big));
+}
+
+TEST_CASE("cpp11embed::OutputCompressedDataHeader",
+          "[cpp11embed][Compression]") {
+  const std::string input = GetRepetitiveText();
+  std::istringstream input_stream{input};
+  std::ostringstream header;
+  cpp11embed::OutputCompressedDataHeader("test", false, true, input_stream,
+                                         header);
+  const std::string header_string = header.str();
+  REQUIRE(header_string.find("constexpr std::size_t test_size = " +
+                             std::to_string(input.size()) + ";") !=
+          std::string::npos);
+  REQUIRE(header_string.find("inline const char *test()") !=
+          std::string::npos);
+  REQUIRE(header_string.find("inline bool test_decompress(void *buffer)") !=
+          std::string::npos);
+  // Corrupt data is never handed out as if it were the real data
+  REQUIRE(header_string.find("if (!test_decompress(buffer.get())) {") !=
+          std::string::npos);
+  // The compressed data should be much smaller than the input
+  REQUIRE(header_string.size() < input.size());
+
+  std::ostringstream binary_header;
+  cpp11embed::OutputCompressedDataHeader(
+      "test", false, false, cpp11embed::ByteSpan{input.data(), input.size()},
+      binary_header);
+  REQUIRE(binary_header.str().find("inline const unsigned char *test()") !=
+          std::string::npos);
+}
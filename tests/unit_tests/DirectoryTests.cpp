@@ -0,0 +1,25 @@
+#include <catch2/catch.hpp>
+#include <string>
+#include <vector>
+
+#include "Directory.h"
+
+TEST_CASE("cpp11embed::ListFilesInDirectory", "[cpp11embed][Directory]") {
+  std::vector<std::string> relative_paths;
+  REQUIRE(cpp11embed::ListFilesInDirectory(
+      CPP11_EMBED_TEST_FILES_DIR "/directory", relative_paths));
+  // Sorted and separated by / with no directories listed
+  REQUIRE(relative_paths ==
+          std::vector<std::string>{"hello.txt", "nested/deeper/empty.bin",
+                                   "nested/file with spaces.txt",
+                                   "nested/hello_copy.txt",
+                                   "nested/world.txt"});
+}
+
+TEST_CASE("cpp11embed::ListFilesInDirectory directory does not exist",
+          "[cpp11embed][Directory]") {
+  std::vector<std::string> relative_paths;
+  REQUIRE_FALSE(cpp11embed::ListFilesInDirectory(
+      "Cpp11EmbedDoesNotExist", relative_paths));
+  REQUIRE(relative_paths.empty());
+}
@@ -0,0 +1,108 @@
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+#include "ElfObject.h"
+
+namespace {
+std::string GetElfObject(const std::string &identifier,
+                         const cpp11embed::ElfMachine machine,
+                         const size_t alignment, const std::string &data) {
+  std::istringstream input_stream{data};
+  std::ostringstream output_stream;
+  REQUIRE(cpp11embed::OutputElfObject(identifier, machine, alignment,
+                                      input_stream, data.size(),
+                                      output_stream));
+  return output_stream.str();
+}
+
+uint64_t ReadLittleEndian(const std::string &bytes, const size_t offset,
+                          const size_t size) {
+  uint64_t value = 0;
+  for (size_t i = 0; i < size; i++) {
+    value |= static_cast<uint64_t>(static_cast<uint8_t>(bytes[offset + i]))
+             << (8 * i);
+  }
+  return value;
+}
+
+struct Section {
+  uint64_t offset;
+  uint64_t size;
+  uint64_t alignment;
+};
+
+Section GetSection(const std::string &object, const size_t index) {
+  const size_t header_offset =
+      static_cast<size_t>(ReadLittleEndian(object, 0x28, 8)) + index * 64;
+  return {ReadLittleEndian(object, header_offset + 0x18, 8),
+          ReadLittleEndian(object, header_offset + 0x20, 8),
+          ReadLittleEndian(object, header_offset + 0x30, 8)};
+}
+}  // namespace
+
+TEST_CASE("cpp11embed::OutputElfObject header",
+          "[cpp11embed][OutputElfObject]") {
+  const std::string object = GetElfObject(
+      "identifier", cpp11embed::ElfMachine::k_x86_64, 16, "abc");
+  REQUIRE(object.substr(0, 4) == "\x7f"
+                                 "ELF");
+  // 64 bit little endian relocatable object
+  REQUIRE(object[4] == 2);
+  REQUIRE(object[5] == 1);
+  REQUIRE(ReadLittleEndian(object, 0x10, 2) == 1);
+  REQUIRE(ReadLittleEndian(object, 0x12, 2) == 62);
+  REQUIRE(GetElfObject("identifier", cpp11embed::ElfMachine::k_aarch64, 16,
+                       "abc")[0x12] == static_cast<char>(183));
+}
+
+TEST_CASE("cpp11embed::OutputElfObject data and size in .rodata",
+          "[cpp11embed][OutputElfObject]") {
+  const size_t alignment = GENERATE(1, 16, 4096);
+  CAPTURE(alignment);
+  const std::string data{"a\0bcdefghij", 11};
+  const std::string object = GetElfObject(
+      "identifier", cpp11embed::ElfMachine::k_x86_64, alignment, data);
+  const Section rodata = GetSection(object, 1);
+  REQUIRE(rodata.offset % alignment == 0);
+  REQUIRE(rodata.alignment >= alignment);
+  REQUIRE(object.substr(static_cast<size_t>(rodata.offset), data.size()) ==
+          data);
+  // Size is stored after the data at the next 8 byte boundary
+  REQUIRE(rodata.size == 24);
+  REQUIRE(ReadLittleEndian(object, static_cast<size_t>(rodata.offset) + 16,
+                           8) == data.size());
+}
+
+TEST_CASE("cpp11embed::OutputElfObject symbol names",
+          "[cpp11embed][OutputElfObject]") {
+  const std::string object = GetElfObject(
+      "identifier", cpp11embed::ElfMachine::k_x86_64, 16, "abc");
+  const Section strtab = GetSection(object, 4);
+  REQUIRE(object.substr(static_cast<size_t>(strtab.offset),
+                        static_cast<size_t>(strtab.size)) ==
+          std::string{"\0identifier\0identifier_size\0", 28});
+}
+
+TEST_CASE("cpp11embed::OutputElfObject input too short",
+          "[cpp11embed][OutputElfObject]") {
+  std::istringstream input_stream{"abc"};
+  std::ostringstream output_stream;
+  REQUIRE_FALSE(cpp11embed::OutputElfObject(
+      "identifier", cpp11embed::ElfMachine::k_x86_64, 16, input_stream, 4,
+      output_stream));
+}
+
+TEST_CASE("cpp11embed::OutputElfObject ByteSpan",
+          "[cpp11embed][OutputElfObject]") {
+  const std::string data = GENERATE(as<std::string>{}, "", "abc",
+                                    std::string(100000, 'x'));
+  const cpp11embed::ElfMachine machine = GENERATE(
+      cpp11embed::ElfMachine::k_x86_64, cpp11embed::ElfMachine::k_aarch64);
+  std::ostringstream output_stream;
+  cpp11embed::OutputElfObject("identifier", machine, 32,
+                              cpp11embed::ByteSpan{data.data(), data.size()},
+                              output_stream);
+  REQUIRE(output_stream.str() == GetElfObject("identifier", machine, 32, data));
+}
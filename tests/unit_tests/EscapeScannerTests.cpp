@@ -0,0 +1,56 @@
+#include <catch2/catch.hpp>
+#include <cstddef>
+#include <sstream>
+#include <string>
+
+#include "EscapeScanner.h"
+#include "Lib.h"
+
+namespace {
+bool NeedsEscaping(const char c) {
+  std::ostringstream escaped;
+  cpp11embed::OutputEscapedCharacter(c, escaped);
+  return escaped.str() != std::string{c};
+}
+}  // namespace
+
+TEST_CASE("cpp11embed::FindNextCharacterToEscape nothing to escape",
+          "[cpp11embed][FindNextCharacterToEscape]") {
+  const size_t size = GENERATE(range(0, 100));
+  const std::string text(size, 'a');
+  REQUIRE(cpp11embed::FindNextCharacterToEscape(text.data(), text.size()) ==
+          size);
+}
+
+TEST_CASE("cpp11embed::FindNextCharacterToEscape every byte value",
+          "[cpp11embed][FindNextCharacterToEscape]") {
+  // Every position in and after each vector so that all of the
+  // implementations (and the scalar code that handles what is left over) are
+  // covered
+  const size_t position = GENERATE(range(0, 70));
+  for (int value = 0; value < 256; value++) {
+    const char c = static_cast<char>(value);
+    std::string text(position, 'a');
+    text += c;
+    text += std::string(10, '"');
+    const size_t expected = NeedsEscaping(c) ? position : position + 1;
+    REQUIRE(cpp11embed::FindNextCharacterToEscape(text.data(), text.size()) ==
+            expected);
+  }
+}
+
+TEST_CASE("cpp11embed::FindNextCharacterToEscape first of several",
+          "[cpp11embed][FindNextCharacterToEscape]") {
+  std::string text(200, 'x');
+  text[150] = '\n';
+  text[77] = '\\';
+  text[40] = '?';
+  REQUIRE(cpp11embed::FindNextCharacterToEscape(text.data(), text.size()) ==
+          40);
+  REQUIRE(cpp11embed::FindNextCharacterToEscape(text.data() + 41,
+                                                text.size() - 41) == 36);
+  REQUIRE(cpp11embed::FindNextCharacterToEscape(text.data() + 78,
+                                                text.size() - 78) == 72);
+  // Only look at the given size
+  REQUIRE(cpp11embed::FindNextCharacterToEscape(text.data(), 40) == 40);
+}
@@ -0,0 +1,92 @@
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <utility>
+
+#include "Hash.h"
+
+namespace {
+uint64_t GetXxh64(const std::string &data, const uint64_t seed = 0) {
+  cpp11embed::Xxh64 hash{seed};
+  hash.Update(data.data(), data.size());
+  return hash.Digest();
+}
+
+// Long enough to go through every path in the hash function
+std::string GetLongString() {
+  std::string data;
+  for (int i = 0; i < 1000; i++) {
+    data.push_back(static_cast<char>(i * 7));
+  }
+  return data;
+}
+}  // namespace
+
+TEST_CASE("Xxh64 reference values", "[cpp11embed][Xxh64]") {
+  const auto input_and_hash = GENERATE(
+      std::make_pair(std::string{}, 0xEF46DB3751D8E999ULL),
+      std::make_pair(std::string{"a"}, 0xD24EC4F1A98C6E5BULL),
+      std::make_pair(std::string{"abc"}, 0x44BC2CF5AD770999ULL),
+      std::make_pair(std::string{"Nobody inspects the spammish repetition"},
+                     0xFBCEA83C8A378BF1ULL));
+  REQUIRE(GetXxh64(input_and_hash.first) == input_and_hash.second);
+}
+
+TEST_CASE("Xxh64 seed", "[cpp11embed][Xxh64]") {
+  REQUIRE(GetXxh64("abc", 1) != GetXxh64("abc", 0));
+}
+
+TEST_CASE("Xxh64 incremental updates", "[cpp11embed][Xxh64]") {
+  const std::string data = GetLongString();
+  const size_t piece_size = GENERATE(1, 3, 31, 32, 33, 100, 999);
+  cpp11embed::Xxh64 hash;
+  for (size_t i = 0; i < data.size(); i += piece_size) {
+    hash.Update(data.data() + i, std::min(piece_size, data.size() - i));
+  }
+  REQUIRE(hash.Digest() == GetXxh64(data));
+}
+
+TEST_CASE("Xxh64 empty updates", "[cpp11embed][Xxh64]") {
+  // As for an empty mapped file
+  cpp11embed::Xxh64 hash;
+  hash.Update(nullptr, 0);
+  hash.Update("abc", 3);
+  hash.Update(nullptr, 0);
+  REQUIRE(hash.Digest() == GetXxh64("abc"));
+}
+
+TEST_CASE("Xxh64 UpdateFromStream", "[cpp11embed][Xxh64]") {
+  const std::string data = GetLongString();
+  std::istringstream input_stream{data};
+  cpp11embed::Xxh64 hash;
+  REQUIRE(cpp11embed::UpdateFromStream(hash, input_stream));
+  REQUIRE(hash.Digest() == GetXxh64(data));
+}
+
+namespace {
+uint32_t GetCrc32c(const std::string &data) {
+  cpp11embed::Crc32c crc32c;
+  crc32c.Update(data.data(), data.size());
+  return crc32c.Digest();
+}
+}  // namespace
+
+TEST_CASE("Crc32c reference values", "[cpp11embed][Crc32c]") {
+  const auto input_and_checksum =
+      GENERATE(std::make_pair(std::string{}, 0x00000000U),
+               std::make_pair(std::string{"abc"}, 0x364B3FB7U),
+               std::make_pair(std::string{"123456789"}, 0xE3069283U));
+  REQUIRE(GetCrc32c(input_and_checksum.first) == input_and_checksum.second);
+}
+
+TEST_CASE("Crc32c incremental updates", "[cpp11embed][Crc32c]") {
+  const std::string data = GetLongString();
+  const size_t piece_size = GENERATE(1, 3, 7, 8, 9, 100, 999);
+  cpp11embed::Crc32c crc32c;
+  for (size_t i = 0; i < data.size(); i += piece_size) {
+    crc32c.Update(data.data() + i, std::min(piece_size, data.size() - i));
+  }
+  REQUIRE(crc32c.Digest() == GetCrc32c(data));
+}
@@ -1,6 +1,12 @@
 #include <catch2/catch.hpp>
+#include <functional>
 #include <limits>
 #include <sstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 #include "Lib.h"
 
@@ -43,6 +49,61 @@ std::string GetBinaryHeader(const std::string& identifier,
                                      output_stream);
   return output_stream.str();
 }
+
+/**
+ * Reads from a string without being able to seek, like a pipe
+ */
+class UnseekableStreambuf : public std::streambuf {
+ public:
+  explicit UnseekableStreambuf(std::string data) : data_(std::move(data)) {
+    setg(&data_[0], &data_[0], &data_[0] + data_.size());
+  }
+
+ private:
+  std::string data_;
+};
+
+/**
+ * Reads from a string but claims to be bigger when seeked to the end, like a
+ * file that is truncated while it is being read
+ */
+class TruncatedStreambuf : public std::streambuf {
+ public:
+  TruncatedStreambuf(std::string data, const size_t claimed_size)
+      : data_(std::move(data)), claimed_size_(claimed_size) {
+    setg(&data_[0], &data_[0], &data_[0] + data_.size());
+  }
+
+ protected:
+  pos_type seekoff(const off_type offset, const std::ios_base::seekdir dir,
+                   std::ios_base::openmode) override {
+    if (dir == std::ios_base::end && offset == 0) {
+      at_claimed_end_ = true;
+      return pos_type(static_cast<off_type>(claimed_size_));
+    }
+    if (dir == std::ios_base::cur && offset == 0) {
+      return at_claimed_end_
+                 ? pos_type(static_cast<off_type>(claimed_size_))
+                 : pos_type(gptr() - eback());
+    }
+    return pos_type(off_type(-1));
+  }
+
+  pos_type seekpos(const pos_type position,
+                   std::ios_base::openmode) override {
+    if (position < 0 || position > static_cast<off_type>(data_.size())) {
+      return pos_type(off_type(-1));
+    }
+    at_claimed_end_ = false;
+    setg(eback(), eback() + static_cast<off_type>(position), egptr());
+    return position;
+  }
+
+ private:
+  std::string data_;
+  size_t claimed_size_;
+  bool at_claimed_end_ = false;
+};
 }  // namespace
 
 TEST_CASE(
@@ -205,3 +266,724 @@ TEST_CASE("cpp11embed::OutputBinaryDataHeader {9, 12, 3}",
           "constexpr std::array<uint8_t, 3> another_identifier{9, 12, "
           "3};\n\n#endif\n");
 }
+
+TEST_CASE("cpp11embed::OutputBinaryDataHeader layouts",
+          "[cpp11embed][OutputBinaryDataHeader]") {
+  constexpr char input[]{1, 2, 3, 4, 5, '\xFF', 7};
+  const auto get_header = [&](const cpp11embed::BinaryLayout& layout) {
+    std::vector<char> output_vector;
+    cpp11embed::VectorSink sink{output_vector};
+    cpp11embed::OutputBinaryDataHeader(
+        "id", false, cpp11embed::ByteSpan{input, sizeof(input)}, sink, 1,
+        layout);
+    return std::string(output_vector.begin(), output_vector.end());
+  };
+  cpp11embed::BinaryLayout layout;
+  layout.alignment = 16;
+  REQUIRE(get_header(layout) ==
+          "#pragma once\n\n#include <array>\n#include <cstdint>\n\n"
+          "alignas(16) constexpr std::array<uint8_t, 7> id{1, 2, 3, 4, 5, "
+          "255, 7};\n");
+
+  layout.word_size = 2;
+  REQUIRE(get_header(layout) ==
+          "#pragma once\n\n#include <array>\n#include <cstddef>\n#include "
+          "<cstdint>\n\n// Little endian 2 byte words, the last padded with "
+          "zeros\nalignas(16) constexpr std::array<uint16_t, 4> id{0x0201, "
+          "0x0403, 0xff05, 0x0007};\nconstexpr std::size_t id_size = 7;\n");
+
+  // No alignas when the words are already at least as aligned as asked for
+  layout.alignment = 4;
+  layout.word_size = 8;
+  layout.big_endian = true;
+  REQUIRE(get_header(layout) ==
+          "#pragma once\n\n#include <array>\n#include <cstddef>\n#include "
+          "<cstdint>\n\n// Big endian 8 byte words, the last padded with "
+          "zeros\nconstexpr std::array<uint64_t, 1> "
+          "id{0x0102030405ff0700};\nconstexpr std::size_t id_size = 7;\n");
+}
+
+TEST_CASE("cpp11embed::OutputBinaryDataHeader unseekable input",
+          "[cpp11embed][OutputBinaryDataHeader]") {
+  const auto get_header = [](const std::string& input, const bool seekable,
+                             const unsigned number_of_jobs,
+                             const size_t word_size) {
+    std::istringstream seekable_stream{input};
+    UnseekableStreambuf streambuf{input};
+    std::istream unseekable_stream{&streambuf};
+    cpp11embed::BinaryLayout layout;
+    layout.word_size = word_size;
+    std::vector<char> output_vector;
+    cpp11embed::VectorSink sink{output_vector};
+    cpp11embed::OutputBinaryDataHeader(
+        "id", false, seekable ? seekable_stream : unseekable_stream, sink,
+        number_of_jobs, layout);
+    return std::string(output_vector.begin(), output_vector.end());
+  };
+  const auto get_initialiser = [](const std::string& header) {
+    const size_t start = header.find('{');
+    return header.substr(start, header.find('}') - start);
+  };
+
+  // Small inputs are embedded just as they would be from a file
+  REQUIRE(get_header("abc", false, 1, 1) == get_header("abc", true, 1, 1));
+  REQUIRE(get_header("", false, 1, 1) == get_header("", true, 1, 1));
+
+  // Bigger ones are streamed into a plain array
+  std::string input;
+  for (int i = 0; i < 1024 * 1024 + 3; i++) {
+    input.push_back(static_cast<char>(i % 251));
+  }
+  const unsigned number_of_jobs = GENERATE(1u, 3u);
+  const size_t word_size = GENERATE(size_t{1}, size_t{8});
+  const std::string header =
+      get_header(input, false, number_of_jobs, word_size);
+  REQUIRE(header.find(word_size == 1 ? "\nconstexpr uint8_t id[] = {"
+                                     : "\nconstexpr uint64_t id[] = {") !=
+          std::string::npos);
+  REQUIRE(header.find("};\nconstexpr std::size_t id_size = 1048579;\n") !=
+          std::string::npos);
+  REQUIRE(get_initialiser(header) ==
+          get_initialiser(get_header(input, true, 1, word_size)));
+}
+
+TEST_CASE("cpp11embed::OutputBinaryDataHeader input shorter than its size",
+          "[cpp11embed][OutputBinaryDataHeader]") {
+  TruncatedStreambuf streambuf{"abc", 10};
+  std::istream input_stream{&streambuf};
+  std::ostringstream output_stream;
+  REQUIRE_THROWS_AS(cpp11embed::OutputBinaryDataHeader(
+                        "id", false, input_stream, output_stream),
+                    std::runtime_error);
+}
+
+TEST_CASE("cpp11embed::GetBinaryInitialiser empty input",
+          "[cpp11embed][GetBinaryInitialiser]") {
+  std::istringstream input_stream{""};
+  const cpp11embed::InitialiserAndNumberOfElements initialiser =
+      cpp11embed::GetBinaryInitialiser(input_stream);
+  REQUIRE(initialiser.initialiser == "{}");
+  REQUIRE(initialiser.number_of_elements == 0);
+}
+
+TEST_CASE("cpp11embed::GetBinaryInitialiser input larger than a block",
+          "[cpp11embed][GetBinaryInitialiser]") {
+  std::string input;
+  std::string expected_output = "{";
+  for (size_t i = 0; i < 200000; i++) {
+    const auto byte = static_cast<uint8_t>(i * 7);
+    input.push_back(static_cast<char>(byte));
+    if (i != 0) {
+      expected_output += ", ";
+    }
+    expected_output += std::to_string(byte);
+  }
+  expected_output += "}";
+  std::istringstream input_stream{input};
+  const cpp11embed::InitialiserAndNumberOfElements initialiser =
+      cpp11embed::GetBinaryInitialiser(input_stream);
+  REQUIRE(initialiser.initialiser == expected_output);
+  REQUIRE(initialiser.number_of_elements == input.size());
+}
+
+TEST_CASE("cpp11embed::OutputBinaryInitialiser stops after max_bytes",
+          "[cpp11embed][OutputBinaryInitialiser]") {
+  std::istringstream input_stream{std::string{"\x01\x02\x03\x04", 4}};
+  std::ostringstream output_stream;
+  REQUIRE(cpp11embed::OutputBinaryInitialiser(input_stream, output_stream,
+                                              2) == 2);
+  REQUIRE(output_stream.str() == "{1, 2}");
+}
+
+TEST_CASE("cpp11embed::GetRemainingStreamSize",
+          "[cpp11embed][GetRemainingStreamSize]") {
+  std::istringstream input_stream{"abcdef"};
+  REQUIRE(cpp11embed::GetRemainingStreamSize(input_stream) == 6);
+  input_stream.get();
+  REQUIRE(cpp11embed::GetRemainingStreamSize(input_stream) == 5);
+  // Querying the size must not move the read position
+  REQUIRE(input_stream.get() == 'b');
+}
+
+TEST_CASE("cpp11embed::OutputEscapedByte printable characters",
+          "[cpp11embed][OutputEscapedByte]") {
+  for (char c = ' '; c <= '~'; c++) {
+    CAPTURE(c);
+    std::ostringstream escaped_byte;
+    cpp11embed::OutputEscapedByte(c, escaped_byte);
+    REQUIRE(escaped_byte.str() == GetEscapedCharacterChar(c));
+  }
+}
+
+TEST_CASE("cpp11embed::OutputEscapedByte non-printable characters",
+          "[cpp11embed][OutputEscapedByte]") {
+  const auto escape = [](const char c) {
+    std::ostringstream escaped_byte;
+    cpp11embed::OutputEscapedByte(c, escaped_byte);
+    return escaped_byte.str();
+  };
+  REQUIRE(escape('\0') == "\\000");
+  REQUIRE(escape('\n') == "\\n");
+  REQUIRE(escape('\x1b') == "\\033");
+  REQUIRE(escape('\x7f') == "\\177");
+  REQUIRE(escape(static_cast<char>(0xff)) == "\\377");
+}
+
+TEST_CASE("cpp11embed::OutputBinaryStringLiteral",
+          "[cpp11embed][OutputBinaryStringLiteral]") {
+  std::istringstream input_stream{std::string{"a\0\"1\x80", 5}};
+  std::ostringstream output_stream;
+  REQUIRE(cpp11embed::OutputBinaryStringLiteral(input_stream, output_stream) ==
+          5);
+  REQUIRE(output_stream.str() == R"("a\000\"1\200")");
+}
+
+TEST_CASE("cpp11embed::OutputBinaryStringLiteral splits long literals",
+          "[cpp11embed][OutputBinaryStringLiteral]") {
+  std::istringstream input_stream{std::string(300, 'x')};
+  std::ostringstream output_stream;
+  REQUIRE(cpp11embed::OutputBinaryStringLiteral(input_stream, output_stream) ==
+          300);
+  REQUIRE(output_stream.str() == "\"" + std::string(256, 'x') + "\"\n    \"" +
+                                     std::string(44, 'x') + "\"");
+}
+
+TEST_CASE("cpp11embed::OutputBinaryStringLiteralHeader",
+          "[cpp11embed][OutputBinaryStringLiteralHeader]") {
+  std::istringstream input_stream{std::string{"\x01\x02", 2}};
+  std::ostringstream output_stream;
+  cpp11embed::OutputBinaryStringLiteralHeader("identifier", false,
+                                              input_stream, output_stream);
+  REQUIRE(output_stream.str() ==
+          "#pragma once\n\n#include <cstddef>\n\n"
+          "constexpr unsigned char identifier[] =\n    \"\\001\\002\";\n"
+          "constexpr std::size_t identifier_size = sizeof(identifier) - 1;\n");
+}
+
+TEST_CASE("cpp11embed::OutputRuntimeLoadHeader",
+          "[cpp11embed][OutputRuntimeLoadHeader]") {
+  const bool text = GENERATE(true, false);
+  std::istringstream input_stream{std::string{"a\"\x01", 3}};
+  std::ostringstream output_stream;
+  cpp11embed::OutputRuntimeLoadHeader("identifier", false, text,
+                                      "/path/to/\"input\".txt", input_stream,
+                                      output_stream);
+  const std::string output = output_stream.str();
+  // Loaded from the input's path or embedded as usual depending on
+  // CPP11_EMBED_RUNTIME_LOAD, with the same accessor either way
+  const size_t runtime_load = output.find("#ifdef CPP11_EMBED_RUNTIME_LOAD\n");
+  const size_t embedded = output.find("#else\n", runtime_load);
+  REQUIRE(runtime_load != std::string::npos);
+  REQUIRE(embedded != std::string::npos);
+  REQUIRE(output.find("File file(\"/path/to/\\\"input\\\".txt\");") <
+          embedded);
+  REQUIRE(output.find("inline std::size_t identifier_size() {") < embedded);
+  const std::string element_type = text ? "char" : "unsigned char";
+  const std::string accessor =
+      "inline const " + element_type + " *identifier() {";
+  REQUIRE(output.find(accessor) < embedded);
+  // Only binary data has every byte escaped
+  REQUIRE(output.find(text ? "constexpr char identifier_data[] = "
+                             "\"a\\\"\x01\";"
+                           : "constexpr unsigned char identifier_data[] =\n"
+                             "    \"a\\\"\\001\";",
+                      embedded) != std::string::npos);
+  REQUIRE(output.find("inline const " + element_type +
+                          " *identifier() { return identifier_data; }",
+                      embedded) != std::string::npos);
+  REQUIRE(output.find("constexpr std::size_t identifier_size() { return "
+                      "sizeof(identifier_data) - 1; }",
+                      embedded) != std::string::npos);
+  REQUIRE(output.compare(output.size() - 7, 7, "#endif\n") == 0);
+}
+
+TEST_CASE("cpp11embed::OutputExternBinaryDataHeader",
+          "[cpp11embed][OutputExternBinaryDataHeader]") {
+  std::ostringstream output_stream;
+  cpp11embed::OutputExternBinaryDataHeader("identifier", true, 12,
+                                           output_stream);
+  REQUIRE(output_stream.str() ==
+          "#ifndef IDENTIFIER\n#define IDENTIFIER\n\n"
+          "#include <cstddef>\n#include <cstdint>\n\n"
+          "extern \"C\" const uint8_t identifier[12];\n"
+          "extern \"C\" const std::size_t identifier_size;\n\n#endif\n");
+}
+
+TEST_CASE("cpp11embed::OutputExternBinaryDataHeader no data",
+          "[cpp11embed][OutputExternBinaryDataHeader]") {
+  // Zero length arrays are not valid C++
+  std::ostringstream output_stream;
+  cpp11embed::OutputExternBinaryDataHeader("identifier", false, 0,
+                                           output_stream);
+  REQUIRE(output_stream.str().find("identifier[];") != std::string::npos);
+}
+
+TEST_CASE("cpp11embed::OutputIncbinAssembly",
+          "[cpp11embed][OutputIncbinAssembly]") {
+  std::ostringstream output_stream;
+  cpp11embed::OutputIncbinAssembly("identifier", "/a \"quoted\" \\path",
+                                   output_stream);
+  const std::string assembly = output_stream.str();
+  REQUIRE(assembly.find("    .global identifier\n") != std::string::npos);
+  REQUIRE(assembly.find("    .global identifier_size\n") != std::string::npos);
+  REQUIRE(assembly.find("identifier:\n    .incbin \"/a \\\"quoted\\\" "
+                        "\\\\path\"\n") != std::string::npos);
+}
+
+TEST_CASE("OutputMakeDepfile", "[cpp11embed][OutputMakeDepfile]") {
+  using Parameters = std::tuple<std::string, std::vector<std::string>,
+                                std::string>;
+  const auto parameters = GENERATE(
+      Parameters{"out.h", {}, "out.h:\n"},
+      Parameters{"out.h", {"in.txt"}, "out.h: in.txt\n"},
+      Parameters{"/a/out.h", {"/b/in.txt", "c"}, "/a/out.h: /b/in.txt c\n"},
+      Parameters{"my out.h", {"a b#c$d"}, "my\\ out.h: a\\ b\\#c$$d\n"});
+  std::ostringstream output_stream;
+  cpp11embed::OutputMakeDepfile(std::get<0>(parameters),
+                                std::get<1>(parameters), output_stream);
+  REQUIRE(output_stream.str() == std::get<2>(parameters));
+}
+
+TEST_CASE("cpp11embed ByteSpan overloads match the stream versions",
+          "[cpp11embed][ByteSpan]") {
+  std::string input = GENERATE(as<std::string>{}, "", "abc",
+                               "one line\ntwo lines\t\"'?\\");
+  for (int i = 0; i < 300; i++) {
+    input.push_back(static_cast<char>(i));
+  }
+  const cpp11embed::ByteSpan input_span{input.data(), input.size()};
+  const auto from_stream =
+      [&input](const std::function<void(std::istream&, std::ostream&)>&
+                   output) {
+        std::istringstream input_stream{input};
+        std::ostringstream output_stream;
+        output(input_stream, output_stream);
+        return output_stream.str();
+      };
+  const auto from_span =
+      [](const std::function<void(std::ostream&)>& output) {
+        std::ostringstream output_stream;
+        output(output_stream);
+        return output_stream.str();
+      };
+
+  REQUIRE(from_span([&](std::ostream& out) {
+            cpp11embed::OutputEscapedStringLiteral(input_span, out);
+          }) == from_stream([](std::istream& in, std::ostream& out) {
+            cpp11embed::OutputEscapedStringLiteral(in, out);
+          }));
+  REQUIRE(from_span([&](std::ostream& out) {
+            cpp11embed::OutputEscapedStringLiteralHeader("id", true,
+                                                         input_span, out);
+          }) == from_stream([](std::istream& in, std::ostream& out) {
+            cpp11embed::OutputEscapedStringLiteralHeader("id", true, in, out);
+          }));
+  REQUIRE(from_span([&](std::ostream& out) {
+            REQUIRE(cpp11embed::OutputBinaryInitialiser(input_span, out) ==
+                    input.size());
+          }) == from_stream([](std::istream& in, std::ostream& out) {
+            cpp11embed::OutputBinaryInitialiser(in, out);
+          }));
+  REQUIRE(from_span([&](std::ostream& out) {
+            cpp11embed::OutputBinaryDataHeader("id", false, input_span, out);
+          }) == from_stream([](std::istream& in, std::ostream& out) {
+            cpp11embed::OutputBinaryDataHeader("id", false, in, out);
+          }));
+  REQUIRE(from_span([&](std::ostream& out) {
+            REQUIRE(cpp11embed::OutputBinaryStringLiteral(input_span, out) ==
+                    input.size());
+          }) == from_stream([](std::istream& in, std::ostream& out) {
+            cpp11embed::OutputBinaryStringLiteral(in, out);
+          }));
+  REQUIRE(from_span([&](std::ostream& out) {
+            cpp11embed::OutputBinaryStringLiteralHeader("id", true,
+                                                        input_span, out);
+          }) == from_stream([](std::istream& in, std::ostream& out) {
+            cpp11embed::OutputBinaryStringLiteralHeader("id", true, in, out);
+          }));
+  REQUIRE(from_span([&](std::ostream& out) {
+            cpp11embed::OutputRuntimeLoadHeader("id", true, false, "/a",
+                                                input_span, out);
+          }) == from_stream([](std::istream& in, std::ostream& out) {
+            cpp11embed::OutputRuntimeLoadHeader("id", true, false, "/a", in,
+                                                out);
+          }));
+}
+
+TEST_CASE("cpp11embed::OutputEscapedStringLiteral long runs",
+          "[cpp11embed][OutputEscapedStringLiteral]") {
+  std::string input;
+  for (int i = 0; i < 200000; i++) {
+    input.push_back(static_cast<char>(i % 7 == 0 ? i % 256 : 'a' + i % 26));
+  }
+  input += std::string(100000, 'z') + "\"end\"";
+  std::ostringstream expected;
+  expected << '"';
+  for (const char c : input) {
+    cpp11embed::OutputEscapedCharacter(c, expected);
+  }
+  expected << '"';
+  REQUIRE(GetEscapedStringLiteral(input) == expected.str());
+}
+
+TEST_CASE("cpp11embed OutputSink overloads match the stream versions",
+          "[cpp11embed][OutputSink]") {
+  const std::string input = GENERATE(as<std::string>{}, "", "a\tb\n\"c\"",
+                                     std::string(100000, '\xff'));
+  const cpp11embed::ByteSpan input_span{input.data(), input.size()};
+  const auto to_sink =
+      [](const std::function<void(cpp11embed::OutputSink&)>& output) {
+        std::vector<char> output_vector;
+        cpp11embed::VectorSink sink{output_vector};
+        output(sink);
+        return std::string(output_vector.begin(), output_vector.end());
+      };
+  const auto to_stream = [](const std::function<void(std::ostream&)>& output) {
+    std::ostringstream output_stream;
+    output(output_stream);
+    return output_stream.str();
+  };
+
+  REQUIRE(to_sink([&](cpp11embed::OutputSink& sink) {
+            cpp11embed::OutputEscapedStringLiteralHeader("id", false,
+                                                         input_span, sink);
+          }) == to_stream([&](std::ostream& out) {
+            cpp11embed::OutputEscapedStringLiteralHeader("id", false,
+                                                         input_span, out);
+          }));
+  REQUIRE(to_sink([&](cpp11embed::OutputSink& sink) {
+            std::istringstream input_stream{input};
+            cpp11embed::OutputBinaryDataHeader("id", true, input_stream,
+                                               sink);
+          }) == to_stream([&](std::ostream& out) {
+            cpp11embed::OutputBinaryDataHeader("id", true, input_span, out);
+          }));
+  REQUIRE(to_sink([&](cpp11embed::OutputSink& sink) {
+            cpp11embed::OutputBinaryStringLiteralHeader("id", false,
+                                                        input_span, sink);
+          }) == to_stream([&](std::ostream& out) {
+            std::istringstream input_stream{input};
+            cpp11embed::OutputBinaryStringLiteralHeader("id", false,
+                                                        input_stream, out);
+          }));
+  REQUIRE(to_sink([&](cpp11embed::OutputSink& sink) {
+            cpp11embed::OutputExternBinaryDataHeader("id", true, input.size(),
+                                                     sink);
+          }) == to_stream([&](std::ostream& out) {
+            cpp11embed::OutputExternBinaryDataHeader("id", true, input.size(),
+                                                     out);
+          }));
+}
+
+TEST_CASE("cpp11embed headers are the same however many jobs format them",
+          "[cpp11embed][Parallel]") {
+  // Chunks are 1 MiB, so this covers inputs that are a single chunk, a chunk
+  // and a byte and enough chunks for several rounds on two threads
+  const size_t size = GENERATE(size_t{0}, size_t{1} << 20,
+                               (size_t{1} << 20) + 1, (size_t{9} << 20) + 300);
+  std::string input(size, '\0');
+  for (size_t i = 0; i < size; i++) {
+    input[i] = static_cast<char>(i * 31 % 251);
+  }
+  const cpp11embed::ByteSpan input_span{input.data(), input.size()};
+  const auto get_header =
+      [&](const unsigned number_of_jobs, const bool from_stream,
+          const std::function<void(cpp11embed::OutputSink&, std::istream&,
+                                   unsigned)>& output_stream_header,
+          const std::function<void(cpp11embed::OutputSink&, unsigned)>&
+              output_span_header) {
+        std::vector<char> output_vector;
+        cpp11embed::VectorSink sink{output_vector};
+        std::istringstream input_stream{input};
+        if (from_stream) {
+          output_stream_header(sink, input_stream, number_of_jobs);
+        } else {
+          output_span_header(sink, number_of_jobs);
+        }
+        return std::string(output_vector.begin(), output_vector.end());
+      };
+  const bool from_stream = GENERATE(false, true);
+
+  const auto text_from_stream = [](cpp11embed::OutputSink& sink,
+                                   std::istream& input_stream,
+                                   const unsigned number_of_jobs) {
+    cpp11embed::OutputEscapedStringLiteralHeader("id", false, input_stream,
+                                                 sink, number_of_jobs);
+  };
+  const auto text_from_span = [&](cpp11embed::OutputSink& sink,
+                                  const unsigned number_of_jobs) {
+    cpp11embed::OutputEscapedStringLiteralHeader("id", false, input_span,
+                                                 sink, number_of_jobs);
+  };
+  REQUIRE(get_header(2, from_stream, text_from_stream, text_from_span) ==
+          get_header(1, from_stream, text_from_stream, text_from_span));
+
+  const auto binary_from_stream = [](cpp11embed::OutputSink& sink,
+                                     std::istream& input_stream,
+                                     const unsigned number_of_jobs) {
+    cpp11embed::OutputBinaryDataHeader("id", false, input_stream, sink,
+                                       number_of_jobs);
+  };
+  const auto binary_from_span = [&](cpp11embed::OutputSink& sink,
+                                    const unsigned number_of_jobs) {
+    cpp11embed::OutputBinaryDataHeader("id", false, input_span, sink,
+                                       number_of_jobs);
+  };
+  REQUIRE(get_header(2, from_stream, binary_from_stream, binary_from_span) ==
+          get_header(1, from_stream, binary_from_stream, binary_from_span));
+
+  cpp11embed::BinaryLayout layout;
+  layout.word_size = 8;
+  layout.big_endian = true;
+  const auto words_from_stream = [&](cpp11embed::OutputSink& sink,
+                                     std::istream& input_stream,
+                                     const unsigned number_of_jobs) {
+    cpp11embed::OutputBinaryDataHeader("id", false, input_stream, sink,
+                                       number_of_jobs, layout);
+  };
+  const auto words_from_span = [&](cpp11embed::OutputSink& sink,
+                                   const unsigned number_of_jobs) {
+    cpp11embed::OutputBinaryDataHeader("id", false, input_span, sink,
+                                       number_of_jobs, layout);
+  };
+  REQUIRE(get_header(2, from_stream, words_from_stream, words_from_span) ==
+          get_header(1, from_stream, words_from_stream, words_from_span));
+
+  const auto literal_from_stream = [](cpp11embed::OutputSink& sink,
+                                      std::istream& input_stream,
+                                      const unsigned number_of_jobs) {
+    cpp11embed::OutputBinaryStringLiteralHeader("id", false, input_stream,
+                                                sink, number_of_jobs);
+  };
+  const auto literal_from_span = [&](cpp11embed::OutputSink& sink,
+                                     const unsigned number_of_jobs) {
+    cpp11embed::OutputBinaryStringLiteralHeader("id", false, input_span,
+                                                sink, number_of_jobs);
+  };
+  REQUIRE(get_header(2, from_stream, literal_from_stream, literal_from_span) ==
+          get_header(1, from_stream, literal_from_stream, literal_from_span));
+}
+
+TEST_CASE("cpp11embed::OutputDirectoryHeader", "[cpp11embed][Directory]") {
+  const std::string first = "abc";
+  const std::string second{"\0\1\2\3", 4};
+  const std::vector<cpp11embed::DirectoryEntry> entries{
+      {"a.txt", {first.data(), first.size()}},
+      {"b/c.bin", {second.data(), second.size()}}};
+  std::ostringstream output_stream;
+  REQUIRE(cpp11embed::OutputDirectoryHeader("assets", false, entries, 8,
+                                            output_stream));
+  const std::string header = output_stream.str();
+  REQUIRE(header.find("namespace assets {") != std::string::npos);
+  // Each file is padded out to the alignment
+  REQUIRE(header.find("alignas(8) constexpr unsigned char blob[] =\n"
+                      "    \"abc\\000\\000\\000\\000\\000"
+                      "\\000\\001\\002\\003\";") != std::string::npos);
+  REQUIRE(header.find("{\"a.txt\", 5, blob + 0, 3},") != std::string::npos);
+  REQUIRE(header.find("{\"b/c.bin\", 7, blob + 8, 4},") != std::string::npos);
+  REQUIRE(header.find("constexpr std::size_t number_of_entries = 2;") !=
+          std::string::npos);
+  REQUIRE(header.find("constexpr std::size_t deduplicated_bytes = 0;") !=
+          std::string::npos);
+}
+
+TEST_CASE("cpp11embed::OutputDirectoryHeader duplicate contents",
+          "[cpp11embed][Directory]") {
+  const std::string contents = "abc";
+  const std::string other = "abd";
+  const std::vector<cpp11embed::DirectoryEntry> entries{
+      {"a", {contents.data(), contents.size()}},
+      {"b", {other.data(), other.size()}},
+      {"c", {contents.data(), contents.size()}}};
+  std::ostringstream output_stream;
+  REQUIRE(cpp11embed::OutputDirectoryHeader("assets", false, entries, 4,
+                                            output_stream));
+  const std::string header = output_stream.str();
+  // c is stored once, as part of a
+  REQUIRE(header.find("alignas(4) constexpr unsigned char blob[] =\n"
+                      "    \"abc\\000abd\";") != std::string::npos);
+  REQUIRE(header.find("{\"a\", 1, blob + 0, 3},") != std::string::npos);
+  REQUIRE(header.find("{\"b\", 1, blob + 4, 3},") != std::string::npos);
+  REQUIRE(header.find("{\"c\", 1, blob + 0, 3},") != std::string::npos);
+  REQUIRE(header.find("constexpr std::size_t deduplicated_bytes = 3;") !=
+          std::string::npos);
+}
+
+TEST_CASE("cpp11embed::OutputAliasHeader", "[cpp11embed][OutputAliasHeader]") {
+  const auto get_header = [](const cpp11embed::AliasedHeader aliased_header) {
+    std::ostringstream output_stream;
+    cpp11embed::OutputAliasHeader("copy", false, "original", "../Original.h",
+                                  aliased_header, output_stream);
+    return output_stream.str();
+  };
+  const std::string prefix =
+      "#pragma once\n\n#include <cstddef>\n\n#include \"../Original.h\"\n\n"
+      "// The same data as original rather than another copy of it\n";
+  REQUIRE(get_header(cpp11embed::AliasedHeader::k_data) ==
+          prefix + "static constexpr const auto &copy = original;\n");
+  REQUIRE(get_header(cpp11embed::AliasedHeader::k_binary_string_literal) ==
+          prefix +
+              "static constexpr const auto &copy = original;\n"
+              "constexpr std::size_t copy_size = original_size;\n");
+  REQUIRE(get_header(cpp11embed::AliasedHeader::k_compressed) ==
+          prefix +
+              "static constexpr const auto &copy_compressed = "
+              "original_compressed;\n"
+              "constexpr std::size_t copy_compressed_size = "
+              "original_compressed_size;\n"
+              "constexpr std::size_t copy_size = original_size;\n\n"
+              "inline bool copy_decompress(void *buffer) {\n"
+              "  return original_decompress(buffer);\n}\n\n"
+              "inline auto copy() -> decltype(original()) {\n"
+              "  return original();\n}\n");
+}
+
+TEST_CASE("cpp11embed::OutputAliasHeader metadata",
+          "[cpp11embed][OutputAliasHeader]") {
+  std::ostringstream output_stream;
+  cpp11embed::OutputAliasHeader("copy", false, "original", "Original.h",
+                                cpp11embed::AliasedHeader::k_data,
+                                output_stream, true);
+  REQUIRE(output_stream.str() ==
+          "#pragma once\n\n#include <cstddef>\n\n#include \"Original.h\"\n\n"
+          "// The same data as original rather than another copy of it\n"
+          "static constexpr const auto &copy = original;\n"
+          "constexpr std::size_t copy_size = original_size;\n"
+          "constexpr auto copy_crc32c = original_crc32c;\n"
+          "constexpr auto copy_xxh64 = original_xxh64;\n"
+          "static constexpr const auto &copy_content_type = "
+          "original_content_type;\n");
+}
+
+TEST_CASE("cpp11embed metadata", "[cpp11embed][DataMetadata]") {
+  cpp11embed::DataMetadata metadata;
+  metadata.enabled = true;
+  metadata.content_type = "text/\"x\"";
+  const std::string metadata_constants =
+      "\n\n// Of the data as embedded, so it can be checked without hashing "
+      "it at runtime\n";
+  const std::string hashes =
+      "constexpr std::uint32_t abc_crc32c = 0x364b3fb7;\n"
+      "constexpr std::uint64_t abc_xxh64 = 0x44bc2cf5ad770999ULL;\n"
+      "constexpr char abc_content_type[] = \"text/\\\"x\\\"\";\n";
+  const std::string input = "abc";
+  const cpp11embed::ByteSpan input_span{input.data(), input.size()};
+  const unsigned jobs = GENERATE(1U, 4U);
+
+  const auto get_header = [&](const std::function<void(
+                                  cpp11embed::OutputSink &, std::istream &)>
+                                  output_header) {
+    std::vector<char> output;
+    cpp11embed::VectorSink sink{output};
+    std::istringstream input_stream{input};
+    output_header(sink, input_stream);
+    return std::string(output.begin(), output.end());
+  };
+  const std::string text_header =
+      "#pragma once\n\n#include <cstddef>\n#include <cstdint>\n\n"
+      "constexpr char abc[] = \"abc\";" +
+      metadata_constants + "constexpr std::size_t abc_size = 3;\n" + hashes;
+  REQUIRE(get_header([&](cpp11embed::OutputSink &sink, std::istream &) {
+            cpp11embed::OutputEscapedStringLiteralHeader(
+                "abc", false, input_span, sink, jobs,
+                cpp11embed::MinifyFormat::k_none, metadata);
+          }) == text_header);
+  REQUIRE(get_header([&](cpp11embed::OutputSink &sink, std::istream &stream) {
+            cpp11embed::OutputEscapedStringLiteralHeader(
+                "abc", false, stream, sink, jobs,
+                cpp11embed::MinifyFormat::k_none, metadata);
+          }) == text_header);
+
+  const std::string binary_header =
+      "#pragma once\n\n#include <array>\n#include <cstddef>\n"
+      "#include <cstdint>\n\nconstexpr std::array<uint8_t, 3> abc{97, 98, "
+      "99};" +
+      metadata_constants + "constexpr std::size_t abc_size = 3;\n" + hashes;
+  REQUIRE(get_header([&](cpp11embed::OutputSink &sink, std::istream &stream) {
+            cpp11embed::OutputBinaryDataHeader("abc", false, stream, sink,
+                                               jobs, cpp11embed::BinaryLayout{},
+                                               metadata);
+          }) == binary_header);
+
+  const std::string binary_string_literal_header =
+      "#pragma once\n\n#include <cstddef>\n#include <cstdint>\n\n"
+      "constexpr unsigned char abc[] =\n    \"abc\";\n"
+      "constexpr std::size_t abc_size = sizeof(abc) - 1;" +
+      metadata_constants + hashes;
+  REQUIRE(get_header([&](cpp11embed::OutputSink &sink, std::istream &) {
+            cpp11embed::OutputBinaryStringLiteralHeader(
+                "abc", false, input_span, sink, jobs, metadata);
+          }) == binary_string_literal_header);
+}
+
+TEST_CASE("cpp11embed::GuessContentType", "[cpp11embed][DataMetadata]") {
+  REQUIRE(cpp11embed::GuessContentType("a/b/config.JSON", true) ==
+          "application/json");
+  REQUIRE(cpp11embed::GuessContentType("logo.png", false) == "image/png");
+  REQUIRE(cpp11embed::GuessContentType("notes", true) == "text/plain");
+  REQUIRE(cpp11embed::GuessContentType("dir.png/data", false) ==
+          "application/octet-stream");
+  REQUIRE(cpp11embed::GuessContentType("", false) ==
+          "application/octet-stream");
+}
+
+TEST_CASE("cpp11embed::OutputDeclarationHeader",
+          "[cpp11embed][OutputDeclarationHeader]") {
+  const auto get_header = [](const cpp11embed::DefinitionType type,
+                             const size_t number_of_shards) {
+    std::ostringstream output_stream;
+    cpp11embed::OutputDeclarationHeader("id", false, type, 5,
+                                        number_of_shards, output_stream);
+    return output_stream.str();
+  };
+  REQUIRE(get_header(cpp11embed::DefinitionType::k_text, 1) ==
+          "#pragma once\n\n#include <cstddef>\n\n"
+          "constexpr std::size_t id_size = 5;\n"
+          "extern const char id[6];\n");
+  REQUIRE(get_header(cpp11embed::DefinitionType::k_binary_array, 1) ==
+          "#pragma once\n\n#include <array>\n#include <cstddef>\n"
+          "#include <cstdint>\n\nconstexpr std::size_t id_size = 5;\n"
+          "extern const std::array<uint8_t, 5> id;\n");
+  REQUIRE(get_header(cpp11embed::DefinitionType::k_binary_string_literal,
+                     1) ==
+          "#pragma once\n\n#include <cstddef>\n\n"
+          "constexpr std::size_t id_size = 5;\n"
+          "extern const unsigned char id[6];\n");
+  // Every shard apart from the last is the same size
+  REQUIRE(get_header(cpp11embed::DefinitionType::k_binary_array, 3) ==
+          "#pragma once\n\n#include <cstddef>\n\n"
+          "constexpr std::size_t id_size = 5;\n"
+          "constexpr std::size_t id_shard_size = 2;\n"
+          "constexpr std::size_t id_number_of_shards = 3;\n\n"
+          "extern const unsigned char id_shard_0[3];\n"
+          "extern const unsigned char id_shard_1[3];\n"
+          "extern const unsigned char id_shard_2[2];\n\n"
+          "constexpr const unsigned char *id_shards[id_number_of_shards] = "
+          "{\n"
+          "    id_shard_0,\n    id_shard_1,\n    id_shard_2,\n};\n");
+}
+
+TEST_CASE("cpp11embed::OutputDefinitionSource",
+          "[cpp11embed][OutputDefinitionSource]") {
+  const std::string input = "ab\"cd";
+  const cpp11embed::ByteSpan input_span{input.data(), input.size()};
+  const auto get_source = [&](const cpp11embed::DefinitionType type,
+                              const size_t shard,
+                              const size_t number_of_shards) {
+    std::ostringstream output_stream;
+    cpp11embed::OutputDefinitionSource("id", type, "../Id.h", input_span,
+                                       shard, number_of_shards,
+                                       output_stream);
+    return output_stream.str();
+  };
+  REQUIRE(get_source(cpp11embed::DefinitionType::k_text, 0, 1) ==
+          "#include \"../Id.h\"\n\nconst char id[6] = \"ab\\\"cd\";\n");
+  REQUIRE(get_source(cpp11embed::DefinitionType::k_binary_array, 0, 1) ==
+          "#include \"../Id.h\"\n\n"
+          "const std::array<uint8_t, 5> id{97, 98, 34, 99, 100};\n");
+  REQUIRE(get_source(cpp11embed::DefinitionType::k_text, 1, 2) ==
+          "#include \"../Id.h\"\n\nconst char id_shard_1[3] = \"cd\";\n");
+  REQUIRE(get_source(cpp11embed::DefinitionType::k_binary_array, 0, 2) ==
+          "#include \"../Id.h\"\n\n"
+          "const unsigned char id_shard_0[4] =\n    \"ab\\\"\";\n");
+}
@@ -0,0 +1,56 @@
+#include <catch2/catch.hpp>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Manifest.h"
+
+namespace {
+std::vector<cpp11embed::ManifestEntry> ReadManifest(
+    const std::string &manifest) {
+  std::istringstream input_stream{manifest};
+  return cpp11embed::ReadManifest(input_stream);
+}
+}  // namespace
+
+TEST_CASE("ReadManifest no entries", "[cpp11embed][ReadManifest]") {
+  const std::string manifest = GENERATE(as<std::string>{}, "", "\n\n",
+                                        "# comment\n", "# a\tb\tc\n");
+  REQUIRE(ReadManifest(manifest).empty());
+}
+
+TEST_CASE("ReadManifest entries", "[cpp11embed][ReadManifest]") {
+  const auto entries = ReadManifest(
+      "# comment\n"
+      "in.txt\tk_in\tout.h\n"
+      "\n"
+      "in.bin\tk_bin\tbin.h\t-b\t-g\r\n"
+      "in2.bin\tk_bin2\tbin2.h\t\t--alignment\t64");
+  REQUIRE(entries.size() == 3);
+  REQUIRE(entries[0].line_number == 2);
+  REQUIRE(entries[0].arguments ==
+          std::vector<std::string>{"in.txt", "k_in", "-o", "out.h"});
+  REQUIRE(entries[1].line_number == 4);
+  REQUIRE(entries[1].arguments ==
+          std::vector<std::string>{"in.bin", "k_bin", "-o", "bin.h", "-b",
+                                   "-g"});
+  REQUIRE(entries[2].line_number == 5);
+  REQUIRE(entries[2].arguments ==
+          std::vector<std::string>{"in2.bin", "k_bin2", "-o", "bin2.h",
+                                   "--alignment", "64"});
+}
+
+TEST_CASE("ReadManifest too few fields", "[cpp11embed][ReadManifest]") {
+  const std::string manifest =
+      GENERATE(as<std::string>{}, "in.txt\n", "in.txt\tk_in\n",
+               "in.txt\tk_in\tout.h\nin.txt\tk_in\n");
+  REQUIRE_THROWS_AS(ReadManifest(manifest), std::runtime_error);
+}
+
+TEST_CASE("ReadManifest empty fields", "[cpp11embed][ReadManifest]") {
+  const std::string manifest =
+      GENERATE(as<std::string>{}, "\tk_in\tout.h\n", "in.txt\t\tout.h\n",
+               "in.txt\tk_in\t\n", "in.txt\tk_in\t\t-b\n");
+  REQUIRE_THROWS_AS(ReadManifest(manifest), std::runtime_error);
+}
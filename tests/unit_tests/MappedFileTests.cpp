@@ -0,0 +1,42 @@
+#include <catch2/catch.hpp>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "MappedFile.h"
+
+namespace {
+/**
+ * Creates a file that is deleted when this goes out of scope
+ */
+class TemporaryFile {
+ public:
+  explicit TemporaryFile(const std::string &contents)
+      : path_("Cpp11EmbedMappedFileTest.bin") {
+    std::ofstream{path_, std::ofstream::binary} << contents;
+  }
+  ~TemporaryFile() { std::remove(path_.c_str()); }
+
+  const std::string &path() const { return path_; }
+
+ private:
+  std::string path_;
+};
+}  // namespace
+
+TEST_CASE("cpp11embed::MappedFile contents", "[cpp11embed][MappedFile]") {
+  const std::string contents = GENERATE(
+      as<std::string>{}, "", "abc", std::string{"\0\r\n\xff", 4},
+      std::string(1000000, 'x'));
+  const TemporaryFile file{contents};
+  const cpp11embed::MappedFile mapped_file{file.path()};
+  REQUIRE(mapped_file.IsMapped());
+  const cpp11embed::ByteSpan bytes = mapped_file.GetBytes();
+  REQUIRE(std::string(bytes.data, bytes.size) == contents);
+}
+
+TEST_CASE("cpp11embed::MappedFile file does not exist",
+          "[cpp11embed][MappedFile]") {
+  const cpp11embed::MappedFile mapped_file{"Cpp11EmbedDoesNotExist.bin"};
+  REQUIRE_FALSE(mapped_file.IsMapped());
+}
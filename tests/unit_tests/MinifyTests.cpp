@@ -0,0 +1,112 @@
+#include <catch2/catch.hpp>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "Lib.h"
+#include "Minify.h"
+#include "OutputSink.h"
+
+namespace {
+/**
+ * @returns the input minified a character at a time
+ */
+std::string MinifyEachCharacter(const cpp11embed::MinifyFormat format,
+                                const std::string &input) {
+  std::string output;
+  const std::unique_ptr<cpp11embed::Minifier> minifier =
+      cpp11embed::MakeMinifier(format);
+  for (const char c : input) {
+    minifier->Write(&c, 1, output);
+  }
+  minifier->Finish(output);
+  return output;
+}
+}  // namespace
+
+TEST_CASE("cpp11embed::GetMinifyFormat", "[cpp11embed][Minify]") {
+  cpp11embed::MinifyFormat format = cpp11embed::MinifyFormat::k_none;
+  REQUIRE(cpp11embed::GetMinifyFormat("json", format));
+  REQUIRE(format == cpp11embed::MinifyFormat::k_json);
+  REQUIRE(cpp11embed::GetMinifyFormat("glsl", format));
+  REQUIRE(format == cpp11embed::MinifyFormat::k_glsl);
+  REQUIRE(cpp11embed::GetMinifyFormat("css", format));
+  REQUIRE(format == cpp11embed::MinifyFormat::k_css);
+  REQUIRE(cpp11embed::GetMinifyFormat("html", format));
+  REQUIRE(format == cpp11embed::MinifyFormat::k_html);
+  REQUIRE(cpp11embed::GetMinifyFormat("sql", format));
+  REQUIRE(format == cpp11embed::MinifyFormat::k_sql);
+  REQUIRE_FALSE(cpp11embed::GetMinifyFormat("xml", format));
+}
+
+TEST_CASE("cpp11embed::Minify", "[cpp11embed][Minify]") {
+  using cpp11embed::MinifyFormat;
+  const auto minify_case = GENERATE(
+      table<MinifyFormat, std::string, std::string>({
+          {MinifyFormat::k_json, "", ""},
+          {MinifyFormat::k_json,
+           "{\n  \"a b\": [1, 2],\n  // note\n  \"c\": \"\\\" /* x */\"\n}\n",
+           "{\"a b\":[1,2],\"c\":\"\\\" /* x */\"}"},
+          {MinifyFormat::k_glsl,
+           "#version 330\n\nuniform float a; // a\nvoid f() { x = a - -b "
+           "/ c; }\n  #define F(x) (x)\nint i;",
+           "#version 330\nuniform float a;void f(){x=a- -b/c;}\n#define F(x) "
+           "(x)\nint i;"},
+          {MinifyFormat::k_glsl, "a/**/b a /b", "a b a/b"},
+          {MinifyFormat::k_css,
+           "/* header */\na > b ,c {\n  color : red ;\n  margin: 0 auto;\n"
+           "  content: \"a  /* b */\";\n}\n@media screen and (min-width: "
+           "1px) {}",
+           "a>b,c{color :red;margin:0 auto;content:\"a  /* b */\";}@media "
+           "screen and (min-width:1px){}"},
+          {MinifyFormat::k_sql,
+           "SELECT a - -1, 'it''s -- not' 'a comment'\n-- comment\nFROM "
+           "t /* x */ WHERE b = \"c  d\";",
+           "SELECT a- -1,'it''s -- not' 'a comment' FROM t WHERE b=\"c  "
+           "d\";"},
+          {MinifyFormat::k_sql,
+           "CREATE FUNCTION f() AS $$ SELECT 1 -- one\n $$;\nSELECT $1, "
+           "$body$ a $$ -- b $body$, x$y -- z\n",
+           "CREATE FUNCTION f()AS $$ SELECT 1 -- one\n $$;SELECT $1,"
+           "$body$ a $$ -- b $body$,x$y"},
+          {MinifyFormat::k_html,
+           "<p>a < b and don't   stop</p> <!-- x --> <p>a <3</p>",
+           "<p>a < b and don't stop</p> <p>a <3</p>"},
+          {MinifyFormat::k_html,
+           "  <!DOCTYPE html>\n<p  class=\"a  b\" >Some\n   text <!-- no "
+           "-->here</p>\n<pre>  kept\n  </PRE >\n<script>if (a <b) "
+           "{}</script> <",
+           "<!DOCTYPE html> <p class=\"a  b\">Some text here</p> <pre>  "
+           "kept\n  </PRE> <script>if (a <b) {}</script> <"},
+      }));
+  const MinifyFormat format = std::get<0>(minify_case);
+  const std::string &input = std::get<1>(minify_case);
+  const std::string &expected = std::get<2>(minify_case);
+  REQUIRE(cpp11embed::Minify(format, input) == expected);
+  // Nothing depends on how the input is split up
+  REQUIRE(MinifyEachCharacter(format, input) == expected);
+}
+
+TEST_CASE("cpp11embed::OutputEscapedStringLiteralHeader minified",
+          "[cpp11embed][Minify]") {
+  const std::string input = "{\n  \"a\": \"\\n\",\n  \"b\": [1, 2]\n}\n";
+  const std::string expected =
+      "#pragma once\n\nconstexpr char json[] = "
+      "\"{\\\"a\\\":\\\"\\\\n\\\",\\\"b\\\":[1,2]}\";\n";
+  std::vector<char> from_memory;
+  cpp11embed::VectorSink memory_sink{from_memory};
+  cpp11embed::OutputEscapedStringLiteralHeader(
+      "json", false, cpp11embed::ByteSpan{input.data(), input.size()},
+      memory_sink, 4, cpp11embed::MinifyFormat::k_json);
+  REQUIRE(std::string(from_memory.begin(), from_memory.end()) == expected);
+
+  std::istringstream input_stream{input};
+  std::vector<char> from_stream;
+  cpp11embed::VectorSink stream_sink{from_stream};
+  cpp11embed::OutputEscapedStringLiteralHeader(
+      "json", false, input_stream, stream_sink, 4,
+      cpp11embed::MinifyFormat::k_json);
+  REQUIRE(std::string(from_stream.begin(), from_stream.end()) == expected);
+}
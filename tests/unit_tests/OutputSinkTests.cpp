@@ -0,0 +1,111 @@
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "OutputSink.h"
+
+namespace {
+std::string ToString(const std::vector<char> &output) {
+  return std::string(output.begin(), output.end());
+}
+}  // namespace
+
+TEST_CASE("cpp11embed::BufferedOutput writes everything in order",
+          "[cpp11embed][BufferedOutput]") {
+  // Small enough that the buffer fills up many times
+  const size_t buffer_size = GENERATE(1, 7, 64, 1024);
+  std::vector<char> output;
+  std::string expected;
+  {
+    cpp11embed::VectorSink sink{output};
+    cpp11embed::BufferedOutput buffered_output{sink, buffer_size};
+    for (int i = 0; i < 100; i++) {
+      buffered_output.Write('a');
+      buffered_output.Write("bc");
+      buffered_output.WriteDecimal(static_cast<uint64_t>(i));
+      const std::string large(buffer_size * 2, 'x');
+      buffered_output.Write(large);
+      char *const reserved = buffered_output.Reserve(1);
+      *reserved = 'y';
+      buffered_output.Commit(1);
+      expected += "abc" + std::to_string(i) + large + "y";
+    }
+  }
+  REQUIRE(ToString(output) == expected);
+}
+
+TEST_CASE("cpp11embed::BufferedOutput only writes when full or flushed",
+          "[cpp11embed][BufferedOutput]") {
+  std::vector<char> output;
+  cpp11embed::VectorSink sink{output};
+  cpp11embed::BufferedOutput buffered_output{sink, 8};
+  buffered_output.Write("abcd");
+  REQUIRE(output.empty());
+  buffered_output.Write("efghi");
+  REQUIRE(ToString(output) == "abcd");
+  buffered_output.Flush();
+  REQUIRE(ToString(output) == "abcdefghi");
+}
+
+TEST_CASE("cpp11embed::BufferedOutput::WriteDecimal",
+          "[cpp11embed][BufferedOutput]") {
+  const uint64_t value = GENERATE(0, 1, 9, 10, 255, 1234567890,
+                                  std::numeric_limits<uint64_t>::max());
+  std::vector<char> output;
+  {
+    cpp11embed::VectorSink sink{output};
+    cpp11embed::BufferedOutput buffered_output{sink};
+    buffered_output.WriteDecimal(value);
+  }
+  REQUIRE(ToString(output) == std::to_string(value));
+}
+
+TEST_CASE("cpp11embed::OstreamSink", "[cpp11embed][OutputSink]") {
+  std::ostringstream output_stream;
+  cpp11embed::OstreamSink sink{output_stream};
+  sink.Write("abc", 3);
+  sink.Write("de", 2);
+  REQUIRE(output_stream.str() == "abcde");
+  REQUIRE_FALSE(sink.HasFailed());
+  output_stream.setstate(std::ios::badbit);
+  REQUIRE(sink.HasFailed());
+}
+
+#ifndef _WIN32
+TEST_CASE("cpp11embed::FileDescriptorSink", "[cpp11embed][OutputSink]") {
+  const char *const path = "Cpp11EmbedFileDescriptorSinkTest.txt";
+  const int file_descriptor =
+      open(path, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+  REQUIRE(file_descriptor >= 0);
+  const std::string large(1000000, 'x');
+  {
+    cpp11embed::FileDescriptorSink sink{file_descriptor};
+    sink.Write("abc", 3);
+    sink.Write(large.data(), large.size());
+    REQUIRE_FALSE(sink.HasFailed());
+  }
+  close(file_descriptor);
+
+  std::ifstream input_stream{path, std::ifstream::binary};
+  const std::string contents{std::istreambuf_iterator<char>(input_stream),
+                             std::istreambuf_iterator<char>()};
+  input_stream.close();
+  std::remove(path);
+  REQUIRE(contents == "abc" + large);
+
+  cpp11embed::FileDescriptorSink invalid_sink{-1};
+  invalid_sink.Write("abc", 3);
+  REQUIRE(invalid_sink.HasFailed());
+}
+#endif
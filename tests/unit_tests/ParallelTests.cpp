@@ -0,0 +1,24 @@
+#include <atomic>
+#include <catch2/catch.hpp>
+#include <cstddef>
+#include <vector>
+
+#include "Parallel.h"
+
+TEST_CASE("GetDefaultNumberOfJobs", "[cpp11embed][Parallel]") {
+  REQUIRE(cpp11embed::GetDefaultNumberOfJobs() >= 1);
+}
+
+TEST_CASE("ParallelFor calls every task once", "[cpp11embed][Parallel]") {
+  const size_t count = GENERATE(0, 1, 7, 1000);
+  const unsigned number_of_jobs = GENERATE(0, 1, 2, 16);
+  std::vector<std::atomic<int>> calls(count);
+  for (auto &call : calls) {
+    call = 0;
+  }
+  cpp11embed::ParallelFor(count, number_of_jobs,
+                          [&calls](const size_t i) { calls[i]++; });
+  for (const auto &call : calls) {
+    REQUIRE(call == 1);
+  }
+}
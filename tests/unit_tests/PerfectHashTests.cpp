@@ -0,0 +1,50 @@
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <string>
+#include <vector>
+
+#include "PerfectHash.h"
+
+namespace {
+std::vector<std::string> GetPaths(const size_t count) {
+  std::vector<std::string> paths;
+  for (size_t i = 0; i < count; i++) {
+    paths.push_back("assets/" + std::to_string(i % 10) + "/file" +
+                    std::to_string(i) + ".png");
+  }
+  return paths;
+}
+}  // namespace
+
+TEST_CASE("cpp11embed::BuildPerfectHash", "[cpp11embed][PerfectHash]") {
+  const size_t count = GENERATE(0, 1, 2, 3, 100, 10000);
+  const std::vector<std::string> paths = GetPaths(count);
+  cpp11embed::PerfectHash perfect_hash;
+  REQUIRE(cpp11embed::BuildPerfectHash(paths, perfect_hash));
+  REQUIRE(perfect_hash.seeds.size() == count);
+  REQUIRE(perfect_hash.slots.size() == count);
+
+  // Every key has its own slot, which is where the hash sends it
+  std::vector<bool> slot_used(count, false);
+  for (size_t i = 0; i < count; i++) {
+    const std::string &path = paths[i];
+    const uint32_t seed =
+        perfect_hash
+            .seeds[cpp11embed::HashKey(0, path.data(), path.size()) % count];
+    const size_t slot =
+        cpp11embed::HashKey(seed, path.data(), path.size()) % count;
+    REQUIRE(slot == perfect_hash.slots[i]);
+    REQUIRE_FALSE(slot_used[slot]);
+    slot_used[slot] = true;
+  }
+}
+
+TEST_CASE("cpp11embed::HashKey reference values",
+          "[cpp11embed][PerfectHash]") {
+  // Known values so that any change to the function is noticed
+  REQUIRE(cpp11embed::HashKey(0, "", 0) == 0xAB3E7C0BU);
+  REQUIRE(cpp11embed::HashKey(0, "a", 1) == 0x1A80B1B3U);
+  REQUIRE(cpp11embed::HashKey(0, "foobar", 6) == 0x0C0DA6DCU);
+  REQUIRE(cpp11embed::HashKey(1, "foobar", 6) !=
+          cpp11embed::HashKey(0, "foobar", 6));
+}
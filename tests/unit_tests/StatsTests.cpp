@@ -0,0 +1,109 @@
+#include <catch2/catch.hpp>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Lib.h"
+#include "OutputSink.h"
+#include "Stats.h"
+
+TEST_CASE("cpp11embed::TimedOutputSink passes everything on",
+          "[cpp11embed][Stats]") {
+  std::vector<char> output;
+  cpp11embed::VectorSink sink{output};
+  cpp11embed::TimedOutputSink timed_sink{sink};
+  timed_sink.Write("abc", 3);
+  timed_sink.Write("defg", 4);
+  REQUIRE(std::string(output.begin(), output.end()) == "abcdefg");
+  REQUIRE(timed_sink.GetBytesWritten() == 7);
+  REQUIRE(timed_sink.GetSeconds() >= 0);
+  REQUIRE_FALSE(timed_sink.HasFailed());
+}
+
+TEST_CASE("cpp11embed::TimedStreambuf reads the same as the stream",
+          "[cpp11embed][Stats]") {
+  // Several of its buffers' worth
+  std::string input(200 * 1024 + 3, '\0');
+  for (size_t i = 0; i < input.size(); i++) {
+    input[i] = static_cast<char>(i * 7);
+  }
+  std::istringstream input_stream{input};
+  cpp11embed::TimedStreambuf streambuf{*input_stream.rdbuf()};
+  std::istream timed_stream{&streambuf};
+
+  const std::string read{std::istreambuf_iterator<char>(timed_stream),
+                         std::istreambuf_iterator<char>()};
+  REQUIRE(read == input);
+  REQUIRE(streambuf.GetBytesRead() == input.size());
+}
+
+TEST_CASE("cpp11embed::TimedStreambuf passes seeking on",
+          "[cpp11embed][Stats]") {
+  std::istringstream input_stream{"0123456789"};
+  cpp11embed::TimedStreambuf streambuf{*input_stream.rdbuf()};
+  std::istream timed_stream{&streambuf};
+
+  char first[3];
+  timed_stream.read(first, sizeof(first));
+  // Finding the size seeks to the end and back again
+  REQUIRE(cpp11embed::GetRemainingStreamSize(timed_stream) == 7);
+  // Only what was actually read counts, not the rest of the buffer
+  REQUIRE(streambuf.GetBytesRead() == 3);
+  const std::string rest{std::istreambuf_iterator<char>(timed_stream),
+                         std::istreambuf_iterator<char>()};
+  REQUIRE(rest == "3456789");
+  REQUIRE(streambuf.GetBytesRead() == 10);
+}
+
+TEST_CASE("cpp11embed::OutputStats", "[cpp11embed][Stats]") {
+  cpp11embed::GenerationStats stats;
+  stats.mode = "binary";
+  stats.input_bytes = 4;
+  stats.output_bytes = 10;
+  stats.read_seconds = 0.25;
+  stats.format_seconds = 1.5;
+  stats.write_seconds = 0.125;
+  stats.peak_rss_bytes = 3 * 1024 * 1024;
+  std::ostringstream output_stream;
+  cpp11embed::OutputStats(stats, output_stream);
+  REQUIRE(output_stream.str() ==
+          "standard output: binary, 4 bytes in, 10 bytes out (2.50x), read "
+          "0.250s, format 1.500s, write 0.125s, peak RSS 3.0 MiB\n");
+
+  stats.output_filename = "out.h";
+  stats.input_bytes = 0;
+  output_stream.str("");
+  cpp11embed::OutputStats(stats, output_stream);
+  REQUIRE(output_stream.str().find("out.h: binary, 0 bytes in, 10 bytes out "
+                                   "(0.00x)") == 0);
+}
+
+TEST_CASE("cpp11embed::OutputStatsJson", "[cpp11embed][Stats]") {
+  std::ostringstream output_stream;
+  cpp11embed::OutputStatsJson({}, output_stream);
+  REQUIRE(output_stream.str() == "[\n]\n");
+
+  cpp11embed::GenerationStats stats;
+  stats.output_filename = "dir\\\"quoted\"\n.h";
+  stats.identifier_name = "id";
+  stats.mode = "text";
+  stats.input_bytes = 2;
+  stats.output_bytes = 5;
+  stats.read_seconds = 0.5;
+  stats.peak_rss_bytes = 1024;
+  output_stream.str("");
+  cpp11embed::OutputStatsJson({stats, stats}, output_stream);
+  const std::string object =
+      "{\"output_filename\": \"dir\\\\\\\"quoted\\\"\\u000a.h\", "
+      "\"identifier_name\": \"id\", \"mode\": \"text\", \"input_bytes\": 2, "
+      "\"output_bytes\": 5, \"expansion_ratio\": 2.500000, \"read_seconds\": "
+      "0.500000, \"format_seconds\": 0.000000, \"write_seconds\": 0.000000, "
+      "\"peak_rss_bytes\": 1024}";
+  REQUIRE(output_stream.str() ==
+          "[\n  " + object + ",\n  " + object + "\n]\n");
+}
+
+TEST_CASE("cpp11embed::GetPeakRss", "[cpp11embed][Stats]") {
+  REQUIRE(cpp11embed::GetPeakRss() > 0);
+}
@@ -0,0 +1,77 @@
+#include <catch2/catch.hpp>
+#include <cstdio>
+#include <fstream>
+#include <set>
+#include <string>
+
+#include "Watch.h"
+
+#ifdef __linux__
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+constexpr char k_file_path[] = "Cpp11EmbedWatchTest.txt";
+constexpr char k_directory_path[] = "Cpp11EmbedWatchTestDir";
+
+void WriteFile(const std::string &path, const std::string &contents) {
+  std::ofstream{path, std::ofstream::binary} << contents;
+}
+}  // namespace
+
+TEST_CASE("cpp11embed::FileWatcher file changes", "[cpp11embed][Watch]") {
+  WriteFile(k_file_path, "a");
+  cpp11embed::FileWatcher watcher;
+  REQUIRE(watcher.IsValid());
+  REQUIRE(watcher.AddFile(k_file_path));
+
+  // Other files in the same directory are ignored
+  WriteFile("Cpp11EmbedWatchTestOther.txt", "b");
+  WriteFile(k_file_path, "c");
+  REQUIRE(watcher.WaitForChanges() == std::set<std::string>{k_file_path});
+
+  // Replaced by renaming another file over it
+  WriteFile("Cpp11EmbedWatchTestOther.txt", "d");
+  REQUIRE(std::rename("Cpp11EmbedWatchTestOther.txt", k_file_path) == 0);
+  REQUIRE(watcher.WaitForChanges() == std::set<std::string>{k_file_path});
+
+  std::remove(k_file_path);
+  REQUIRE(watcher.WaitForChanges() == std::set<std::string>{k_file_path});
+}
+
+TEST_CASE("cpp11embed::FileWatcher directory changes",
+          "[cpp11embed][Watch]") {
+  const std::string subdirectory_path = std::string{k_directory_path} + "/a";
+  const std::string new_subdirectory_path =
+      std::string{k_directory_path} + "/b";
+  mkdir(k_directory_path, 0755);
+  mkdir(subdirectory_path.c_str(), 0755);
+  cpp11embed::FileWatcher watcher;
+  REQUIRE(watcher.AddDirectory(k_directory_path));
+
+  WriteFile(subdirectory_path + "/file.txt", "a");
+  REQUIRE(watcher.WaitForChanges() ==
+          std::set<std::string>{k_directory_path});
+
+  // Subdirectories added later are watched too
+  mkdir(new_subdirectory_path.c_str(), 0755);
+  REQUIRE(watcher.WaitForChanges() ==
+          std::set<std::string>{k_directory_path});
+  WriteFile(new_subdirectory_path + "/file.txt", "b");
+  REQUIRE(watcher.WaitForChanges() ==
+          std::set<std::string>{k_directory_path});
+
+  std::remove((subdirectory_path + "/file.txt").c_str());
+  std::remove((new_subdirectory_path + "/file.txt").c_str());
+  rmdir(subdirectory_path.c_str());
+  rmdir(new_subdirectory_path.c_str());
+  rmdir(k_directory_path);
+}
+#endif
+
+TEST_CASE("cpp11embed::FileWatcher directory does not exist",
+          "[cpp11embed][Watch]") {
+  cpp11embed::FileWatcher watcher;
+  REQUIRE_FALSE(watcher.AddFile("does/not/exist.txt"));
+  REQUIRE_FALSE(watcher.AddDirectory("does/not/exist"));
+}